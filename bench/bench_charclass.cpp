@@ -0,0 +1,92 @@
+#include "bench_utilities.h"
+#include "charclass.h"
+#include "errorhandler.h"
+#include "lexer.h"
+#include "tokenbuffer.h"
+
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/// Compares the character classification kernels on synthetic source code dominated by
+/// comments and by long identifiers. Usage: bench_charclass [size in MiB (default = 16)]
+
+/**
+ * @brief Generates code which is mostly line and block comments
+ */
+static std::string generateCommentHeavy(size_t bytes) {
+	std::string program;
+	program.reserve(bytes + 1024);
+	size_t function = 0;
+	while (program.size() < bytes) {
+		const std::string n = std::to_string(function);
+		program += "// Function number " + n
+		           + " is documented by a rather long line comment which goes on\n";
+		program += "/*\n * and by a block comment which spans several lines, describing\n"
+		           " * what it does at * great length / in detail\n */\n";
+		program += "fun f" + n + "(): i32 { " + n + " }\n";
+		function++;
+	}
+	return program;
+}
+
+/**
+ * @brief Generates code which is mostly long identifiers separated by whitespace
+ */
+static std::string generateIdentifierHeavy(size_t bytes) {
+	std::string program;
+	program.reserve(bytes + 1024);
+	size_t function = 0;
+	while (program.size() < bytes) {
+		const std::string n = std::to_string(function);
+		program += "fun computeTheRunningTotalOfEverything" + n
+		           + "(firstArgumentWithALongName: i32, "
+		             "secondArgumentWithALongName: i32): i32 {\n";
+		program += "        firstArgumentWithALongName        +        "
+		           "secondArgumentWithALongName\n}\n";
+		function++;
+	}
+	return program;
+}
+
+int main(int argc, char **argv) {
+	constexpr size_t MEBIBYTE = 1024 * 1024;
+	constexpr int REPETITIONS = 5;
+	size_t size = 16 * MEBIBYTE;
+	if (argc > 1) {
+		size = std::stoul(argv[1]) * MEBIBYTE;
+	}
+	const std::array<std::pair<std::string_view, std::string>, 3> programs = {
+	      std::pair("comment-heavy", generateCommentHeavy(size)),
+	      std::pair("identifier-heavy", generateIdentifierHeavy(size)),
+	      std::pair("mixed", bench::generateProgram(size)),
+	};
+	const std::array<std::pair<std::string_view, CharClass::Kernel>, 3> kernels = {
+	      std::pair("scalar", CharClass::Kernel::Scalar),
+	      std::pair("sse2", CharClass::Kernel::SSE2),
+	      std::pair("avx2", CharClass::Kernel::AVX2),
+	};
+
+	ErrorHandler errorHandler;
+	for (const auto &[programName, program] : programs) {
+		for (const auto &[kernelName, kernel] : kernels) {
+			if (!CharClass::setKernel(kernel)) {
+				std::cout << kernelName << " is not supported on this CPU\n";
+				continue;
+			}
+			size_t count = 0;
+			double seconds = bench::timeBest(REPETITIONS, [&]() {
+				count = Lexer(program, "bench.canyon", &errorHandler).lex().size();
+			});
+			bench::report(std::string(programName) + ' ' + std::string(kernelName),
+			      seconds, program.size(), count);
+		}
+	}
+	if (errorHandler.handleErrors(std::cerr)) {
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,102 @@
+#include "ast.h"
+#include "bench_utilities.h"
+#include "ccodegenerator.h"
+#include "errorhandler.h"
+#include "lexer.h"
+#include "outputfile.h"
+#include "parser.h"
+#include "semanticanalyzer.h"
+#include "threadpool.h"
+#include "tokenbuffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+
+/// Measures how fast C code is generated from an analyzed Module, in bytes of C written
+/// to /dev/null, and how much memory code generation allocates on top of the AST. Heap
+/// allocations are counted by replacing the global operator new, which also sees the
+/// chunks taken by Arenas. Peak RSS is per process, so it is measured before repeating.
+/// Function definitions are generated on the given number of threads.
+/// Usage: bench_codegen [size in MiB (default = 16)]
+///        [threads (default = 1, 0 = one per hardware thread)]
+
+namespace {
+
+// Definitions may be generated on several threads at once
+std::atomic<size_t> allocations = 0;
+std::atomic<size_t> allocatedBytes = 0;
+
+} // namespace
+
+void *operator new(size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	void *memory = std::malloc(size == 0 ? 1 : size);
+	if (memory == nullptr) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void operator delete(void *memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void *memory, [[maybe_unused]] size_t size) noexcept {
+	std::free(memory);
+}
+
+int main(int argc, char **argv) {
+	constexpr size_t MEBIBYTE = 1024 * 1024;
+	constexpr int REPETITIONS = 5;
+	size_t size = 16 * MEBIBYTE;
+	if (argc > 1) {
+		size = std::stoul(argv[1]) * MEBIBYTE;
+	}
+	ThreadPool threadPool(argc > 2 ? std::stoul(argv[2]) : 1);
+	const std::string program = bench::generateProgram(size);
+	OutputFile sink = bench::openNullOutput();
+	ErrorHandler errorHandler;
+
+	double generateSeconds = std::numeric_limits<double>::max();
+	size_t outputSize = 0;
+	for (int i = 0; i < REPETITIONS; i++) {
+		TokenBuffer tokens = Lexer(program, "bench.canyon", &errorHandler).lex();
+		std::unique_ptr<Module> module = Parser(std::move(tokens), &errorHandler).parse();
+		SemanticAnalyzer(module.get(), &errorHandler).analyze();
+		if (errorHandler.handleErrors(std::cerr)) {
+			return EXIT_FAILURE;
+		}
+		long baseline = bench::peakResidentKiB();
+		size_t baseAllocations = allocations;
+		size_t baseBytes = allocatedBytes;
+
+		size_t written = sink.size();
+		auto start = std::chrono::steady_clock::now();
+		CCodeGenerator(module.get(), &sink, &threadPool).generate();
+		auto generated = std::chrono::steady_clock::now();
+		outputSize = sink.size() - written;
+		if (i == 0) {
+			std::cout << program.size() << " bytes of Canyon, " << outputSize
+			          << " bytes of C, " << threadPool.size() << " threads\n";
+			std::cout << "heap allocations while generating: "
+			          << allocations - baseAllocations << " ("
+			          << (allocatedBytes - baseBytes) / 1024 << " KiB)\n";
+			std::cout << "peak RSS growth while generating: "
+			          << bench::peakResidentKiB() - baseline << " KiB\n";
+		}
+		generateSeconds = std::min(generateSeconds,
+		      std::chrono::duration<double>(generated - start).count());
+	}
+	bench::report("generate", generateSeconds, outputSize, 1);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+#include "bench_utilities.h"
+#include "casting.h"
+#include "errorhandler.h"
+#include "legacy_lexer.h"
+#include "lexer.h"
+#include "tokenbuffer.h"
+#include "tokens.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// Compares the throughput of the single-pass Lexer against the original three-pass
+/// Lexer. Usage: bench_lexer [size in MiB (default = 16)]
+
+static bool sameToken(const Token &lhs, const Token &rhs) {
+	// Both Lexers' Slices point into the same program, so the same pointer is the same
+	// location. The exception is the three-pass Lexer's combined Operators, which are
+	// spelled out separately
+	bool sameLocation
+	      = lhs.s.contents.data() == rhs.s.contents.data() || isa<Operator>(lhs);
+	if (lhs.kind != rhs.kind || lhs.s.contents != rhs.s.contents || !sameLocation) {
+		return false;
+	}
+	if (const auto *l = dyn_cast<IntegerLiteral>(&lhs)) {
+		return *l == cast<IntegerLiteral>(rhs);
+	}
+	if (const auto *l = dyn_cast<CharacterLiteral>(&lhs)) {
+		return *l == cast<CharacterLiteral>(rhs);
+	}
+	if (const auto *l = dyn_cast<BoolLiteral>(&lhs)) {
+		return *l == cast<BoolLiteral>(rhs);
+	}
+	if (const auto *l = dyn_cast<Keyword>(&lhs)) {
+		return l->type == cast<Keyword>(rhs).type;
+	}
+	if (const auto *l = dyn_cast<Punctuation>(&lhs)) {
+		return l->type == cast<Punctuation>(rhs).type;
+	}
+	if (const auto *l = dyn_cast<Operator>(&lhs)) {
+		return l->type == cast<Operator>(rhs).type;
+	}
+	return true;
+}
+
+int main(int argc, char **argv) {
+	constexpr size_t MEBIBYTE = 1024 * 1024;
+	constexpr int REPETITIONS = 5;
+	size_t size = 16 * MEBIBYTE;
+	if (argc > 1) {
+		size = std::stoul(argv[1]) * MEBIBYTE;
+	}
+	const std::string program = bench::generateProgram(size);
+
+	ErrorHandler errorHandler;
+	std::vector<std::unique_ptr<Token>> expected
+	      = legacy::Lexer(program, "bench.canyon", &errorHandler).lex();
+	TokenBuffer actual = Lexer(program, "bench.canyon", &errorHandler).lex();
+	if (expected.size() != actual.size()) {
+		std::cerr << "Token count mismatch: " << expected.size() << " vs " << actual.size()
+		          << '\n';
+		return EXIT_FAILURE;
+	}
+	for (size_t i = 0; i < expected.size(); i++) {
+		if (!sameToken(*expected[i], *actual.createToken(i))) {
+			std::cerr << "Token mismatch at " << expected[i]->s.row() << ':'
+			          << expected[i]->s.col() << '\n';
+			return EXIT_FAILURE;
+		}
+	}
+	if (errorHandler.handleErrors(std::cerr)) {
+		return EXIT_FAILURE;
+	}
+
+	std::cout << program.size() << " bytes, " << actual.size() << " tokens\n";
+	double legacySeconds = bench::timeBest(REPETITIONS, [&]() {
+		legacy::Lexer(program, "bench.canyon", &errorHandler).lex();
+	});
+	bench::report("three-pass lexer", legacySeconds, program.size(), expected.size());
+	double seconds = bench::timeBest(REPETITIONS, [&]() {
+		Lexer(program, "bench.canyon", &errorHandler).lex();
+	});
+	bench::report("single-pass lexer", seconds, program.size(), actual.size());
+	std::cout << "speedup: " << legacySeconds / seconds << "x\n";
+	return EXIT_SUCCESS;
+}
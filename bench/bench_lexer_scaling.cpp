@@ -0,0 +1,86 @@
+#include "bench_utilities.h"
+#include "errorhandler.h"
+#include "interner.h"
+#include "lexer.h"
+#include "threadpool.h"
+#include "tokenbuffer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+/// Measures how the Lexer's throughput scales with the number of threads it splits a
+/// large program across, after checking that every thread count gives the same Tokens
+/// and SymbolIDs as lexing in sequence.
+/// Usage: bench_lexer_scaling [size in MiB (default = 64)]
+///        [most threads (default = one per hardware thread)]
+
+static bool sameTokens(const TokenBuffer &lhs, const TokenBuffer &rhs) {
+	const Interner &lhsNames = *lhs.getInterner();
+	const Interner &rhsNames = *rhs.getInterner();
+	if (lhs.size() != rhs.size() || lhsNames.size() != rhsNames.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < lhs.size(); i++) {
+		if (lhs.kind(i) != rhs.kind(i) || lhs.subtype(i) != rhs.subtype(i)
+		      || lhs.value(i) != rhs.value(i) || lhs.contents(i) != rhs.contents(i)
+		      || lhs.contents(i).data() != rhs.contents(i).data()) {
+			return false;
+		}
+	}
+	for (SymbolID id = 0; id < lhsNames.size(); id++) {
+		if (lhsNames.getName(id) != rhsNames.getName(id)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char **argv) {
+	constexpr size_t MEBIBYTE = 1024 * 1024;
+	constexpr int REPETITIONS = 5;
+	size_t size = 64 * MEBIBYTE;
+	if (argc > 1) {
+		size = std::stoul(argv[1]) * MEBIBYTE;
+	}
+	size_t mostThreads = std::max(std::thread::hardware_concurrency(), 1U);
+	if (argc > 2) {
+		mostThreads = std::stoul(argv[2]);
+	}
+	const std::string program = bench::generateProgram(size);
+
+	ErrorHandler errorHandler;
+	TokenBuffer expected = Lexer(program, "bench.canyon", &errorHandler).lex();
+	if (errorHandler.handleErrors(std::cerr)) {
+		return EXIT_FAILURE;
+	}
+	std::cout << program.size() << " bytes, " << expected.size() << " tokens\n";
+
+	double sequentialSeconds = bench::timeBest(REPETITIONS, [&]() {
+		Lexer(program, "bench.canyon", &errorHandler).lex();
+	});
+	bench::report("sequential", sequentialSeconds, program.size(), expected.size());
+	for (size_t threads = 1; threads <= mostThreads; threads++) {
+		ThreadPool threadPool(threads);
+		auto lex = [&]() {
+			Lexer lexer(program, "bench.canyon", &errorHandler, Lexer::DEFAULT_TAB_SIZE,
+			      &threadPool);
+			return lexer.lex();
+		};
+		if (!sameTokens(lex(), expected)) {
+			std::cerr << "Tokens differ from sequential lexing on " << threads
+			          << " threads\n";
+			return EXIT_FAILURE;
+		}
+		double seconds = bench::timeBest(REPETITIONS, [&]() {
+			lex();
+		});
+		bench::report(std::to_string(threads) + " threads", seconds, program.size(),
+		      expected.size());
+		std::cout << "speedup: " << sequentialSeconds / seconds << "x\n";
+	}
+	return EXIT_SUCCESS;
+}
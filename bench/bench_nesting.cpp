@@ -0,0 +1,120 @@
+#include "ast.h"
+#include "bench_utilities.h"
+#include "ccodegenerator.h"
+#include "errorhandler.h"
+#include "lexer.h"
+#include "outputfile.h"
+#include "parser.h"
+#include "semanticanalyzer.h"
+#include "tokenbuffer.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/// Measures how the time and memory taken to compile a program, from lexing through
+/// code generation, grow with how deeply it nests. Each shape nests up to a chosen depth,
+/// which for all but a chain of left-associative operators is bounded by
+/// Parser::MAX_NESTING_DEPTH. Depths are measured in increasing order, since peak RSS is
+/// per process, so each shape is measured by a separate run.
+/// Usage: bench_nesting [chain | parentheses | unary | blocks | scopes | elseif
+///                      (default = chain)]
+///                      [deepest depth (default = 1048576 for chain, else as deep as the
+///                      limit allows)]
+
+/**
+ * @brief Generates a program whose only interesting expression nests to a given depth
+ *
+ * @param shape how the expression nests
+ * @param depth how many levels it nests
+ * @return the source code, or an empty string if the shape is unknown
+ */
+static std::string generateNestedProgram(std::string_view shape, size_t depth) {
+	std::string expression;
+	if (shape == "chain") {
+		expression = "1";
+		for (size_t i = 0; i < depth; i++) {
+			expression += " + 1";
+		}
+	} else if (shape == "parentheses") {
+		expression = std::string(depth, '(') + "1" + std::string(depth, ')');
+	} else if (shape == "unary") {
+		for (size_t i = 0; i < depth; i++) {
+			expression += "- ";
+		}
+		expression += "1";
+	} else if (shape == "blocks") {
+		expression = std::string(depth, '{') + " 1 " + std::string(depth, '}');
+	} else if (shape == "scopes") {
+		// Each block refers to a variable declared outside all of them
+		for (size_t i = 0; i < depth; i++) {
+			expression += "{ a + ";
+		}
+		expression += "1" + std::string(depth, '}');
+	} else if (shape == "elseif") {
+		for (size_t i = 0; i < depth; i++) {
+			expression += "if a == 0 { 0 } else ";
+		}
+		expression += "{ 1 }";
+	} else {
+		return "";
+	}
+	return "fun main() {\n\tlet a: i32 = 1;\n\tlet b: i32 = " + expression
+	       + ";\n\tprintI32(b);\n}\n";
+}
+
+int main(int argc, char **argv) {
+	constexpr int REPETITIONS = 5;
+	// Leaves room for the levels that enclose the nested expression
+	constexpr size_t ENCLOSING_LEVELS = 16;
+	std::string_view shape = "chain";
+	if (argc > 1) {
+		shape = argv[1];
+	}
+	size_t deepest = shape == "chain" ? 1024 * 1024
+	                                  : Parser::MAX_NESTING_DEPTH - ENCLOSING_LEVELS;
+	if (shape == "scopes") {
+		// The block, the right operand of +, and the unary expression it is parsed as
+		// each count towards the limit
+		deepest /= 3;
+	}
+	if (argc > 2) {
+		deepest = std::stoul(argv[2]);
+	}
+	if (generateNestedProgram(shape, 0).empty()) {
+		std::cerr << "Unknown shape " << shape << '\n';
+		return EXIT_FAILURE;
+	}
+
+	OutputFile sink = bench::openNullOutput();
+	long baseline = bench::peakResidentKiB();
+
+	std::cout << shape << ", peak RSS growth is cumulative\n";
+	// Doubles the depth up to the deepest
+	for (int halvings = 5; halvings >= 0; halvings--) {
+		const size_t depth = deepest >> halvings;
+		const std::string program = generateNestedProgram(shape, depth);
+		auto compile = [&program, &sink]() {
+			ErrorHandler errorHandler;
+			TokenBuffer tokens = Lexer(program, "bench.canyon", &errorHandler).lex();
+			std::unique_ptr<Module> module
+			      = Parser(std::move(tokens), &errorHandler).parse();
+			if (errorHandler.handleErrors(std::cerr)) {
+				std::exit(EXIT_FAILURE);
+			}
+			SemanticAnalyzer(module.get(), &errorHandler).analyze();
+			if (errorHandler.handleErrors(std::cerr)) {
+				std::exit(EXIT_FAILURE);
+			}
+			CCodeGenerator(module.get(), &sink).generate();
+		};
+		double seconds = bench::timeBest(REPETITIONS, compile);
+		bench::report("depth " + std::to_string(depth), seconds, program.size(), depth);
+		std::cout << "    peak RSS growth: " << bench::peakResidentKiB() - baseline
+		          << " KiB\n";
+	}
+	return EXIT_SUCCESS;
+}
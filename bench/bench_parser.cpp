@@ -0,0 +1,84 @@
+#include "ast.h"
+#include "bench_utilities.h"
+#include "errorhandler.h"
+#include "lexer.h"
+#include "parser.h"
+#include "threadpool.h"
+#include "tokenbuffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+
+/// Measures how long it takes to build the AST and to tear it down again, and how much
+/// memory it occupies. Peak RSS is per process, so it is measured before repeating. If a
+/// Canyon source file is given, it is repeated up to the size instead of generating one.
+/// Top-level functions are parsed on the given number of threads.
+/// Usage: bench_parser [size in MiB (default = 16)] [source file, or - to generate one]
+///        [threads (default = 1, 0 = one per hardware thread)]
+
+int main(int argc, char **argv) {
+	constexpr size_t MEBIBYTE = 1024 * 1024;
+	constexpr int REPETITIONS = 5;
+	size_t size = 16 * MEBIBYTE;
+	if (argc > 1) {
+		size = std::stoul(argv[1]) * MEBIBYTE;
+	}
+	std::string program;
+	if (argc > 2 && std::string(argv[2]) != "-") {
+		std::ifstream file(argv[2]);
+		std::stringstream contents;
+		contents << file.rdbuf();
+		if (!file || contents.str().empty()) {
+			std::cerr << "Unable to read " << argv[2] << '\n';
+			return EXIT_FAILURE;
+		}
+		while (program.size() < size) {
+			program += contents.str();
+		}
+	} else {
+		program = bench::generateProgram(size);
+	}
+	ThreadPool threadPool(argc > 3 ? std::stoul(argv[3]) : 1);
+	ErrorHandler errorHandler;
+
+	double parseSeconds = std::numeric_limits<double>::max();
+	double destroySeconds = std::numeric_limits<double>::max();
+	size_t count = 0;
+	for (int i = 0; i < REPETITIONS; i++) {
+		TokenBuffer tokens = Lexer(program, "bench.canyon", &errorHandler).lex();
+		count = tokens.size();
+		long baseline = bench::peakResidentKiB();
+
+		auto start = std::chrono::steady_clock::now();
+		std::unique_ptr<Module> module
+		      = Parser(std::move(tokens), &errorHandler, &threadPool).parse();
+		auto parsed = std::chrono::steady_clock::now();
+		if (errorHandler.handleErrors(std::cerr)) {
+			return EXIT_FAILURE;
+		}
+		if (i == 0) {
+			std::cout << program.size() << " bytes, " << count << " tokens, "
+			          << threadPool.size() << " threads\n";
+			std::cout << "peak RSS growth while parsing: "
+			          << bench::peakResidentKiB() - baseline << " KiB\n";
+		}
+		module.reset();
+		auto destroyed = std::chrono::steady_clock::now();
+
+		parseSeconds = std::min(parseSeconds,
+		      std::chrono::duration<double>(parsed - start).count());
+		destroySeconds = std::min(destroySeconds,
+		      std::chrono::duration<double>(destroyed - parsed).count());
+	}
+	bench::report("parse", parseSeconds, program.size(), count);
+	bench::report("destroy AST", destroySeconds, program.size(), count);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,65 @@
+#include "ast.h"
+#include "bench_utilities.h"
+#include "builtinapi.h"
+#include "ccodegenerator.h"
+#include "config.h"
+#include "errorhandler.h"
+#include "lexer.h"
+#include "outputfile.h"
+#include "parser.h"
+#include "semanticanalyzer.h"
+#include "tokenbuffer.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+
+/// Measures the fixed cost of compiling a tiny program, which dominates when many small
+/// files are compiled one process at a time, with the builtin API embedded at build time
+/// and with it read from BUILTIN_API_PATH as --builtin-api does.
+/// Usage: bench_startup [compiles (default = 1000)]
+
+int main(int argc, char **argv) {
+	constexpr int REPETITIONS = 5;
+	size_t compiles = 1000;
+	if (argc > 1) {
+		compiles = std::stoul(argv[1]);
+	}
+	const std::string program = "fun main() {\n\tprintI32(1);\n}\n";
+	OutputFile sink = bench::openNullOutput();
+
+	auto compile = [&program, &sink](bool readApi) {
+		ErrorHandler errorHandler;
+		TokenBuffer tokens = Lexer(program, "bench.canyon", &errorHandler).lex();
+		std::unique_ptr<Module> module = Parser(std::move(tokens), &errorHandler).parse();
+		if (readApi) {
+			std::ifstream apiFile(BUILTIN_API_PATH);
+			BuiltinApi builtinApi(apiFile);
+			SemanticAnalyzer(module.get(), &errorHandler, builtinApi).analyze();
+		} else {
+			SemanticAnalyzer(module.get(), &errorHandler).analyze();
+		}
+		if (errorHandler.handleErrors(std::cerr)) {
+			std::exit(EXIT_FAILURE);
+		}
+		CCodeGenerator(module.get(), &sink).generate();
+	};
+	double embedded = bench::timeBest(REPETITIONS, [&compile, compiles]() {
+		for (size_t i = 0; i < compiles; i++) {
+			compile(false);
+		}
+	});
+	double read = bench::timeBest(REPETITIONS, [&compile, compiles]() {
+		for (size_t i = 0; i < compiles; i++) {
+			compile(true);
+		}
+	});
+	std::cout << compiles << " compiles of a " << program.size() << " byte program\n";
+	bench::report("embedded builtin API", embedded, program.size() * compiles, compiles);
+	bench::report("read builtin API", read, program.size() * compiles, compiles);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+#include "ast.h"
+#include "bench_utilities.h"
+#include "ccodegenerator.h"
+#include "errorhandler.h"
+#include "lexer.h"
+#include "outputfile.h"
+#include "parser.h"
+#include "semanticanalyzer.h"
+#include "threadpool.h"
+#include "tokenbuffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+
+/// Measures each phase of compiling a program in which nearly every identifier is
+/// distinct, so that the cost of looking identifiers up by name dominates. Function
+/// bodies are analyzed on the given number of threads.
+/// Usage: bench_symbols [distinct identifiers (default = 100000)]
+///        [threads (default = 1, 0 = one per hardware thread)]
+
+/**
+ * @brief Generates a program with about the requested number of distinct identifiers.
+ * Each function has its own parameters and locals, which are referred to from nested
+ * blocks, and calls the function before it
+ *
+ * @param identifiers the minimum number of distinct identifiers
+ * @return the source code
+ */
+static std::string generateIdentifiers(size_t identifiers) {
+	constexpr size_t IDENTIFIERS_PER_FUNCTION = 6;
+	std::string program;
+	size_t functions = identifiers / IDENTIFIERS_PER_FUNCTION + 1;
+	for (size_t i = 0; i < functions; i++) {
+		const std::string n = std::to_string(i);
+		program += "fun function" + n + "(first" + n + ": i32, second" + n
+		           + ": i32): i32 {\n";
+		program += "\tlet sum" + n + ": i32 = first" + n + " + second" + n + ";\n";
+		program += "\tlet product" + n + ": i32 = {\n";
+		program += "\t\tlet inner" + n + ": i32 = sum" + n + " * first" + n + ";\n";
+		program += "\t\tinner" + n + " - second" + n + "\n\t};\n";
+		if (i > 0) {
+			program += "\tfunction" + std::to_string(i - 1) + "(sum" + n + ", product" + n
+			           + ")\n";
+		} else {
+			program += "\tsum" + n + " + product" + n + "\n";
+		}
+		program += "}\n\n";
+	}
+	program += "fun main() {\n\tprintI32(function" + std::to_string(functions - 1)
+	           + "(1, 2));\n}\n";
+	return program;
+}
+
+int main(int argc, char **argv) {
+	constexpr int REPETITIONS = 5;
+	size_t identifiers = 100000;
+	if (argc > 1) {
+		identifiers = std::stoul(argv[1]);
+	}
+	ThreadPool threadPool(argc > 2 ? std::stoul(argv[2]) : 1);
+	const std::string program = generateIdentifiers(identifiers);
+
+	OutputFile sink = bench::openNullOutput();
+
+	double lexSeconds = std::numeric_limits<double>::max();
+	double parseSeconds = std::numeric_limits<double>::max();
+	double analyzeSeconds = std::numeric_limits<double>::max();
+	double generateSeconds = std::numeric_limits<double>::max();
+	size_t count = 0;
+	auto seconds = [](auto start, auto end) {
+		return std::chrono::duration<double>(end - start).count();
+	};
+	for (int i = 0; i < REPETITIONS; i++) {
+		ErrorHandler errorHandler;
+		auto start = std::chrono::steady_clock::now();
+		TokenBuffer tokens = Lexer(program, "bench.canyon", &errorHandler).lex();
+		auto lexed = std::chrono::steady_clock::now();
+		count = tokens.size();
+		std::unique_ptr<Module> module = Parser(std::move(tokens), &errorHandler).parse();
+		auto parsed = std::chrono::steady_clock::now();
+		if (errorHandler.handleErrors(std::cerr)) {
+			return EXIT_FAILURE;
+		}
+		auto analyzeStart = std::chrono::steady_clock::now();
+		SemanticAnalyzer(module.get(), &errorHandler, &threadPool).analyze();
+		auto analyzed = std::chrono::steady_clock::now();
+		if (errorHandler.handleErrors(std::cerr)) {
+			return EXIT_FAILURE;
+		}
+		CCodeGenerator(module.get(), &sink).generate();
+		auto generated = std::chrono::steady_clock::now();
+
+		lexSeconds = std::min(lexSeconds, seconds(start, lexed));
+		parseSeconds = std::min(parseSeconds, seconds(lexed, parsed));
+		analyzeSeconds = std::min(analyzeSeconds, seconds(analyzeStart, analyzed));
+		generateSeconds = std::min(generateSeconds, seconds(analyzed, generated));
+	}
+	std::cout << program.size() << " bytes, " << count << " tokens, at least "
+	          << identifiers << " distinct identifiers, " << threadPool.size()
+	          << " threads\n";
+	bench::report("lex", lexSeconds, program.size(), count);
+	bench::report("parse", parseSeconds, program.size(), count);
+	bench::report("analyze", analyzeSeconds, program.size(), count);
+	bench::report("generate C", generateSeconds, program.size(), count);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+#include "bench_utilities.h"
+#include "errorhandler.h"
+#include "legacy_lexer.h"
+#include "lexer.h"
+#include "parser.h"
+#include "sourcemanager.h"
+#include "tokenbuffer.h"
+#include "tokens.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Measures the throughput and memory footprint of the TokenBuffer. Peak RSS is per
+/// process, so each representation is measured by a separate run.
+/// Usage: bench_tokens [size in MiB (default = 16)] [buffer | legacy (default = buffer)]
+
+int main(int argc, char **argv) {
+	constexpr size_t MEBIBYTE = 1024 * 1024;
+	constexpr int REPETITIONS = 5;
+	size_t size = 16 * MEBIBYTE;
+	if (argc > 1) {
+		size = std::stoul(argv[1]) * MEBIBYTE;
+	}
+	std::string_view mode = "buffer";
+	if (argc > 2) {
+		mode = argv[2];
+	}
+	const std::string program = bench::generateProgram(size);
+	ErrorHandler errorHandler;
+	long baseline = bench::peakResidentKiB();
+
+	if (mode == "legacy") {
+		// The original representation: one heap-allocated Token per element
+		std::vector<std::unique_ptr<Token>> tokens
+		      = legacy::Lexer(program, "bench.canyon", &errorHandler).lex();
+		std::cout << program.size() << " bytes, " << tokens.size() << " tokens\n";
+		std::cout << "peak RSS while holding tokens: "
+		          << bench::peakResidentKiB() - baseline << " KiB above input\n";
+		return EXIT_SUCCESS;
+	}
+	if (mode != "buffer") {
+		std::cerr << "Unknown mode " << mode << '\n';
+		return EXIT_FAILURE;
+	}
+
+	size_t count = 0;
+	double seconds = bench::timeBest(REPETITIONS, [&]() {
+		count = Lexer(program, "bench.canyon", &errorHandler).lex().size();
+	});
+	bench::report("lex into TokenBuffer", seconds, program.size(), count);
+	size_t row = 0;
+	double indexSeconds = bench::timeBest(REPETITIONS, [&]() {
+		// A fresh FileID has no line index yet, so the first lookup builds one
+		FileID file = SourceManager::addFile("bench.canyon", program, 4);
+		row = SourceManager::getLocation(file, program.data() + program.size()).first;
+	});
+	bench::report("index lines", indexSeconds, program.size(), row);
+
+	TokenBuffer tokens = Lexer(program, "bench.canyon", &errorHandler).lex();
+	std::cout << program.size() << " bytes, " << tokens.size() << " tokens, "
+	          << static_cast<double>(tokens.memoryUsage()) / tokens.size()
+	          << " bytes/token\n";
+	std::cout << "peak RSS while holding tokens: "
+	          << bench::peakResidentKiB() - baseline << " KiB above input\n";
+	std::unique_ptr<Module> module = Parser(std::move(tokens), &errorHandler).parse();
+	if (errorHandler.handleErrors(std::cerr)) {
+		return EXIT_FAILURE;
+	}
+	std::cout << "peak RSS after parsing: " << bench::peakResidentKiB() - baseline
+	          << " KiB above input\n";
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+#ifndef BENCH_UTILITIES_H
+#define BENCH_UTILITIES_H
+
+#include "outputfile.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/// Shared helpers for the benchmark executables: synthetic Canyon sources, timing, and
+/// reporting
+
+namespace bench {
+
+/**
+ * @brief Generates a valid Canyon program of at least the requested size. The program
+ * exercises every token kind (keywords, multi-character operators, literals with
+ * suffixes, character escapes, and both comment styles) along with nested blocks, ifs,
+ * whiles, and calls between functions
+ *
+ * @param bytes the minimum size of the program
+ * @return the generated source code
+ */
+inline std::string generateProgram(size_t bytes) {
+	std::string program;
+	program.reserve(bytes + 1024);
+	size_t function = 0;
+	while (program.size() < bytes) {
+		const std::string n = std::to_string(function);
+		program += "// Function number " + n + "\n";
+		program += "fun f" + n + "(a: i32, b: i32): i32 {\n";
+		program += "\tlet x: i32 = a * 3 + (b - " + n + ") % 7;\n";
+		program += "\tlet y: i32 = (x << 2) >> 1 ^ ~a & 0x7Fi32 | 0b101;\n";
+		program += "\tlet big: u64 = 18446744073709551615u64;\n";
+		program += "\tlet c: char = '\\n';\n";
+		program += "\tlet d: char = 'q';\n";
+		program += "\t/* Block comments may\n\t   span lines */\n";
+		program += "\tlet flag: bool = a <= b && !(x == y) || a != 0 && b >= 1;\n";
+		program += "\tlet z: i32 = if flag {\n\t\tx - y\n\t} else if a > b {\n";
+		program += "\t\t{ let w: i32 = -x; w + 0o17 }\n\t} else {\n\t\t+y\n\t};\n";
+		program += "\twhile false {\n\t\tx = x + 1;\n\t};\n";
+		if (function > 0) {
+			program += "\tf" + std::to_string(function - 1) + "(z, x) / 2\n";
+		} else {
+			program += "\tz / 2\n";
+		}
+		program += "}\n\n";
+		function++;
+	}
+	program += "fun main() {\n\tprintI32(f" + std::to_string(function - 1)
+	           + "(1, 2));\n}\n";
+	return program;
+}
+
+/**
+ * @brief Runs a function repeatedly and reports the fastest run
+ *
+ * @param repetitions how many times to run the function
+ * @param f the function to time
+ * @return the duration of the fastest run, in seconds
+ */
+inline double timeBest(int repetitions, const std::function<void()> &f) {
+	double best = std::numeric_limits<double>::max();
+	for (int i = 0; i < repetitions; i++) {
+		auto start = std::chrono::steady_clock::now();
+		f();
+		auto end = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double>(end - start).count());
+	}
+	return best;
+}
+
+/**
+ * @brief Gets the peak resident set size of this process so far
+ *
+ * @return the peak resident set size, in kibibytes
+ */
+inline long peakResidentKiB() {
+	rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+/**
+ * @brief Opens /dev/null to generate code into, so that code generation is measured with
+ * the same buffered writes as the compiler but without keeping its output
+ */
+inline OutputFile openNullOutput() {
+	std::optional<OutputFile> file = OutputFile::open("/dev/null");
+	if (!file.has_value()) {
+		std::cerr << "Unable to open /dev/null\n";
+		std::exit(EXIT_FAILURE);
+	}
+	return std::move(*file);
+}
+
+/**
+ * @brief Prints a single benchmark result line
+ *
+ * @param name what was measured
+ * @param seconds the time taken
+ * @param bytes how many bytes of source code were processed
+ * @param items how many items (e.g. tokens) were produced
+ */
+inline void report(std::string_view name, double seconds, size_t bytes, size_t items) {
+	constexpr double MEGABYTE = 1024.0 * 1024.0;
+	std::cout << std::left << std::setw(32) << name << std::right << std::fixed
+	          << std::setprecision(3) << std::setw(10) << seconds * 1000 << " ms"
+	          << std::setw(10) << bytes / MEGABYTE / seconds << " MiB/s" << std::setw(14)
+	          << static_cast<uint64_t>(items / seconds) << " items/s\n";
+}
+
+} // namespace bench
+
+#endif
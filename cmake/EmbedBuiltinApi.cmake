@@ -0,0 +1,52 @@
+# Turns the JSON description of the builtin API into constexpr C++ tables, which
+# src/builtinapi.cpp includes so that the compiler never reads or parses it at runtime.
+# Functions are listed in order of name, which is also the order nlohmann::json iterates
+# them in when the API is overridden with --builtin-api.
+# Usage: cmake -DINPUT=<builtin_api.json> -DOUTPUT=<builtin_api_table.inc> -P EmbedBuiltinApi.cmake
+file(READ ${INPUT} API)
+string(JSON FUNCTIONS GET "${API}" functions)
+string(JSON FUNCTION_COUNT LENGTH "${FUNCTIONS}")
+
+set(NAMES "")
+if(FUNCTION_COUNT GREATER 0)
+    math(EXPR LAST_FUNCTION "${FUNCTION_COUNT} - 1")
+
+    foreach(INDEX RANGE ${LAST_FUNCTION})
+        string(JSON NAME MEMBER "${FUNCTIONS}" ${INDEX})
+        list(APPEND NAMES ${NAME})
+    endforeach()
+endif()
+
+list(SORT NAMES)
+
+set(PARAMETER_ROWS "")
+set(FUNCTION_ROWS "")
+set(PARAMETER_COUNT 0)
+
+foreach(NAME IN LISTS NAMES)
+    string(JSON PARAMETERS GET "${FUNCTIONS}" ${NAME} parameters)
+    string(JSON FUNCTION_PARAMETER_COUNT LENGTH "${PARAMETERS}")
+    string(JSON RETURN_TYPE GET "${FUNCTIONS}" ${NAME} returnType)
+
+    if(FUNCTION_PARAMETER_COUNT GREATER 0)
+        math(EXPR LAST_PARAMETER "${FUNCTION_PARAMETER_COUNT} - 1")
+
+        foreach(INDEX RANGE ${LAST_PARAMETER})
+            string(JSON PARAMETER_NAME GET "${PARAMETERS}" ${INDEX} name)
+            string(JSON PARAMETER_TYPE GET "${PARAMETERS}" ${INDEX} type)
+            string(APPEND PARAMETER_ROWS
+                "\tBuiltinParameter{\"${PARAMETER_NAME}\", \"${PARAMETER_TYPE}\"},\n")
+        endforeach()
+    endif()
+
+    string(APPEND FUNCTION_ROWS "\tBuiltinFunction{\"${NAME}\", ${PARAMETER_COUNT}, "
+        "${FUNCTION_PARAMETER_COUNT}, \"${RETURN_TYPE}\"},\n")
+    math(EXPR PARAMETER_COUNT "${PARAMETER_COUNT} + ${FUNCTION_PARAMETER_COUNT}")
+endforeach()
+
+file(WRITE ${OUTPUT}
+    "// Generated from ${INPUT} by cmake/EmbedBuiltinApi.cmake\n"
+    "constexpr std::array<BuiltinParameter, ${PARAMETER_COUNT}> PARAMETERS = {\n"
+    "${PARAMETER_ROWS}};\n"
+    "constexpr std::array<BuiltinFunction, ${FUNCTION_COUNT}> FUNCTIONS = {\n"
+    "${FUNCTION_ROWS}};\n")
@@ -0,0 +1,10 @@
+#include "arena.h"
+
+#include <memory_resource>
+
+Arena::Arena() : resource(INITIAL_CHUNK_SIZE) {
+}
+
+std::pmr::memory_resource *Arena::getResource() {
+	return &resource;
+}
@@ -0,0 +1,56 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A growable array whose storage is taken from an Arena
+ */
+template <typename T>
+using ArenaVector = std::pmr::vector<T>;
+
+/**
+ * @brief A bump-pointer allocator which hands out memory from a list of chunks of
+ * geometrically increasing size. Objects made in an Arena are never destroyed one by
+ * one; all of their memory is released at once when the Arena is destroyed, at a cost
+ * proportional to the number of chunks. Anything they own must therefore also be
+ * allocated from the Arena, such as the storage of an ArenaVector
+ *
+ */
+class Arena {
+	static constexpr size_t INITIAL_CHUNK_SIZE = 64 * 1024;
+	std::pmr::monotonic_buffer_resource resource;
+public:
+	Arena();
+	Arena(const Arena &) = delete;
+	Arena &operator=(const Arena &) = delete;
+	~Arena() = default;
+
+	/**
+	 * @brief Constructs an object in the Arena. Its destructor is never called
+	 *
+	 * @param args the arguments to T's constructor
+	 * @return a pointer to the object, which is valid for the lifetime of the Arena
+	 */
+	template <typename T, typename... Args>
+	T *make(Args &&...args) {
+		void *memory = resource.allocate(sizeof(T), alignof(T));
+		return new (memory) T(std::forward<Args>(args)...);
+	}
+
+	/**
+	 * @brief Creates an empty ArenaVector whose storage is allocated from the Arena
+	 */
+	template <typename T>
+	ArenaVector<T> makeVector() {
+		return ArenaVector<T>(&resource);
+	}
+
+	std::pmr::memory_resource *getResource();
+};
+
+#endif
@@ -1,12 +1,23 @@
 #include "ast.h"
 
+#include "arena.h"
+#include "casting.h"
+#include "interner.h"
+#include "sourcemanager.h"
+
+#include <algorithm>
+#include <cstddef>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <string_view>
 #include <utility>
 #include <vector>
 
-Expression::Expression(const Slice &s) : s(s) {
+ASTComponent::ASTComponent(ASTKind kind) : kind(kind) {
+}
+
+Expression::Expression(ASTKind kind, const Slice &s) : ASTComponent(kind), s(s) {
 }
 
 int Expression::getTypeID() const {
@@ -21,24 +32,25 @@ Slice &Expression::getSlice() {
 	return s;
 }
 
-Statement::Statement(const Slice &s) : s(s) {
+Statement::Statement(ASTKind kind, const Slice &s) : ASTComponent(kind), s(s) {
 }
 
 Slice &Statement::getSlice() {
 	return s;
 }
 
-FunctionCallExpression::FunctionCallExpression(std::unique_ptr<Expression> function,
-      [[maybe_unused]] const Punctuation &open,
-      std::vector<std::unique_ptr<Expression>> arguments, const Punctuation &close)
-    : Expression(Slice::merge(function->getSlice(), close.s)),
-      function(std::move(function)), arguments(std::move(arguments)) {
+FunctionCallExpression::FunctionCallExpression(Expression *function,
+      [[maybe_unused]] const Punctuation &open, ArenaVector<Expression *> arguments,
+      const Punctuation &close)
+    : Expression(ASTKind::FunctionCallExpression,
+            Slice::merge(function->getSlice(), close.s)),
+      function(function), arguments(std::move(arguments)) {
 }
 
-FunctionCallExpression::FunctionCallExpression(std::unique_ptr<Expression> function,
-      std::vector<std::unique_ptr<Expression>> arguments)
-    : Expression(function->getSlice()), function(std::move(function)),
-      arguments(std::move(arguments)) {
+FunctionCallExpression::FunctionCallExpression(Expression *function,
+      ArenaVector<Expression *> arguments)
+    : Expression(ASTKind::FunctionCallExpression, function->getSlice()),
+      function(function), arguments(std::move(arguments)) {
 }
 
 Expression &FunctionCallExpression::getFunction() {
@@ -52,14 +64,18 @@ void FunctionCallExpression::forEachArgument(
 	}
 }
 
+void FunctionCallExpression::setArgument(size_t index, Expression *argument) {
+	arguments[index] = argument;
+}
+
 void FunctionCallExpression::accept(ASTVisitor &visitor) {
 	visitor.visit(*this);
 }
 
-BinaryExpression::BinaryExpression(std::unique_ptr<Operator> op,
-      std::unique_ptr<Expression> left, std::unique_ptr<Expression> right)
-    : Expression(Slice::merge(left->getSlice(), right->getSlice())), op(std::move(op)),
-      left(std::move(left)), right(std::move(right)) {
+BinaryExpression::BinaryExpression(Operator *op, Expression *left, Expression *right)
+    : Expression(ASTKind::BinaryExpression,
+            Slice::merge(left->getSlice(), right->getSlice())),
+      op(op), left(left), right(right) {
 }
 
 Expression &BinaryExpression::getLeft() {
@@ -70,24 +86,44 @@ Expression &BinaryExpression::getRight() {
 	return *right;
 }
 
+void BinaryExpression::setLeft(Expression *left) {
+	this->left = left;
+}
+
+void BinaryExpression::setRight(Expression *right) {
+	this->right = right;
+}
+
 Operator &BinaryExpression::getOperator() {
 	return *op;
 }
 
+std::vector<BinaryExpression *> BinaryExpression::getLeftChain() {
+	std::vector<BinaryExpression *> chain;
+	for (BinaryExpression *node = this; node != nullptr;
+	      node = dyn_cast<BinaryExpression>(node->left)) {
+		chain.push_back(node);
+	}
+	return chain;
+}
+
 void BinaryExpression::accept(ASTVisitor &visitor) {
 	visitor.visit(*this);
 }
 
-UnaryExpression::UnaryExpression(std::unique_ptr<Operator> op,
-      std::unique_ptr<Expression> operand)
-    : Expression(Slice::merge(op->s, operand->getSlice())), op(std::move(op)),
-      operand(std::move(operand)) {
+UnaryExpression::UnaryExpression(Operator *op, Expression *operand)
+    : Expression(ASTKind::UnaryExpression, Slice::merge(op->s, operand->getSlice())),
+      op(op), operand(operand) {
 }
 
 Expression &UnaryExpression::getExpression() {
 	return *operand;
 }
 
+void UnaryExpression::setExpression(Expression *operand) {
+	this->operand = operand;
+}
+
 Operator &UnaryExpression::getOperator() {
 	return *op;
 }
@@ -96,9 +132,8 @@ void UnaryExpression::accept(ASTVisitor &visitor) {
 	visitor.visit(*this);
 }
 
-IntegerLiteralExpression::IntegerLiteralExpression(
-      std::unique_ptr<IntegerLiteral> literal)
-    : Expression(literal->s), literal(std::move(literal)) {
+IntegerLiteralExpression::IntegerLiteralExpression(IntegerLiteral *literal)
+    : Expression(ASTKind::IntegerLiteralExpression, literal->s), literal(literal) {
 }
 
 IntegerLiteral &IntegerLiteralExpression::getLiteral() {
@@ -109,8 +144,8 @@ void IntegerLiteralExpression::accept(ASTVisitor &visitor) {
 	visitor.visit(*this);
 }
 
-BoolLiteralExpression::BoolLiteralExpression(std::unique_ptr<BoolLiteral> literal)
-    : Expression(literal->s), literal(std::move(literal)) {
+BoolLiteralExpression::BoolLiteralExpression(BoolLiteral *literal)
+    : Expression(ASTKind::BoolLiteralExpression, literal->s), literal(literal) {
 }
 
 BoolLiteral &BoolLiteralExpression::getLiteral() {
@@ -121,9 +156,8 @@ void BoolLiteralExpression::accept(ASTVisitor &visitor) {
 	visitor.visit(*this);
 }
 
-CharacterLiteralExpression::CharacterLiteralExpression(
-      std::unique_ptr<CharacterLiteral> literal)
-    : Expression(literal->s), literal(std::move(literal)) {
+CharacterLiteralExpression::CharacterLiteralExpression(CharacterLiteral *literal)
+    : Expression(ASTKind::CharacterLiteralExpression, literal->s), literal(literal) {
 }
 
 CharacterLiteral &CharacterLiteralExpression::getLiteral() {
@@ -134,26 +168,38 @@ void CharacterLiteralExpression::accept(ASTVisitor &visitor) {
 	visitor.visit(*this);
 }
 
-SymbolExpression::SymbolExpression(std::unique_ptr<Symbol> symbol)
-    : Expression(symbol->s), symbol(std::move(symbol)) {
+SymbolExpression::SymbolExpression(Symbol *symbol)
+    : Expression(ASTKind::SymbolExpression, symbol->s), symbol(symbol) {
 }
 
 Symbol &SymbolExpression::getSymbol() {
 	return *symbol;
 }
 
+const Binding &SymbolExpression::getBinding() const {
+	return binding;
+}
+
+void SymbolExpression::setBinding(const Binding &binding) {
+	this->binding = binding;
+}
+
 void SymbolExpression::accept(ASTVisitor &visitor) {
 	visitor.visit(*this);
 }
 
 BlockExpression::BlockExpression(const Punctuation &open,
-      std::vector<std::unique_ptr<Statement>> statements,
-      std::unique_ptr<Expression> finalExpression, const Punctuation &close)
-    : Expression(Slice::merge(open.s, close.s)), statements(std::move(statements)),
-      finalExpression(std::move(finalExpression)) {
+      ArenaVector<Statement *> statements, Expression *finalExpression,
+      const Punctuation &close)
+    : Expression(ASTKind::BlockExpression, Slice::merge(open.s, close.s)),
+      statements(std::move(statements)), finalExpression(finalExpression),
+      symbols(this->statements.get_allocator()) {
 }
 
-BlockExpression::BlockExpression() : Expression(Slice("", "", 0, 0)) {
+BlockExpression::BlockExpression(Arena &arena)
+    : Expression(ASTKind::BlockExpression, Slice("", SourceManager::NO_FILE)),
+      statements(arena.getResource()), finalExpression(nullptr),
+      symbols(arena.getResource()) {
 }
 
 void BlockExpression::forEachStatement(
@@ -163,26 +209,31 @@ void BlockExpression::forEachStatement(
 	}
 }
 
+ArenaVector<Statement *> BlockExpression::takeStatements() {
+	ArenaVector<Statement *> taken(std::move(statements));
+	// A moved-from vector keeps its allocator, so the block can still grow in the Arena
+	statements.clear();
+	return taken;
+}
+
 Expression *BlockExpression::getFinalExpression() {
-	return finalExpression.get();
+	return finalExpression;
 }
 
-int BlockExpression::getSymbolType(std::string_view symbol) {
-	if (symbols.find(symbol) == symbols.end()) {
-		return -1;
-	}
-	return std::get<0>(symbols[symbol]);
+void BlockExpression::setFinalExpression(Expression *finalExpression) {
+	this->finalExpression = finalExpression;
 }
 
-SymbolSource BlockExpression::getSymbolSource(std::string_view symbol) {
-	if (symbols.find(symbol) == symbols.end()) {
-		return SymbolSource::Unknown;
+int BlockExpression::getSymbolType(SymbolID symbol) {
+	// Only looks, so that bodies being analyzed at once may read each other's parameters
+	auto found = symbols.find(symbol);
+	if (found == symbols.end()) {
+		return -1;
 	}
-	return std::get<1>(symbols[symbol]);
+	return std::get<0>(found->second);
 }
 
-void BlockExpression::pushSymbol(std::string_view symbol, int typeID,
-      SymbolSource source) {
+void BlockExpression::pushSymbol(SymbolID symbol, int typeID, SymbolSource source) {
 	if (symbols.find(symbol) == symbols.end()) {
 		symbols[symbol] = {typeID, source};
 	} else {
@@ -192,34 +243,39 @@ void BlockExpression::pushSymbol(std::string_view symbol, int typeID,
 }
 
 void BlockExpression::forEachSymbol(
-      const std::function<void(std::string_view, int, SymbolSource)> &symbolHandler) {
+      const std::function<void(SymbolID, int, SymbolSource)> &symbolHandler) {
 	for (auto &[symbol, info] : symbols) {
 		symbolHandler(symbol, std::get<0>(info), std::get<1>(info));
 	}
 }
 
-void BlockExpression::pushStatement(std::unique_ptr<Statement> statement) {
-	statements.push_back(std::move(statement));
+void BlockExpression::pushStatement(Statement *statement) {
+	statements.push_back(statement);
 }
 
 void BlockExpression::accept(ASTVisitor &visitor) {
 	visitor.visit(*this);
 }
 
-ReturnExpression::ReturnExpression(const Keyword &returnKeyword,
-      std::unique_ptr<Expression> expression)
-    : Expression((expression == nullptr)
-                       ? returnKeyword.s
-                       : Slice::merge(returnKeyword.s, expression->getSlice())),
-      expression(std::move(expression)) {
+ReturnExpression::ReturnExpression(const Keyword &returnKeyword, Expression *expression)
+    : Expression(ASTKind::ReturnExpression,
+            (expression == nullptr)
+                  ? returnKeyword.s
+                  : Slice::merge(returnKeyword.s, expression->getSlice())),
+      expression(expression) {
 }
 
-ReturnExpression::ReturnExpression(std::unique_ptr<Expression> expression)
-    : Expression(Slice("", "", 0, 0)), expression(std::move(expression)) {
+ReturnExpression::ReturnExpression(Expression *expression)
+    : Expression(ASTKind::ReturnExpression, Slice("", SourceManager::NO_FILE)),
+      expression(expression) {
 }
 
 Expression *ReturnExpression::getExpression() {
-	return expression.get();
+	return expression;
+}
+
+void ReturnExpression::setExpression(Expression *expression) {
+	this->expression = expression;
 }
 
 void ReturnExpression::accept(ASTVisitor &visitor) {
@@ -227,55 +283,59 @@ void ReturnExpression::accept(ASTVisitor &visitor) {
 }
 
 ParenthesizedExpression::ParenthesizedExpression(const Punctuation &open,
-      std::unique_ptr<Expression> expression, const Punctuation &close)
-    : Expression(Slice::merge(open.s, close.s)), expression(std::move(expression)) {
+      Expression *expression, const Punctuation &close)
+    : Expression(ASTKind::ParenthesizedExpression, Slice::merge(open.s, close.s)),
+      expression(expression) {
 }
 
-ParenthesizedExpression::ParenthesizedExpression(std::unique_ptr<Expression> expression)
-    : Expression(expression->getSlice()), expression(std::move(expression)) {
+ParenthesizedExpression::ParenthesizedExpression(Expression *expression)
+    : Expression(ASTKind::ParenthesizedExpression, expression->getSlice()),
+      expression(expression) {
 }
 
 Expression &ParenthesizedExpression::getExpression() {
 	return *expression;
 }
 
+void ParenthesizedExpression::setExpression(Expression *expression) {
+	this->expression = expression;
+}
+
 void ParenthesizedExpression::accept(ASTVisitor &visitor) {
 	visitor.visit(*this);
 }
 
-IfElseExpression::IfElseExpression(const Keyword &ifKeyword,
-      std::unique_ptr<Expression> condition, std::unique_ptr<BlockExpression> thenBlock,
-      [[maybe_unused]] const Keyword &elseKeyword,
-      std::unique_ptr<Expression> elseExpression)
-    : Expression(Slice::merge(ifKeyword.s, elseExpression->getSlice())),
-      condition(std::move(condition)), thenBlock(std::move(thenBlock)),
-      elseExpression(std::move(elseExpression)) {
+IfElseExpression::IfElseExpression(const Keyword &ifKeyword, Expression *condition,
+      BlockExpression *thenBlock, [[maybe_unused]] const Keyword &elseKeyword,
+      Expression *elseExpression)
+    : Expression(ASTKind::IfElseExpression,
+            Slice::merge(ifKeyword.s, elseExpression->getSlice())),
+      condition(condition), thenBlock(thenBlock), elseExpression(elseExpression) {
 }
 
-IfElseExpression::IfElseExpression(const Keyword &ifKeyword,
-      std::unique_ptr<Expression> condition, std::unique_ptr<BlockExpression> thenBlock)
-    : Expression(Slice::merge(ifKeyword.s, thenBlock->getSlice())),
-      condition(std::move(condition)), thenBlock(std::move(thenBlock)),
-      elseExpression(nullptr) {
+IfElseExpression::IfElseExpression(const Keyword &ifKeyword, Expression *condition,
+      BlockExpression *thenBlock)
+    : Expression(ASTKind::IfElseExpression,
+            Slice::merge(ifKeyword.s, thenBlock->getSlice())),
+      condition(condition), thenBlock(thenBlock), elseExpression(nullptr) {
 }
 
-IfElseExpression::IfElseExpression(std::unique_ptr<Expression> condition,
-      std::unique_ptr<BlockExpression> thenBlock,
-      std::unique_ptr<Expression> elseExpression)
-    : Expression(Slice("", "", 0, 0)), condition(std::move(condition)),
-      thenBlock(std::move(thenBlock)), elseExpression(std::move(elseExpression)) {
+IfElseExpression::IfElseExpression(Expression *condition, BlockExpression *thenBlock,
+      Expression *elseExpression)
+    : Expression(ASTKind::IfElseExpression, Slice("", SourceManager::NO_FILE)),
+      condition(condition), thenBlock(thenBlock), elseExpression(elseExpression) {
 }
 
-WhileExpression::WhileExpression(const Keyword &whileKeyword,
-      std::unique_ptr<Expression> condition, std::unique_ptr<BlockExpression> body)
-    : Expression(Slice::merge(whileKeyword.s, body->getSlice())),
-      condition(std::move(condition)), body(std::move(body)) {
+WhileExpression::WhileExpression(const Keyword &whileKeyword, Expression *condition,
+      BlockExpression *body)
+    : Expression(ASTKind::WhileExpression,
+            Slice::merge(whileKeyword.s, body->getSlice())),
+      condition(condition), body(body) {
 }
 
-WhileExpression::WhileExpression(std::unique_ptr<Expression> condition,
-      std::unique_ptr<BlockExpression> body)
-    : Expression(Slice("", condition->getSlice().source, 0, 0)),
-      condition(std::move(condition)), body(std::move(body)) {
+WhileExpression::WhileExpression(Expression *condition, BlockExpression *body)
+    : Expression(ASTKind::WhileExpression, Slice("", condition->getSlice().source)),
+      condition(condition), body(body) {
 }
 
 Expression &WhileExpression::getCondition() {
@@ -286,6 +346,14 @@ BlockExpression &WhileExpression::getBody() {
 	return *body;
 }
 
+void WhileExpression::setCondition(Expression *condition) {
+	this->condition = condition;
+}
+
+void WhileExpression::setBody(BlockExpression *body) {
+	this->body = body;
+}
+
 void WhileExpression::accept(ASTVisitor &visitor) {
 	visitor.visit(*this);
 }
@@ -299,44 +367,62 @@ BlockExpression &IfElseExpression::getThenBlock() {
 }
 
 Expression *IfElseExpression::getElseExpression() {
-	return elseExpression.get();
+	return elseExpression;
+}
+
+void IfElseExpression::setCondition(Expression *condition) {
+	this->condition = condition;
+}
+
+void IfElseExpression::setThenBlock(BlockExpression *thenBlock) {
+	this->thenBlock = thenBlock;
+}
+
+void IfElseExpression::setElseExpression(Expression *elseExpression) {
+	this->elseExpression = elseExpression;
 }
 
 void IfElseExpression::accept(ASTVisitor &visitor) {
 	visitor.visit(*this);
 }
 
-ExpressionStatement::ExpressionStatement(std::unique_ptr<Expression> expression,
+ExpressionStatement::ExpressionStatement(Expression *expression,
       const Punctuation &semicolon)
-    : Statement(Slice::merge(expression->getSlice(), semicolon.s)),
-      expression(std::move(expression)) {
+    : Statement(ASTKind::ExpressionStatement,
+            Slice::merge(expression->getSlice(), semicolon.s)),
+      expression(expression) {
 }
 
-ExpressionStatement::ExpressionStatement(std::unique_ptr<Expression> expression)
-    : Statement(expression->getSlice()), expression(std::move(expression)) {
+ExpressionStatement::ExpressionStatement(Expression *expression)
+    : Statement(ASTKind::ExpressionStatement, expression->getSlice()),
+      expression(expression) {
 }
 
 Expression &ExpressionStatement::getExpression() {
 	return *expression;
 }
 
+void ExpressionStatement::setExpression(Expression *expression) {
+	this->expression = expression;
+}
+
 void ExpressionStatement::accept(ASTVisitor &visitor) {
 	visitor.visit(*this);
 }
 
-LetStatement::LetStatement(const Keyword &let, std::unique_ptr<Symbol> symbol,
-      std::unique_ptr<Symbol> typeAnnotation, std::unique_ptr<Operator> equalSign,
-      std::unique_ptr<Expression> expression, Punctuation *semicolon)
-    : Statement(Slice::merge(let.s,
-            semicolon != nullptr ? semicolon->s : expression->getSlice())),
-      symbol(std::move(symbol)), typeAnnotation(std::move(typeAnnotation)),
-      equalSign(std::move(equalSign)), expression(std::move(expression)) {
+LetStatement::LetStatement(const Keyword &let, Symbol *symbol, Symbol *typeAnnotation,
+      Operator *equalSign, Expression *expression, Punctuation *semicolon)
+    : Statement(ASTKind::LetStatement,
+            Slice::merge(let.s,
+                  semicolon != nullptr ? semicolon->s : expression->getSlice())),
+      symbol(symbol), typeAnnotation(typeAnnotation), equalSign(equalSign),
+      expression(expression) {
 }
 
-LetStatement::LetStatement(std::unique_ptr<Symbol> symbol,
-      std::unique_ptr<Expression> expression)
-    : Statement(Slice("", "", 0, 0)), symbol(std::move(symbol)), typeAnnotation(nullptr),
-      equalSign(nullptr), expression(std::move(expression)) {
+LetStatement::LetStatement(Symbol *symbol, Expression *expression)
+    : Statement(ASTKind::LetStatement, Slice("", SourceManager::NO_FILE)),
+      symbol(symbol), typeAnnotation(nullptr), equalSign(nullptr),
+      expression(expression) {
 }
 
 Symbol &LetStatement::getSymbol() {
@@ -344,11 +430,15 @@ Symbol &LetStatement::getSymbol() {
 }
 
 Expression *LetStatement::getExpression() {
-	return expression.get();
+	return expression;
+}
+
+void LetStatement::setExpression(Expression *expression) {
+	this->expression = expression;
 }
 
 Symbol *LetStatement::getTypeAnnotation() {
-	return typeAnnotation.get();
+	return typeAnnotation;
 }
 
 Operator &LetStatement::getEqualSign() {
@@ -367,18 +457,25 @@ void LetStatement::accept(ASTVisitor &visitor) {
 	visitor.visit(*this);
 }
 
-Function::Function(
-      std::vector<std::pair<std::unique_ptr<Symbol>, std::unique_ptr<Symbol>>> parameters,
-      std::unique_ptr<Symbol> returnTypeAnnotation, std::unique_ptr<BlockExpression> body)
-    : parameters(std::move(parameters)),
-      returnTypeAnnotation(std::move(returnTypeAnnotation)), body(std::move(body)) {
+Function::Function(const Keyword &funKeyword,
+      ArenaVector<std::pair<Symbol *, Symbol *>> parameters,
+      Symbol *returnTypeAnnotation, BlockExpression *body)
+    : ASTComponent(ASTKind::Function), s(Slice::merge(funKeyword.s, body->getSlice())),
+      parameters(std::move(parameters)), returnTypeAnnotation(returnTypeAnnotation),
+      body(body) {
 }
 
-Function::Function(
-      std::vector<std::pair<std::unique_ptr<Symbol>, std::unique_ptr<Symbol>>> parameters,
-      std::unique_ptr<BlockExpression> body)
-    : parameters(std::move(parameters)), returnTypeAnnotation(nullptr),
-      body(std::move(body)) {
+Function::Function(ArenaVector<std::pair<Symbol *, Symbol *>> parameters,
+      Symbol *returnTypeAnnotation, BlockExpression *body)
+    : ASTComponent(ASTKind::Function), s("", SourceManager::NO_FILE),
+      parameters(std::move(parameters)), returnTypeAnnotation(returnTypeAnnotation),
+      body(body) {
+}
+
+Function::Function(ArenaVector<std::pair<Symbol *, Symbol *>> parameters,
+      BlockExpression *body)
+    : ASTComponent(ASTKind::Function), s("", SourceManager::NO_FILE),
+      parameters(std::move(parameters)), returnTypeAnnotation(nullptr), body(body) {
 }
 
 void Function::forEachParameter(
@@ -389,13 +486,21 @@ void Function::forEachParameter(
 }
 
 Symbol *Function::getReturnTypeAnnotation() {
-	return returnTypeAnnotation.get();
+	return returnTypeAnnotation;
 }
 
 BlockExpression &Function::getBody() {
 	return *body;
 }
 
+void Function::setBody(BlockExpression *body) {
+	this->body = body;
+}
+
+Slice &Function::getSlice() {
+	return s;
+}
+
 int Function::getTypeID() const {
 	return typeID;
 }
@@ -412,7 +517,13 @@ Type::Type(int id, int parentID, std::string_view name)
     : id(id), parentID(parentID), name(name) {
 }
 
-Module::Module(std::filesystem::path source) : source(std::move(source)) {
+namespace {
+// Returned when a Type is looked up which does not exist
+const Type NO_TYPE(-1, -1, "");
+} // namespace
+
+Module::Module(FileID source, std::shared_ptr<Interner> interner)
+    : ASTComponent(ASTKind::Module), interner(std::move(interner)), source(source) {
 	insertType("()");
 	insertType("!");
 	insertType("i8");
@@ -428,121 +539,175 @@ Module::Module(std::filesystem::path source) : source(std::move(source)) {
 }
 
 Module::Module(const Module &module)
-    : typeTableByName(module.typeTableByName), typeTableByID(module.typeTableByID),
-      unaryOperators(module.unaryOperators), binaryOperators(module.binaryOperators),
+    : ASTComponent(ASTKind::Module), interner(module.interner),
+      typeIDsByName(module.typeIDsByName), types(module.types),
+      commonAncestors(module.commonAncestors), unaryOperators(module.unaryOperators),
+      binaryOperators(module.binaryOperators), operatorStride(module.operatorStride),
       source(module.source) {
 }
 
-void Module::addFunction(std::unique_ptr<Symbol> name, std::unique_ptr<Function> function,
-      bool isBuiltin) {
-	functions[name->s.contents] = {std::move(function), isBuiltin};
+void Module::addFunction(const Symbol &name, Function *function, bool isBuiltin) {
+	if (name.id >= functions.size()) {
+		functions.resize(name.id + 1, {nullptr, false});
+	}
+	if (std::get<0>(functions[name.id]) == nullptr) {
+		functionNames.push_back(name.id);
+	}
+	functions[name.id] = {function, isBuiltin};
+}
+
+void Module::adoptArena(std::unique_ptr<Arena> other) {
+	adoptedArenas.push_back(std::move(other));
 }
 
 void Module::forEachFunction(
       const std::function<void(std::string_view, Function &, bool)> &functionHandler) {
-	for (auto &[name, function] : functions) {
-		functionHandler(name, *std::get<0>(function), std::get<1>(function));
+	for (SymbolID name : functionNames) {
+		auto &[function, isBuiltin] = functions[name];
+		functionHandler(interner->getName(name), *function, isBuiltin);
 	}
 }
 
-Type Module::getType(std::string_view typeName) {
-	if (typeTableByName.find(typeName) == typeTableByName.end()) {
-		return Type(-1, -1, "");
-	}
-	return typeTableByName.at(typeName);
+const Type &Module::getType(std::string_view typeName) {
+	return getTypeByName(interner->find(typeName));
+}
+
+const Type &Module::getType(const Symbol &typeName) {
+	return getTypeByName(typeName.id);
 }
 
-Type Module::getType(int id) {
-	if (typeTableByID.find(id) == typeTableByID.end()) {
-		return Type(-1, -1, "");
+const Type &Module::getType(int id) {
+	if (id < 0 || static_cast<size_t>(id) >= types.size()) {
+		return NO_TYPE;
 	}
-	return typeTableByID.at(id);
+	return types[id];
 }
 
-void Module::insertType(std::string_view typeName) {
-	if (typeTableByName.find(typeName) == typeTableByName.end()) {
-		typeTableByName.insert({typeName, Type(typeTableByName.size(), -1, typeName)});
-		typeTableByID.insert(
-		      {typeTableByID.size(), Type(typeTableByID.size(), -1, typeName)});
-	} else {
+void Module::insertType(std::string_view typeName, int parentID) {
+	SymbolID name = interner->intern(typeName);
+	if (name >= typeIDsByName.size()) {
+		typeIDsByName.resize(name + 1, -1);
+	}
+	if (typeIDsByName[name] != -1) {
 		std::cerr << "Type already exists";
 		exit(EXIT_FAILURE);
 	}
+	int id = static_cast<int>(types.size());
+	typeIDsByName[name] = id;
+	types.emplace_back(id, parentID, interner->getName(name));
+	// Every earlier Type is either an ancestor of the new one or unrelated to it, so its
+	// common ancestor with the new one is the same as with the new one's parent
+	for (int other = 0; other < id; other++) {
+		int ancestor = -1;
+		if (id == Type::NEVER) {
+			ancestor = other;
+		} else if (other == Type::NEVER) {
+			ancestor = id;
+		} else if (parentID != -1) {
+			ancestor = commonAncestors[commonAncestorIndex(parentID, other)];
+		}
+		commonAncestors.push_back(ancestor);
+	}
+	commonAncestors.push_back(id);
 }
 
 bool Module::isTypeConvertible(int from, int to) {
 	if (from == to) {
 		return true;
 	}
-	if (from == getType("!").id) {
-		return true;
-	}
-	return false;
+	return to != -1 && getCommonTypeAncestor(from, to).id == to;
 }
 
-Type Module::getCommonTypeAncestor(int type1, int type2) {
-	if (type1 == type2) {
-		return getType(type1);
-	}
-	if (type1 == getType("!").id) {
-		return getType(type2);
+const Type &Module::getCommonTypeAncestor(int type1, int type2) {
+	int count = static_cast<int>(types.size());
+	if (type1 < 0 || type2 < 0 || type1 >= count || type2 >= count) {
+		return NO_TYPE;
 	}
-	if (type2 == getType("!").id) {
-		return getType(type1);
-	}
-	return Type(-1, -1, "");
+	return getType(commonAncestors[commonAncestorIndex(type1, type2)]);
 }
 
 void Module::addUnaryOperator(Operator::Type op, int operandType, int resultType) {
-	if (unaryOperators.find(op) == unaryOperators.end()) {
-		unaryOperators[op] = {};
+	if (static_cast<size_t>(operandType) >= operatorStride) {
+		widenOperators();
 	}
-	unaryOperators[op].push_back({operandType, resultType});
+	unaryOperators[static_cast<size_t>(op) * operatorStride + operandType] = resultType;
 }
 
 int Module::getUnaryOperator(Operator::Type op, int operandType) {
-	if (unaryOperators.find(op) == unaryOperators.end()) {
+	if (operandType < 0 || static_cast<size_t>(operandType) >= operatorStride) {
 		return -1;
 	}
-	for (auto &[operand, result] : unaryOperators[op]) {
-		if (operand == operandType) {
-			return result;
-		}
-	}
-	return -1;
+	return unaryOperators[static_cast<size_t>(op) * operatorStride + operandType];
 }
 
 void Module::addBinaryOperator(Operator::Type op, int leftType, int rightType,
       int resultType) {
-	if (binaryOperators.find(op) == binaryOperators.end()) {
-		binaryOperators[op] = {};
+	if (static_cast<size_t>(std::max(leftType, rightType)) >= operatorStride) {
+		widenOperators();
 	}
-	binaryOperators[op].push_back({leftType, rightType, resultType});
+	size_t row = static_cast<size_t>(op) * operatorStride + leftType;
+	binaryOperators[row * operatorStride + rightType] = resultType;
 }
 
 int Module::getBinaryOperator(Operator::Type op, int leftType, int rightType) {
-	if (binaryOperators.find(op) == binaryOperators.end()) {
+	if (leftType < 0 || rightType < 0
+	      || static_cast<size_t>(std::max(leftType, rightType)) >= operatorStride) {
 		return -1;
 	}
-	for (auto &[left, right, result] : binaryOperators[op]) {
-		if (left == leftType && right == rightType) {
-			return result;
+	size_t row = static_cast<size_t>(op) * operatorStride + leftType;
+	return binaryOperators[row * operatorStride + rightType];
+}
+
+void Module::widenOperators() {
+	const size_t stride = types.size();
+	std::vector<int> unary(Operator::TYPE_COUNT * stride, -1);
+	std::vector<int> binary(Operator::TYPE_COUNT * stride * stride, -1);
+	for (size_t op = 0; op < Operator::TYPE_COUNT; op++) {
+		for (size_t left = 0; left < operatorStride; left++) {
+			size_t oldRow = op * operatorStride + left;
+			size_t newRow = op * stride + left;
+			unary[newRow] = unaryOperators[oldRow];
+			std::copy_n(binaryOperators.begin() + oldRow * operatorStride,
+			      operatorStride, binary.begin() + newRow * stride);
 		}
 	}
-	return -1;
+	unaryOperators = std::move(unary);
+	binaryOperators = std::move(binary);
+	operatorStride = stride;
+}
+
+const Type &Module::getTypeByName(SymbolID name) {
+	if (name >= typeIDsByName.size()) {
+		return NO_TYPE;
+	}
+	return getType(typeIDsByName[name]);
 }
 
-Function *Module::getFunction(std::string_view name) {
-	if (functions.find(name) == functions.end()) {
+size_t Module::commonAncestorIndex(int type1, int type2) {
+	auto row = static_cast<size_t>(std::max(type1, type2));
+	auto column = static_cast<size_t>(std::min(type1, type2));
+	return row * (row + 1) / 2 + column;
+}
+
+Function *Module::getFunction(SymbolID name) {
+	if (name >= functions.size()) {
 		return nullptr;
 	}
-	return std::get<0>(functions[name]).get();
+	return std::get<0>(functions[name]);
 }
 
-std::filesystem::path Module::getSource() {
+FileID Module::getSource() {
 	return source;
 }
 
+Interner &Module::getInterner() {
+	return *interner;
+}
+
+Arena &Module::getArena() {
+	return arena;
+}
+
 void Module::accept(ASTVisitor &visitor) {
 	visitor.visit(*this);
 }
@@ -554,13 +719,18 @@ void ASTPrinter::visit(FunctionCallExpression &node) {
 }
 
 void ASTPrinter::visit(BinaryExpression &node) {
-	std::cerr << '(';
-	node.getOperator().print(std::cerr);
-	std::cerr << ' ';
-	node.getLeft().accept(*this);
-	std::cerr << ' ';
-	node.getRight().accept(*this);
-	std::cerr << ')';
+	std::vector<BinaryExpression *> chain = node.getLeftChain();
+	for (BinaryExpression *link : chain) {
+		std::cerr << '(';
+		link->getOperator().print(std::cerr);
+		std::cerr << ' ';
+	}
+	chain.back()->getLeft().accept(*this);
+	for (auto it = chain.rbegin(); it != chain.rend(); it++) {
+		std::cerr << ' ';
+		(*it)->getRight().accept(*this);
+		std::cerr << ')';
+	}
 }
 
 void ASTPrinter::visit(UnaryExpression &node) {
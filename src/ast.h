@@ -1,21 +1,60 @@
 #ifndef AST_H
 #define AST_H
 
+#include "arena.h"
+#include "interner.h"
+#include "sourcemanager.h"
 #include "tokens.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
-#include <list>
 #include <memory>
+#include <memory_resource>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
 
-/// Classes representing the parsed Abstract Syntax Tree (AST) of Canyon source code
+/// Classes representing the parsed Abstract Syntax Tree (AST) of Canyon source code. The
+/// nodes are allocated from the Arena of the Module they belong to and refer to each
+/// other with plain pointers, so they are never destroyed individually
 
 class ASTVisitor;
 
+/**
+ * @brief Identifies the class of each node of the AST. The Expressions and the Statements
+ * are each listed contiguously so that either group can be checked with a range
+ *
+ */
+enum class ASTKind : uint8_t {
+	FunctionCallExpression,
+	BinaryExpression,
+	UnaryExpression,
+	IntegerLiteralExpression,
+	BoolLiteralExpression,
+	CharacterLiteralExpression,
+	SymbolExpression,
+	BlockExpression,
+	ReturnExpression,
+	ParenthesizedExpression,
+	IfElseExpression,
+	WhileExpression,
+	ExpressionStatement,
+	LetStatement,
+	Function,
+	Module,
+};
+
 class ASTComponent {
+	// The class this node is an instance of, which isa<>, cast<> and dyn_cast<> check
+	ASTKind kind;
+protected:
+	explicit ASTComponent(ASTKind kind);
 public:
+	ASTKind getKind() const {
+		return kind;
+	}
+
 	virtual void accept(ASTVisitor &visitor) = 0;
 	virtual ~ASTComponent() = default;
 };
@@ -24,257 +63,382 @@ class Expression : public ASTComponent {
 protected:
 	Slice s;
 	int typeID = -1;
-	Expression(const Slice &s);
+	Expression(ASTKind kind, const Slice &s);
 public:
 	int getTypeID() const;
 	void setTypeID(int typeID);
 	Slice &getSlice();
 	virtual void accept(ASTVisitor &visitor) = 0;
 	virtual ~Expression() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() >= ASTKind::FunctionCallExpression
+		       && component->getKind() <= ASTKind::WhileExpression;
+	}
 };
 
 class Statement : public ASTComponent {
 protected:
 	Slice s;
-	Statement(const Slice &s);
+	Statement(ASTKind kind, const Slice &s);
 public:
 	Slice &getSlice();
 	virtual void accept(ASTVisitor &visitor) = 0;
 	virtual ~Statement() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() >= ASTKind::ExpressionStatement
+		       && component->getKind() <= ASTKind::LetStatement;
+	}
 };
 
 class FunctionCallExpression : public Expression {
-	std::unique_ptr<Expression> function;
-	std::vector<std::unique_ptr<Expression>> arguments;
+	Expression *function;
+	ArenaVector<Expression *> arguments;
 public:
-	FunctionCallExpression(std::unique_ptr<Expression> function, const Punctuation &open,
-	      std::vector<std::unique_ptr<Expression>> arguments, const Punctuation &close);
-	FunctionCallExpression(std::unique_ptr<Expression> function,
-	      std::vector<std::unique_ptr<Expression>> arguments);
+	FunctionCallExpression(Expression *function, const Punctuation &open,
+	      ArenaVector<Expression *> arguments, const Punctuation &close);
+	FunctionCallExpression(Expression *function, ArenaVector<Expression *> arguments);
 	Expression &getFunction();
 	void forEachArgument(const std::function<void(Expression &)> &argumentHandler);
+	void setArgument(size_t index, Expression *argument);
 	void accept(ASTVisitor &visitor) override;
 	virtual ~FunctionCallExpression() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::FunctionCallExpression;
+	}
 };
 
 class BinaryExpression : public Expression {
 private:
-	std::unique_ptr<Operator> op;
-	std::unique_ptr<Expression> left;
-	std::unique_ptr<Expression> right;
+	Operator *op;
+	Expression *left;
+	Expression *right;
 public:
-	BinaryExpression(std::unique_ptr<Operator> op, std::unique_ptr<Expression> left,
-	      std::unique_ptr<Expression> right);
+	BinaryExpression(Operator *op, Expression *left, Expression *right);
 	Expression &getLeft();
 	Expression &getRight();
+	void setLeft(Expression *left);
+	void setRight(Expression *right);
 	Operator &getOperator();
+	/**
+	 * @brief Collects this BinaryExpression and each one nested directly down its left
+	 * side, as a long chain of left-associative operators nests. Passes over the AST loop
+	 * over the chain rather than recursing down it, so its length is not bounded by the
+	 * native stack
+	 *
+	 * @return the chain, outermost first
+	 */
+	std::vector<BinaryExpression *> getLeftChain();
 	void accept(ASTVisitor &visitor) override;
 	virtual ~BinaryExpression() = default;
 	friend class ASTVisitor;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::BinaryExpression;
+	}
 };
 
 class UnaryExpression : public Expression {
 private:
-	std::unique_ptr<Operator> op;
-	std::unique_ptr<Expression> operand;
+	Operator *op;
+	Expression *operand;
 public:
-	UnaryExpression(std::unique_ptr<Operator> op, std::unique_ptr<Expression> operand);
+	UnaryExpression(Operator *op, Expression *operand);
 	void accept(ASTVisitor &visitor) override;
 	Expression &getExpression();
+	void setExpression(Expression *operand);
 	Operator &getOperator();
 	virtual ~UnaryExpression() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::UnaryExpression;
+	}
 };
 
 class IntegerLiteralExpression : public Expression {
 private:
-	std::unique_ptr<IntegerLiteral> literal;
+	IntegerLiteral *literal;
 public:
-	IntegerLiteralExpression(std::unique_ptr<IntegerLiteral> literal);
+	IntegerLiteralExpression(IntegerLiteral *literal);
 	IntegerLiteral &getLiteral();
 	void accept(ASTVisitor &visitor) override;
 	virtual ~IntegerLiteralExpression() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::IntegerLiteralExpression;
+	}
 };
 
 class BoolLiteralExpression : public Expression {
 private:
-	std::unique_ptr<BoolLiteral> literal;
+	BoolLiteral *literal;
 public:
-	BoolLiteralExpression(std::unique_ptr<BoolLiteral> literal);
+	BoolLiteralExpression(BoolLiteral *literal);
 	BoolLiteral &getLiteral();
 	void accept(ASTVisitor &visitor) override;
 	virtual ~BoolLiteralExpression() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::BoolLiteralExpression;
+	}
 };
 
 class CharacterLiteralExpression : public Expression {
 private:
-	std::unique_ptr<CharacterLiteral> literal;
+	CharacterLiteral *literal;
 public:
-	CharacterLiteralExpression(std::unique_ptr<CharacterLiteral> literal);
+	CharacterLiteralExpression(CharacterLiteral *literal);
 	CharacterLiteral &getLiteral();
 	void accept(ASTVisitor &visitor) override;
 	virtual ~CharacterLiteralExpression() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::CharacterLiteralExpression;
+	}
+};
+
+enum class SymbolSource {
+	Unknown,
+	LetStatement,
+	FunctionParameter,
+};
+
+/**
+ * @brief The declaration which a name refers to where it is used
+ *
+ */
+struct Binding {
+	int typeID = -1;
+	SymbolSource source = SymbolSource::Unknown;
 };
 
 class SymbolExpression : public Expression {
 private:
-	std::unique_ptr<Symbol> symbol;
+	Symbol *symbol;
+	// Resolved once by the SemanticAnalyzer so that later passes need not search scopes
+	Binding binding;
 public:
-	SymbolExpression(std::unique_ptr<Symbol> symbol);
+	SymbolExpression(Symbol *symbol);
 	Symbol &getSymbol();
+	const Binding &getBinding() const;
+	void setBinding(const Binding &binding);
 	void accept(ASTVisitor &visitor) override;
 	virtual ~SymbolExpression() = default;
-};
 
-enum class SymbolSource {
-	Unknown,
-	LetStatement,
-	FunctionParameter,
-	GENERATED_Block,
-	GENERATED_IfElse,
-	GENERATED_While,
-	GENERATED_Argument,
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::SymbolExpression;
+	}
 };
 
 class BlockExpression : public Expression {
 private:
-	std::vector<std::unique_ptr<Statement>> statements;
-	std::unique_ptr<Expression> finalExpression;
-	std::unordered_map<std::string_view, std::tuple<int, SymbolSource>> symbols;
+	ArenaVector<Statement *> statements;
+	Expression *finalExpression;
+	// Names in scope from the start of the block, such as the parameters of a function,
+	// rather than those declared by its LetStatements
+	std::pmr::unordered_map<SymbolID, std::tuple<int, SymbolSource>> symbols;
 public:
-	BlockExpression(const Punctuation &open,
-	      std::vector<std::unique_ptr<Statement>> statements,
-	      std::unique_ptr<Expression> finalExpression, const Punctuation &close);
-	BlockExpression();
+	BlockExpression(const Punctuation &open, ArenaVector<Statement *> statements,
+	      Expression *finalExpression, const Punctuation &close);
+	/**
+	 * @brief Construct a new, empty BlockExpression whose statements and symbols are
+	 * allocated from an Arena
+	 */
+	explicit BlockExpression(Arena &arena);
 	void forEachStatement(const std::function<void(Statement &)> &statementHandler);
+	/**
+	 * @brief Removes every statement from the block, so that a pass can push them back
+	 * rewritten or with new statements spliced between them
+	 *
+	 * @return the statements, in order
+	 */
+	ArenaVector<Statement *> takeStatements();
 	Expression *getFinalExpression();
-	int getSymbolType(std::string_view symbol);
-	SymbolSource getSymbolSource(std::string_view symbol);
-	void pushSymbol(std::string_view symbol, int typeID, SymbolSource source);
+	void setFinalExpression(Expression *finalExpression);
+	int getSymbolType(SymbolID symbol);
+	void pushSymbol(SymbolID symbol, int typeID, SymbolSource source);
 	void forEachSymbol(
-	      const std::function<void(std::string_view, int, SymbolSource)> &symbolHandler);
-	void pushStatement(std::unique_ptr<Statement> statement);
+	      const std::function<void(SymbolID, int, SymbolSource)> &symbolHandler);
+	void pushStatement(Statement *statement);
 	void accept(ASTVisitor &visitor) override;
 	virtual ~BlockExpression() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::BlockExpression;
+	}
 };
 
 class ReturnExpression : public Expression {
-	std::unique_ptr<Expression> expression;
+	Expression *expression;
 public:
-	ReturnExpression(const Keyword &returnKeyword,
-	      std::unique_ptr<Expression> expression);
-	ReturnExpression(std::unique_ptr<Expression> expression);
+	ReturnExpression(const Keyword &returnKeyword, Expression *expression);
+	ReturnExpression(Expression *expression);
 	Expression *getExpression();
+	void setExpression(Expression *expression);
 	void accept(ASTVisitor &visitor) override;
 	virtual ~ReturnExpression() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::ReturnExpression;
+	}
 };
 
 class ParenthesizedExpression : public Expression {
 private:
-	std::unique_ptr<Expression> expression;
+	Expression *expression;
 public:
-	ParenthesizedExpression(const Punctuation &open,
-	      std::unique_ptr<Expression> expression, const Punctuation &close);
-	explicit ParenthesizedExpression(std::unique_ptr<Expression> expression);
+	ParenthesizedExpression(const Punctuation &open, Expression *expression,
+	      const Punctuation &close);
+	explicit ParenthesizedExpression(Expression *expression);
 	Expression &getExpression();
+	void setExpression(Expression *expression);
 	void accept(ASTVisitor &visitor) override;
 	virtual ~ParenthesizedExpression() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::ParenthesizedExpression;
+	}
 };
 
 class IfElseExpression : public Expression {
 private:
-	std::unique_ptr<Expression> condition;
-	std::unique_ptr<BlockExpression> thenBlock;
-	std::unique_ptr<Expression> elseExpression;
+	Expression *condition;
+	BlockExpression *thenBlock;
+	Expression *elseExpression;
 public:
-	IfElseExpression(const Keyword &ifKeyword, std::unique_ptr<Expression> condition,
-	      std::unique_ptr<BlockExpression> thenBlock, const Keyword &elseKeyword,
-	      std::unique_ptr<Expression> elseExpression);
-	IfElseExpression(const Keyword &ifKeyword, std::unique_ptr<Expression> condition,
-	      std::unique_ptr<BlockExpression> thenBlock);
-	IfElseExpression(std::unique_ptr<Expression> condition,
-	      std::unique_ptr<BlockExpression> thenBlock,
-	      std::unique_ptr<Expression> elseExpression);
+	IfElseExpression(const Keyword &ifKeyword, Expression *condition,
+	      BlockExpression *thenBlock, const Keyword &elseKeyword,
+	      Expression *elseExpression);
+	IfElseExpression(const Keyword &ifKeyword, Expression *condition,
+	      BlockExpression *thenBlock);
+	IfElseExpression(Expression *condition, BlockExpression *thenBlock,
+	      Expression *elseExpression);
 	Expression &getCondition();
 	BlockExpression &getThenBlock();
 	Expression *getElseExpression();
+	void setCondition(Expression *condition);
+	void setThenBlock(BlockExpression *thenBlock);
+	void setElseExpression(Expression *elseExpression);
 	void accept(ASTVisitor &visitor) override;
 	virtual ~IfElseExpression() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::IfElseExpression;
+	}
 };
 
 class WhileExpression : public Expression {
 private:
-	std::unique_ptr<Expression> condition;
-	std::unique_ptr<BlockExpression> body;
+	Expression *condition;
+	BlockExpression *body;
 public:
-	WhileExpression(const Keyword &whileKeyword, std::unique_ptr<Expression> condition,
-	      std::unique_ptr<BlockExpression> body);
-	WhileExpression(std::unique_ptr<Expression> condition,
-	      std::unique_ptr<BlockExpression> body);
+	WhileExpression(const Keyword &whileKeyword, Expression *condition,
+	      BlockExpression *body);
+	WhileExpression(Expression *condition, BlockExpression *body);
 	Expression &getCondition();
 	BlockExpression &getBody();
+	void setCondition(Expression *condition);
+	void setBody(BlockExpression *body);
 	void accept(ASTVisitor &visitor) override;
 	virtual ~WhileExpression() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::WhileExpression;
+	}
 };
 
 class ExpressionStatement : public Statement {
 private:
-	std::unique_ptr<Expression> expression;
+	Expression *expression;
 public:
-	ExpressionStatement(std::unique_ptr<Expression> expression,
-	      const Punctuation &semicolon);
-	ExpressionStatement(std::unique_ptr<Expression> expression);
+	ExpressionStatement(Expression *expression, const Punctuation &semicolon);
+	ExpressionStatement(Expression *expression);
 	Expression &getExpression();
+	void setExpression(Expression *expression);
 	void accept(ASTVisitor &visitor) override;
 	virtual ~ExpressionStatement() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::ExpressionStatement;
+	}
 };
 
 class LetStatement : public Statement {
 private:
-	std::unique_ptr<Symbol> symbol;
-	std::unique_ptr<Symbol> typeAnnotation;
-	std::unique_ptr<Operator> equalSign;
-	std::unique_ptr<Expression> expression;
+	Symbol *symbol;
+	Symbol *typeAnnotation;
+	Operator *equalSign;
+	Expression *expression;
 	int symbolTypeID = -1;
 public:
-	LetStatement(const Keyword &let, std::unique_ptr<Symbol> symbol,
-	      std::unique_ptr<Symbol> typeAnnotation, std::unique_ptr<Operator> equalSign,
-	      std::unique_ptr<Expression> expression, Punctuation *semicolon);
-	LetStatement(std::unique_ptr<Symbol> symbol, std::unique_ptr<Expression> expression);
+	LetStatement(const Keyword &let, Symbol *symbol, Symbol *typeAnnotation,
+	      Operator *equalSign, Expression *expression, Punctuation *semicolon);
+	LetStatement(Symbol *symbol, Expression *expression);
 	Symbol &getSymbol();
 	Expression *getExpression();
+	void setExpression(Expression *expression);
 	Symbol *getTypeAnnotation();
 	Operator &getEqualSign();
 	void setSymbolTypeID(int typeID);
 	int getSymbolTypeID() const;
 	void accept(ASTVisitor &visitor) override;
 	virtual ~LetStatement() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::LetStatement;
+	}
 };
 
 class Function : public ASTComponent {
 private:
-	std::vector<std::pair<std::unique_ptr<Symbol>, std::unique_ptr<Symbol>>> parameters;
-	std::unique_ptr<Symbol> returnTypeAnnotation;
-	std::unique_ptr<BlockExpression> body;
+	// From `fun` through the end of the body, or empty for a builtin
+	Slice s;
+	ArenaVector<std::pair<Symbol *, Symbol *>> parameters;
+	Symbol *returnTypeAnnotation;
+	BlockExpression *body;
 	int typeID = -1;
 public:
-	Function(std::vector<std::pair<std::unique_ptr<Symbol>, std::unique_ptr<Symbol>>>
-	               parameters,
-	      std::unique_ptr<Symbol> returnTypeAnnotation,
-	      std::unique_ptr<BlockExpression> body);
-	Function(std::vector<std::pair<std::unique_ptr<Symbol>, std::unique_ptr<Symbol>>>
-	               parameters,
-	      std::unique_ptr<BlockExpression> body);
+	Function(const Keyword &funKeyword,
+	      ArenaVector<std::pair<Symbol *, Symbol *>> parameters,
+	      Symbol *returnTypeAnnotation, BlockExpression *body);
+	Function(ArenaVector<std::pair<Symbol *, Symbol *>> parameters,
+	      Symbol *returnTypeAnnotation, BlockExpression *body);
+	Function(ArenaVector<std::pair<Symbol *, Symbol *>> parameters,
+	      BlockExpression *body);
 	void forEachParameter(
 	      const std::function<void(Symbol &, Symbol &)> &parameterHandler);
 	Symbol *getReturnTypeAnnotation();
 	BlockExpression &getBody();
+	void setBody(BlockExpression *body);
+	Slice &getSlice();
 	int getTypeID() const;
 	void setTypeID(int typeID);
 	void accept(ASTVisitor &visitor);
 	~Function() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::Function;
+	}
 };
 
 struct Type {
+	// The IDs of the builtin Types, which every Module inserts first and in this order.
+	// The integer Types are in the same order as IntegerLiteral::Type
+	static constexpr int UNIT = 0;
+	static constexpr int NEVER = 1;
+	static constexpr int I8 = 2;
+	static constexpr int I16 = 3;
+	static constexpr int I32 = 4;
+	static constexpr int I64 = 5;
+	static constexpr int U8 = 6;
+	static constexpr int U16 = 7;
+	static constexpr int U32 = 8;
+	static constexpr int U64 = 9;
+	static constexpr int BOOL = 10;
+	static constexpr int CHAR = 11;
+
 	int id;
 	int parentID;
 	std::string_view name;
@@ -284,36 +448,101 @@ struct Type {
 
 class Module : public ASTComponent {
 private:
-	std::unordered_map<std::string_view, std::tuple<std::unique_ptr<Function>, bool>>
-	      functions;
-	std::unordered_map<std::string_view, Type> typeTableByName;
-	std::unordered_map<int, Type> typeTableByID;
-	std::unordered_map<Operator::Type, std::vector<std::tuple<int, int>>> unaryOperators;
-	std::unordered_map<Operator::Type, std::vector<std::tuple<int, int, int>>>
-	      binaryOperators;
-	std::filesystem::path source;
+	// Every Function, BlockExpression, Statement, and Token of the AST is allocated here,
+	// and declared first so that it outlives everything which refers into it
+	Arena arena;
+	// Arenas in which other threads allocated parts of the AST, kept for as long as arena
+	std::vector<std::unique_ptr<Arena>> adoptedArenas;
+	// Shared with the TokenBuffer the Module was parsed from and with any Module copied
+	// from it, so that a SymbolID means the same identifier in each
+	std::shared_ptr<Interner> interner;
+	// Indexed by the SymbolID of each Function's name, with nullptr for other SymbolIDs
+	std::vector<std::tuple<Function *, bool>> functions;
+	// The names of the Functions, in the order they were added, which is the order they
+	// are emitted in. Keeping it independent of hashing keeps the generated C the same
+	// byte for byte from one build of the compiler to the next
+	std::vector<SymbolID> functionNames;
+	// Indexed by the SymbolID of each Type's name, with -1 for other SymbolIDs
+	std::vector<int> typeIDsByName;
+	// Indexed by Type ID
+	std::vector<Type> types;
+	// The lower triangle of a matrix of the nearest common ancestor of each pair of
+	// Types, or -1 if they have none, which is filled in as each Type is inserted
+	std::vector<int> commonAncestors;
+	// The result Type of each operator, or -1 where it is not defined, indexed by the
+	// Operator::Type and then by the ID of each operand's Type. The operand dimensions
+	// are operatorStride wide, and are widened when an operator is added for a newer Type
+	std::vector<int> unaryOperators;
+	std::vector<int> binaryOperators;
+	size_t operatorStride = 0;
+	FileID source;
+
+	/**
+	 * @brief Looks up a Type by the SymbolID of its name, which is NO_SYMBOL if the name
+	 * was never interned
+	 */
+	const Type &getTypeByName(SymbolID name);
+	/**
+	 * @brief Gets where the common ancestor of two Types is stored in commonAncestors
+	 */
+	static size_t commonAncestorIndex(int type1, int type2);
+	/**
+	 * @brief Widens the operator tables to cover every Type inserted so far, keeping the
+	 * operators already added
+	 */
+	void widenOperators();
 public:
-	std::list<std::string> ownedStrings;
-	explicit Module(std::filesystem::path source);
+	Module(FileID source, std::shared_ptr<Interner> interner);
 	explicit Module(const Module &module);
-	void addFunction(std::unique_ptr<Symbol> name, std::unique_ptr<Function> function,
-	      bool isBuiltin = false);
+	void addFunction(const Symbol &name, Function *function, bool isBuiltin = false);
+	/**
+	 * @brief Keeps an Arena alive for as long as the Module, so that nodes allocated in
+	 * it on another thread can become part of the AST
+	 */
+	void adoptArena(std::unique_ptr<Arena> other);
+	/**
+	 * @brief Visits each Function in the order it was first added. The Parser adds them
+	 * in source order and the SemanticAnalyzer then adds the builtins in order of name
+	 */
 	void forEachFunction(
 	      const std::function<void(std::string_view, Function &, bool)> &functionHandler);
-	Type getType(std::string_view typeName);
-	Type getType(int id);
-	void insertType(std::string_view typeName);
+	/**
+	 * @brief Looks up a Type, returning one whose ID is -1 if there is none
+	 */
+	const Type &getType(std::string_view typeName);
+	const Type &getType(const Symbol &typeName);
+	const Type &getType(int id);
+	/**
+	 * @brief Adds a Type, which is given the next ID
+	 *
+	 * @param typeName the name of the Type, which must not already be taken
+	 * @param parentID the ID of the Type it derives from, or -1 if none
+	 */
+	void insertType(std::string_view typeName, int parentID = -1);
+	/**
+	 * @brief Checks whether a value of one Type may be used where another is expected,
+	 * which it may if the expected Type is an ancestor of it or it is NEVER
+	 */
 	bool isTypeConvertible(int from, int to);
-	Type getCommonTypeAncestor(int type1, int type2);
+	const Type &getCommonTypeAncestor(int type1, int type2);
 	void addUnaryOperator(Operator::Type op, int operandType, int resultType);
 	int getUnaryOperator(Operator::Type op, int operandType);
 	void addBinaryOperator(Operator::Type op, int leftType, int rightType,
 	      int resultType);
 	int getBinaryOperator(Operator::Type op, int leftType, int rightType);
-	Function *getFunction(std::string_view name);
-	std::filesystem::path getSource();
+	Function *getFunction(SymbolID name);
+	FileID getSource();
+	Interner &getInterner();
+	/**
+	 * @brief Gets the Arena from which the nodes of this Module's AST are allocated
+	 */
+	Arena &getArena();
 	void accept(ASTVisitor &visitor);
 	~Module() = default;
+
+	static bool classof(const ASTComponent *component) {
+		return component->getKind() == ASTKind::Module;
+	}
 };
 
 class ASTVisitor {
@@ -0,0 +1,55 @@
+#include "builtinapi.h"
+
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+#include <array>
+#include <istream>
+#include <span>
+#include <string>
+
+namespace {
+#include "builtin_api_table.inc"
+} // namespace
+
+BuiltinApi::BuiltinApi() : functionTable(FUNCTIONS), parameterTable(PARAMETERS) {
+}
+
+BuiltinApi::BuiltinApi(std::istream &jsonFile) {
+	json data;
+	jsonFile >> data;
+
+	// Functions are iterated in order of name, as they are embedded
+	for (const auto &[name, function] : data.at("functions").items()) {
+		size_t firstParameter = readParameters.size();
+		for (const auto &parameter : function.at("parameters")) {
+			// A deque never moves its elements as it grows, so the views stay valid
+			const std::string &parameterName
+			      = readText.emplace_back(parameter.at("name").get<std::string>());
+			const std::string &parameterType
+			      = readText.emplace_back(parameter.at("type").get<std::string>());
+			readParameters.push_back({parameterName, parameterType});
+		}
+		const std::string &functionName = readText.emplace_back(name);
+		const std::string &returnType
+		      = readText.emplace_back(function.at("returnType").get<std::string>());
+		readFunctions.push_back({functionName, firstParameter,
+		      readParameters.size() - firstParameter, returnType});
+	}
+	functionTable = readFunctions;
+	parameterTable = readParameters;
+}
+
+const BuiltinApi &BuiltinApi::embedded() {
+	static const BuiltinApi api;
+	return api;
+}
+
+std::span<const BuiltinFunction> BuiltinApi::functions() const {
+	return functionTable;
+}
+
+std::span<const BuiltinParameter> BuiltinApi::parameters(
+      const BuiltinFunction &function) const {
+	return parameterTable.subspan(function.firstParameter, function.parameterCount);
+}
@@ -0,0 +1,64 @@
+#ifndef BUILTINAPI_H
+#define BUILTINAPI_H
+
+#include <cstddef>
+#include <deque>
+#include <istream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct BuiltinParameter {
+	std::string_view name;
+	std::string_view type;
+};
+
+struct BuiltinFunction {
+	std::string_view name;
+	// Where the parameters of the function are in BuiltinApi::parameters
+	size_t firstParameter;
+	size_t parameterCount;
+	std::string_view returnType;
+};
+
+/**
+ * @brief The functions which the Canyon runtime provides, generated at build time from
+ * resources/builtin_api.json by cmake/EmbedBuiltinApi.cmake or read from a JSON file in
+ * the same format. A BuiltinApi is never changed once made, so every Module being
+ * compiled at the same time can share one
+ *
+ */
+class BuiltinApi {
+	std::span<const BuiltinFunction> functionTable;
+	std::span<const BuiltinParameter> parameterTable;
+	// Hold the tables and the text they refer to for an API read from a file
+	std::vector<BuiltinFunction> readFunctions;
+	std::vector<BuiltinParameter> readParameters;
+	std::deque<std::string> readText;
+
+	BuiltinApi();
+public:
+	/**
+	 * @brief Reads the builtin API from a JSON file, for developing the runtime without
+	 * rebuilding. Throws a nlohmann::json::exception if the file is not JSON or lacks a
+	 * field
+	 */
+	explicit BuiltinApi(std::istream &jsonFile);
+	BuiltinApi(const BuiltinApi &) = delete;
+	BuiltinApi &operator=(const BuiltinApi &) = delete;
+	/**
+	 * @brief Gets the builtin API embedded at build time
+	 */
+	static const BuiltinApi &embedded();
+	/**
+	 * @brief Gets every builtin function, in order of name
+	 */
+	std::span<const BuiltinFunction> functions() const;
+	/**
+	 * @brief Gets the parameters of a builtin function, in order
+	 */
+	std::span<const BuiltinParameter> parameters(const BuiltinFunction &function) const;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef CASTING_H
+#define CASTING_H
+
+#include <cassert>
+#include <type_traits>
+
+/// Checked downcasts for class hierarchies which record the dynamic type of each object
+/// in a kind field instead of relying on RTTI. A class To takes part by providing
+///     static bool classof(const Base *object);
+/// which inspects the kind of an object of the base class that is being cast from
+
+/**
+ * @brief Checks whether an object is an instance of To
+ *
+ * @param object the object to check, which must not be null
+ * @return true if the object is a To, otherwise false
+ */
+template <typename To, typename From>
+bool isa(From *object) {
+	assert(object != nullptr && "isa<> used on a null pointer");
+	return To::classof(object);
+}
+
+template <typename To, typename From>
+bool isa(const From &object) {
+	return To::classof(&object);
+}
+
+/**
+ * @brief Casts an object to To, which it must be an instance of
+ *
+ * @param object the object to cast, which must not be null
+ * @return the object as a To, with the same constness as the parameter
+ */
+template <typename To, typename From>
+auto *cast(From *object) {
+	using Result = std::conditional_t<std::is_const_v<From>, const To, To>;
+	assert(isa<To>(object) && "cast<> to an incompatible type");
+	return static_cast<Result *>(object);
+}
+
+template <typename To, typename From>
+auto &cast(From &object) {
+	using Result = std::conditional_t<std::is_const_v<From>, const To, To>;
+	assert(isa<To>(object) && "cast<> to an incompatible type");
+	return static_cast<Result &>(object);
+}
+
+/**
+ * @brief Casts an object to To if it is an instance of To
+ *
+ * @param object the object to cast, which may be null
+ * @return the object as a To, or null if it is null or not a To
+ */
+template <typename To, typename From>
+auto *dyn_cast(From *object) {
+	using Result = std::conditional_t<std::is_const_v<From>, const To, To>;
+	return object != nullptr && To::classof(object) ? static_cast<Result *>(object)
+	                                                : nullptr;
+}
+
+#endif
@@ -1,16 +1,22 @@
 #include "ccodeadapter.h"
 
+#include "arena.h"
 #include "ast.h"
+#include "casting.h"
+#include "interner.h"
 
-#include <list>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
 #include <memory>
+#include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
-CCodeAdapter::CCodeAdapter(Module *module, std::list<std::string> *generatedStrings)
+CCodeAdapter::CCodeAdapter(Module *module)
     : inputModule(module), outputModule(std::make_unique<Module>(*inputModule)),
-      generatedStrings(generatedStrings) {
+      arena(&inputModule->getArena()), interner(&inputModule->getInterner()) {
 }
 
 std::unique_ptr<Module> CCodeAdapter::transform() {
@@ -19,471 +25,276 @@ std::unique_ptr<Module> CCodeAdapter::transform() {
 }
 
 void CCodeAdapter::visit(FunctionCallExpression &node) {
-	Expression &oldFunction = node.getFunction();
-	auto *oldSymbol = dynamic_cast<SymbolExpression *>(&oldFunction);
-	if (oldSymbol == nullptr) {
+	auto *function = dyn_cast<SymbolExpression>(&node.getFunction());
+	if (function == nullptr) {
 		std::cerr << "Function call target is not a symbol" << std::endl;
 		exit(EXIT_FAILURE);
 	}
-	generatedStrings->push_back(
-	      "CANYON_FUNCTION_" + std::string(oldSymbol->getSymbol().s.contents));
-	std::string_view newName = generatedStrings->back();
-	std::unique_ptr<Symbol> newSymbol
-	      = std::make_unique<Symbol>(Slice(newName, inputModule->getSource(), 0, 0));
-	std::unique_ptr<SymbolExpression> newSymbolExpression
-	      = std::make_unique<SymbolExpression>(std::move(newSymbol));
-
-	std::vector<std::unique_ptr<Expression>> newArguments;
-	node.forEachArgument([this, &newArguments](Expression &argument) {
-		generatedStrings->push_back("CANYON_ARGUMENT_" + std::to_string(blockCount++));
-		std::string_view tempVariableName = generatedStrings->back();
-		std::unique_ptr<Symbol> tempSymbol = std::make_unique<Symbol>(
-		      Slice(tempVariableName, inputModule->getSource(), 0, 0));
+	rename(function->getSymbol(), functionNames);
+
+	size_t index = 0;
+	node.forEachArgument([this, &node, &index](Expression &argument) {
+		Symbol *tempSymbol = makeTemporarySymbol("CANYON_ARGUMENT_");
 		visitExpression(argument);
-		std::unique_ptr<Expression> newArgument = std::unique_ptr<Expression>(
-		      dynamic_cast<Expression *>(returnValue.release()));
-		std::unique_ptr<LetStatement> newLetStatement = std::make_unique<LetStatement>(
-		      std::make_unique<Symbol>(*tempSymbol), std::move(newArgument));
-		scopeStack.back()->pushSymbol(tempVariableName, argument.getTypeID(),
-		      SymbolSource::GENERATED_Argument);
-		newLetStatement->setSymbolTypeID(argument.getTypeID());
-		scopeStack.back()->pushStatement(std::move(newLetStatement));
-		newArguments.push_back(std::make_unique<SymbolExpression>(std::move(tempSymbol)));
+		LetStatement *hoisted = arena->make<LetStatement>(
+		      arena->make<Symbol>(*tempSymbol), cast<Expression>(returnValue));
+		hoisted->setSymbolTypeID(argument.getTypeID());
+		scopeStack.back()->pushStatement(hoisted);
+		node.setArgument(index++, arena->make<SymbolExpression>(tempSymbol));
 	});
-
-	std::unique_ptr<FunctionCallExpression> newFunctionCall
-	      = std::make_unique<FunctionCallExpression>(std::move(newSymbolExpression),
-	            std::move(newArguments));
-	newFunctionCall->setTypeID(oldFunction.getTypeID());
-	returnValue = std::move(newFunctionCall);
+	returnValue = &node;
 }
 
 void CCodeAdapter::visit(BinaryExpression &node) {
-	Expression &oldLeft = node.getLeft();
-	Expression &oldRight = node.getRight();
-	Operator &oldOperator = node.getOperator();
-	visitExpression(oldLeft);
-	std::unique_ptr<Expression> newLeft = std::unique_ptr<Expression>(
-	      dynamic_cast<Expression *>(returnValue.release()));
-	visitExpression(oldRight);
-	std::unique_ptr<Expression> newRight = std::unique_ptr<Expression>(
-	      dynamic_cast<Expression *>(returnValue.release()));
-	std::unique_ptr<Operator> newOperator = std::make_unique<Operator>(oldOperator);
-	std::unique_ptr<BinaryExpression> newBinaryExpression
-	      = std::make_unique<BinaryExpression>(std::move(newOperator), std::move(newLeft),
-	            std::move(newRight));
-	newBinaryExpression->setTypeID(node.getTypeID());
-	returnValue = std::move(newBinaryExpression);
+	std::vector<BinaryExpression *> chain = node.getLeftChain();
+	visitExpression(chain.back()->getLeft());
+	chain.back()->setLeft(cast<Expression>(returnValue));
+	for (auto it = chain.rbegin(); it != chain.rend(); it++) {
+		visitExpression((*it)->getRight());
+		(*it)->setRight(cast<Expression>(returnValue));
+	}
+	returnValue = &node;
 }
 
 void CCodeAdapter::visit(UnaryExpression &node) {
-	Expression &oldExpression = node.getExpression();
-	Operator &oldOperator = node.getOperator();
-	visitExpression(oldExpression);
-	std::unique_ptr<Expression> newExpression = std::unique_ptr<Expression>(
-	      dynamic_cast<Expression *>(returnValue.release()));
-	std::unique_ptr<Operator> newOperator = std::make_unique<Operator>(oldOperator);
-	std::unique_ptr<UnaryExpression> newUnaryExpression
-	      = std::make_unique<UnaryExpression>(std::move(newOperator),
-	            std::move(newExpression));
-	newUnaryExpression->setTypeID(node.getTypeID());
-	returnValue = std::move(newUnaryExpression);
+	visitExpression(node.getExpression());
+	node.setExpression(cast<Expression>(returnValue));
+	returnValue = &node;
 }
 
 void CCodeAdapter::visit(IntegerLiteralExpression &node) {
-	IntegerLiteral &previousLiteral = node.getLiteral();
-	std::unique_ptr<IntegerLiteral> newLiteral = std::make_unique<IntegerLiteral>(
-	      previousLiteral, previousLiteral.type, previousLiteral.value);
-	std::unique_ptr<IntegerLiteralExpression> newLiteralExpression
-	      = std::make_unique<IntegerLiteralExpression>(std::move(newLiteral));
-	newLiteralExpression->setTypeID(node.getTypeID());
-	returnValue = std::move(newLiteralExpression);
+	returnValue = &node;
 }
 
 void CCodeAdapter::visit(BoolLiteralExpression &node) {
-	BoolLiteral &previousLiteral = node.getLiteral();
-	std::unique_ptr<BoolLiteral> newLiteral
-	      = std::make_unique<BoolLiteral>(previousLiteral, previousLiteral.value);
-	std::unique_ptr<BoolLiteralExpression> newLiteralExpression
-	      = std::make_unique<BoolLiteralExpression>(std::move(newLiteral));
-	newLiteralExpression->setTypeID(node.getTypeID());
-	returnValue = std::move(newLiteralExpression);
+	returnValue = &node;
 }
 
 void CCodeAdapter::visit(CharacterLiteralExpression &node) {
-	CharacterLiteral &previousLiteral = node.getLiteral();
-	std::unique_ptr<CharacterLiteral> newLiteral
-	      = std::make_unique<CharacterLiteral>(previousLiteral, previousLiteral.value);
-	std::unique_ptr<CharacterLiteralExpression> newLiteralExpression
-	      = std::make_unique<CharacterLiteralExpression>(std::move(newLiteral));
-	newLiteralExpression->setTypeID(node.getTypeID());
-	returnValue = std::move(newLiteralExpression);
+	returnValue = &node;
 }
 
 void CCodeAdapter::visit(SymbolExpression &node) {
-	Symbol &oldSymbol = node.getSymbol();
-	SymbolSource source = SymbolSource::Unknown;
-	for (auto it = scopeStack.rbegin(); it != scopeStack.rend(); it++) {
-		source = (*it)->getSymbolSource(oldSymbol.s.contents);
-		if (source != SymbolSource::Unknown) {
-			break;
-		}
-	}
-	if (source == SymbolSource::FunctionParameter) {
-		generatedStrings->push_back(
-		      "CANYON_PARAMETER_" + std::string(oldSymbol.s.contents));
+	if (node.getBinding().source == SymbolSource::FunctionParameter) {
+		rename(node.getSymbol(), parameterNames);
 	} else {
-		generatedStrings->push_back("CANYON_LOCAL_" + std::string(oldSymbol.s.contents));
+		rename(node.getSymbol(), localNames);
 	}
-	std::string_view newName = generatedStrings->back();
-	std::unique_ptr<Symbol> newSymbol
-	      = std::make_unique<Symbol>(Slice(newName, inputModule->getSource(), 0, 0));
-	std::unique_ptr<SymbolExpression> newSymbolExpression
-	      = std::make_unique<SymbolExpression>(std::move(newSymbol));
-	newSymbolExpression->setTypeID(node.getTypeID());
-	returnValue = std::move(newSymbolExpression);
+	returnValue = &node;
 }
 
 void CCodeAdapter::visit(BlockExpression &node) {
-	BlockExpression &oldBlock = node;
-	Expression *oldFinalExpression = oldBlock.getFinalExpression();
-	std::unique_ptr<BlockExpression> newBlockExpression
-	      = std::make_unique<BlockExpression>();
-	scopeStack.push_back(newBlockExpression.get());
-
-	oldBlock.forEachSymbol([&newBlockExpression](std::string_view symbol, int typeID,
-	                             SymbolSource source) {
-		newBlockExpression->pushSymbol(symbol, typeID, source);
-	});
-
-	oldBlock.forEachStatement([this, &newBlockExpression](Statement &statement) {
-		statement.accept(*this);
-		std::unique_ptr<Statement> newStatement = std::unique_ptr<Statement>(
-		      dynamic_cast<Statement *>(returnValue.release()));
-		newBlockExpression->pushStatement(std::move(newStatement));
-	});
+	Expression *finalExpression = node.getFinalExpression();
+	// Statements are pushed back as they are lowered, after whatever they hoisted
+	ArenaVector<Statement *> statements = node.takeStatements();
+	scopeStack.push_back(&node);
+
+	for (Statement *statement : statements) {
+		statement->accept(*this);
+		node.pushStatement(cast<Statement>(returnValue));
+	}
 
-	if (oldFinalExpression != nullptr) {
-		visitExpression(*oldFinalExpression);
-		std::unique_ptr<Expression> newFinalExpression = std::unique_ptr<Expression>(
-		      dynamic_cast<Expression *>(returnValue.release()));
-		if (node.getTypeID() != inputModule->getType("()").id
-		      && node.getTypeID() != inputModule->getType("!").id) {
-			std::string_view tempVariableName = blockTemporaryVariables.top();
-			Punctuation equalSign = Punctuation(
-			      Slice("=", inputModule->getSource(), 0, 0), Punctuation::Type::Equals);
-			std::unique_ptr<Operator> assignmentOperator
-			      = std::make_unique<Operator>(equalSign, Operator::Type::Assignment);
-			std::unique_ptr<BinaryExpression> assignment
-			      = std::make_unique<BinaryExpression>(std::move(assignmentOperator),
-			            std::make_unique<SymbolExpression>(std::make_unique<Symbol>(
-			                  Slice(tempVariableName, inputModule->getSource(), 0, 0))),
-			            std::move(newFinalExpression));
-			std::unique_ptr<ExpressionStatement> newAssignment
-			      = std::make_unique<ExpressionStatement>(std::move(assignment));
-			newBlockExpression->pushStatement(std::move(newAssignment));
+	if (finalExpression != nullptr) {
+		node.setFinalExpression(nullptr);
+		visitExpression(*finalExpression);
+		Expression *newFinalExpression = cast<Expression>(returnValue);
+		if (node.getTypeID() != Type::UNIT && node.getTypeID() != Type::NEVER) {
+			node.pushStatement(
+			      assignTemporary(*blockTemporaryVariables.top(), newFinalExpression));
 			blockTemporaryVariables.pop();
 		} else {
-			newBlockExpression->pushStatement(
-			      std::make_unique<ExpressionStatement>(std::move(newFinalExpression)));
+			node.pushStatement(arena->make<ExpressionStatement>(newFinalExpression));
 		}
 	}
-	newBlockExpression->setTypeID(oldBlock.getTypeID());
-	newBlockExpression->getSlice().source = oldBlock.getSlice().source;
 	scopeStack.pop_back();
-	returnValue = std::move(newBlockExpression);
+	returnValue = &node;
 }
 
 void CCodeAdapter::visit(ReturnExpression &node) {
-	Expression *oldExpression = node.getExpression();
-	std::unique_ptr<ReturnExpression> newReturnExpression = nullptr;
-	if (oldExpression != nullptr) {
-		visitExpression(*oldExpression);
-		std::unique_ptr<Expression> newExpression = std::unique_ptr<Expression>(
-		      dynamic_cast<Expression *>(returnValue.release()));
-		newReturnExpression
-		      = std::make_unique<ReturnExpression>(std::move(newExpression));
-	} else {
-		newReturnExpression = std::make_unique<ReturnExpression>(nullptr);
+	Expression *expression = node.getExpression();
+	if (expression != nullptr) {
+		visitExpression(*expression);
+		node.setExpression(cast<Expression>(returnValue));
 	}
-	newReturnExpression->setTypeID(node.getTypeID());
-	returnValue = std::move(newReturnExpression);
+	returnValue = &node;
 }
 
 void CCodeAdapter::visit(ParenthesizedExpression &node) {
-	Expression &oldExpression = node.getExpression();
-	visitExpression(oldExpression);
-	std::unique_ptr<Expression> newExpression = std::unique_ptr<Expression>(
-	      dynamic_cast<Expression *>(returnValue.release()));
-	std::unique_ptr<ParenthesizedExpression> newParenthesizedExpression
-	      = std::make_unique<ParenthesizedExpression>(std::move(newExpression));
-	newParenthesizedExpression->setTypeID(node.getTypeID());
-	returnValue = std::move(newParenthesizedExpression);
+	visitExpression(node.getExpression());
+	node.setExpression(cast<Expression>(returnValue));
+	returnValue = &node;
 }
 
 void CCodeAdapter::visit(IfElseExpression &node) {
-	if (node.getTypeID() != inputModule->getType("()").id
-	      && node.getTypeID() != inputModule->getType("!").id) {
-		generatedStrings->push_back("CANYON_IFELSE_" + std::to_string(blockCount++));
-		std::string_view tempVariableName = generatedStrings->back();
-		std::unique_ptr<LetStatement> declaration = std::make_unique<LetStatement>(
-		      std::make_unique<Symbol>(
-		            Slice(tempVariableName, inputModule->getSource(), 0, 0)),
-		      nullptr);
-		scopeStack.back()->pushSymbol(tempVariableName, node.getTypeID(),
-		      SymbolSource::GENERATED_IfElse);
-		declaration->setSymbolTypeID(node.getTypeID());
-		scopeStack.back()->pushStatement(std::move(declaration));
-		blockTemporaryVariables.push(tempVariableName);
-
-		Expression &oldCondition = node.getCondition();
-		oldCondition.accept(*this);
-		std::unique_ptr<Expression> newCondition = std::unique_ptr<Expression>(
-		      dynamic_cast<Expression *>(returnValue.release()));
-
-		Expression &oldThenExpression = node.getThenBlock();
-		std::unique_ptr<BlockExpression> newThenBlock
-		      = std::make_unique<BlockExpression>();
-		scopeStack.push_back(newThenBlock.get());
-		visitExpression(oldThenExpression);
+	if (node.getTypeID() != Type::UNIT && node.getTypeID() != Type::NEVER) {
+		Symbol *tempVariable = declareTemporary("CANYON_IFELSE_", node.getTypeID());
+		blockTemporaryVariables.push(tempVariable);
+
+		node.getCondition().accept(*this);
+		node.setCondition(cast<Expression>(returnValue));
+
+		BlockExpression *thenBlock = arena->make<BlockExpression>(*arena);
+		scopeStack.push_back(thenBlock);
+		visitExpression(node.getThenBlock());
 		scopeStack.pop_back();
-		std::unique_ptr<Expression> newFinalExpression = std::unique_ptr<Expression>(
-		      dynamic_cast<Expression *>(returnValue.release()));
-		Punctuation equalSign = Punctuation(Slice("=", inputModule->getSource(), 0, 0),
-		      Punctuation::Type::Equals);
-		std::unique_ptr<Operator> assignmentOperator
-		      = std::make_unique<Operator>(equalSign, Operator::Type::Assignment);
-		std::unique_ptr<BinaryExpression> assignment
-		      = std::make_unique<BinaryExpression>(std::move(assignmentOperator),
-		            std::make_unique<SymbolExpression>(std::make_unique<Symbol>(
-		                  Slice(tempVariableName, inputModule->getSource(), 0, 0))),
-		            std::move(newFinalExpression));
-		std::unique_ptr<ExpressionStatement> newAssignment
-		      = std::make_unique<ExpressionStatement>(std::move(assignment));
-		newThenBlock->pushStatement(std::move(newAssignment));
-
-		std::unique_ptr<IfElseExpression> newIfElseExpression;
-		Expression *oldElseExpression = node.getElseExpression();
-		if (oldElseExpression != nullptr) {
-			std::unique_ptr<BlockExpression> newElseBlock
-			      = std::make_unique<BlockExpression>();
-			scopeStack.push_back(newElseBlock.get());
-			visitExpression(*oldElseExpression);
+		thenBlock->pushStatement(
+		      assignTemporary(*tempVariable, cast<Expression>(returnValue)));
+		node.setThenBlock(thenBlock);
+
+		Expression *elseExpression = node.getElseExpression();
+		if (elseExpression != nullptr) {
+			BlockExpression *elseBlock = arena->make<BlockExpression>(*arena);
+			scopeStack.push_back(elseBlock);
+			visitExpression(*elseExpression);
 			scopeStack.pop_back();
-			std::unique_ptr<Expression> newFinalExpression = std::unique_ptr<Expression>(
-			      dynamic_cast<Expression *>(returnValue.release()));
-			Punctuation equalSign = Punctuation(
-			      Slice("=", inputModule->getSource(), 0, 0), Punctuation::Type::Equals);
-			std::unique_ptr<Operator> assignmentOperator
-			      = std::make_unique<Operator>(equalSign, Operator::Type::Assignment);
-			std::unique_ptr<BinaryExpression> assignment
-			      = std::make_unique<BinaryExpression>(std::move(assignmentOperator),
-			            std::make_unique<SymbolExpression>(std::make_unique<Symbol>(
-			                  Slice(tempVariableName, inputModule->getSource(), 0, 0))),
-			            std::move(newFinalExpression));
-			std::unique_ptr<ExpressionStatement> newAssignment
-			      = std::make_unique<ExpressionStatement>(std::move(assignment));
-			newElseBlock->pushStatement(std::move(newAssignment));
-			newIfElseExpression
-			      = std::make_unique<IfElseExpression>(std::move(newCondition),
-			            std::move(newThenBlock), std::move(newElseBlock));
-		} else {
-			newIfElseExpression = std::make_unique<IfElseExpression>(
-			      std::move(newCondition), std::move(newThenBlock), nullptr);
+			elseBlock->pushStatement(
+			      assignTemporary(*tempVariable, cast<Expression>(returnValue)));
+			node.setElseExpression(elseBlock);
 		}
 		blockTemporaryVariables.pop();
-		newIfElseExpression->setTypeID(node.getTypeID());
 
-		std::unique_ptr<ExpressionStatement> ifElseExpressionStatement
-		      = std::make_unique<ExpressionStatement>(std::move(newIfElseExpression));
-		scopeStack.back()->pushStatement(std::move(ifElseExpressionStatement));
-		returnValue = std::make_unique<SymbolExpression>(std::make_unique<Symbol>(
-		      Slice(tempVariableName, inputModule->getSource(), 0, 0)));
+		scopeStack.back()->pushStatement(arena->make<ExpressionStatement>(&node));
+		returnValue = arena->make<SymbolExpression>(arena->make<Symbol>(*tempVariable));
 	} else {
-		Expression &oldCondition = node.getCondition();
-		Expression &oldThenBlock = node.getThenBlock();
-		Expression *oldElseExpression = node.getElseExpression();
-		visitExpression(oldCondition);
-		std::unique_ptr<Expression> newCondition = std::unique_ptr<Expression>(
-		      dynamic_cast<Expression *>(returnValue.release()));
-		visitExpression(oldThenBlock);
-		std::unique_ptr<BlockExpression> newThenBlock = std::unique_ptr<BlockExpression>(
-		      dynamic_cast<BlockExpression *>(returnValue.release()));
-		std::unique_ptr<IfElseExpression> newIfElseExpression;
-		if (oldElseExpression != nullptr) {
-			visitExpression(*oldElseExpression);
-			std::unique_ptr<Expression> newElseExpression = std::unique_ptr<Expression>(
-			      dynamic_cast<Expression *>(returnValue.release()));
-			newIfElseExpression
-			      = std::make_unique<IfElseExpression>(std::move(newCondition),
-			            std::move(newThenBlock), std::move(newElseExpression));
-		} else {
-			newIfElseExpression = std::make_unique<IfElseExpression>(
-			      std::move(newCondition), std::move(newThenBlock), nullptr);
+		visitExpression(node.getCondition());
+		node.setCondition(cast<Expression>(returnValue));
+		visitExpression(node.getThenBlock());
+		node.setThenBlock(cast<BlockExpression>(returnValue));
+		Expression *elseExpression = node.getElseExpression();
+		if (elseExpression != nullptr) {
+			visitExpression(*elseExpression);
+			node.setElseExpression(cast<Expression>(returnValue));
 		}
-		newIfElseExpression->setTypeID(node.getTypeID());
-		returnValue = std::move(newIfElseExpression);
+		returnValue = &node;
 	}
 }
 
 void CCodeAdapter::visit(WhileExpression &node) {
-	if (node.getTypeID() != inputModule->getType("()").id
-	      && node.getTypeID() != inputModule->getType("!").id) {
-		generatedStrings->push_back("CANYON_WHILE_" + std::to_string(blockCount++));
-		std::string_view tempVariableName = generatedStrings->back();
-		std::unique_ptr<LetStatement> declaration = std::make_unique<LetStatement>(
-		      std::make_unique<Symbol>(
-		            Slice(tempVariableName, inputModule->getSource(), 0, 0)),
-		      nullptr);
-		scopeStack.back()->pushSymbol(tempVariableName, node.getTypeID(),
-		      SymbolSource::GENERATED_While);
-		declaration->setSymbolTypeID(node.getTypeID());
-		scopeStack.back()->pushStatement(std::move(declaration));
-		blockTemporaryVariables.push(tempVariableName);
-
-		Expression &oldCondition = node.getCondition();
-		oldCondition.accept(*this);
-		std::unique_ptr<Expression> newCondition = std::unique_ptr<Expression>(
-		      dynamic_cast<Expression *>(returnValue.release()));
-
-		Expression &oldBlock = node.getBody();
-		std::unique_ptr<BlockExpression> newBlock = std::make_unique<BlockExpression>();
-		scopeStack.push_back(newBlock.get());
-		visitExpression(oldBlock);
+	if (node.getTypeID() != Type::UNIT && node.getTypeID() != Type::NEVER) {
+		Symbol *tempVariable = declareTemporary("CANYON_WHILE_", node.getTypeID());
+		blockTemporaryVariables.push(tempVariable);
+
+		node.getCondition().accept(*this);
+		node.setCondition(cast<Expression>(returnValue));
+
+		BlockExpression *body = arena->make<BlockExpression>(*arena);
+		scopeStack.push_back(body);
+		visitExpression(node.getBody());
 		scopeStack.pop_back();
-		std::unique_ptr<Expression> newFinalExpression = std::unique_ptr<Expression>(
-		      dynamic_cast<Expression *>(returnValue.release()));
-		Punctuation equalSign = Punctuation(Slice("=", inputModule->getSource(), 0, 0),
-		      Punctuation::Type::Equals);
-		std::unique_ptr<Operator> assignmentOperator
-		      = std::make_unique<Operator>(equalSign, Operator::Type::Assignment);
-		std::unique_ptr<BinaryExpression> assignment
-		      = std::make_unique<BinaryExpression>(std::move(assignmentOperator),
-		            std::make_unique<SymbolExpression>(std::make_unique<Symbol>(
-		                  Slice(tempVariableName, inputModule->getSource(), 0, 0))),
-		            std::move(newFinalExpression));
-		std::unique_ptr<ExpressionStatement> newAssignment
-		      = std::make_unique<ExpressionStatement>(std::move(assignment));
-		newBlock->pushStatement(std::move(newAssignment));
+		body->pushStatement(
+		      assignTemporary(*tempVariable, cast<Expression>(returnValue)));
 		blockTemporaryVariables.pop();
-		std::unique_ptr<WhileExpression> newWhileExpression
-		      = std::make_unique<WhileExpression>(std::move(newCondition),
-		            std::move(newBlock));
-		newWhileExpression->setTypeID(node.getTypeID());
-
-		std::unique_ptr<ExpressionStatement> whileExpressionStatement
-		      = std::make_unique<ExpressionStatement>(std::move(newWhileExpression));
-		scopeStack.back()->pushStatement(std::move(whileExpressionStatement));
-		returnValue = std::make_unique<SymbolExpression>(std::make_unique<Symbol>(
-		      Slice(tempVariableName, inputModule->getSource(), 0, 0)));
+		node.setBody(body);
+
+		scopeStack.back()->pushStatement(arena->make<ExpressionStatement>(&node));
+		returnValue = arena->make<SymbolExpression>(arena->make<Symbol>(*tempVariable));
 	} else {
-		Expression &oldCondition = node.getCondition();
-		Expression &oldBlock = node.getBody();
-		visitExpression(oldCondition);
-		std::unique_ptr<Expression> newCondition = std::unique_ptr<Expression>(
-		      dynamic_cast<Expression *>(returnValue.release()));
-		visitExpression(oldBlock);
-		std::unique_ptr<BlockExpression> newBlock = std::unique_ptr<BlockExpression>(
-		      dynamic_cast<BlockExpression *>(returnValue.release()));
-		std::unique_ptr<WhileExpression> newWhileExpression
-		      = std::make_unique<WhileExpression>(std::move(newCondition),
-		            std::move(newBlock));
-		newWhileExpression->setTypeID(node.getTypeID());
-		returnValue = std::move(newWhileExpression);
+		visitExpression(node.getCondition());
+		node.setCondition(cast<Expression>(returnValue));
+		visitExpression(node.getBody());
+		node.setBody(cast<BlockExpression>(returnValue));
+		returnValue = &node;
 	}
 }
 
 void CCodeAdapter::visit(ExpressionStatement &node) {
-	Expression &oldExpression = node.getExpression();
-	visitExpression(oldExpression);
-	std::unique_ptr<Expression> newExpression = std::unique_ptr<Expression>(
-	      dynamic_cast<Expression *>(returnValue.release()));
-	returnValue = std::make_unique<ExpressionStatement>(std::move(newExpression));
+	visitExpression(node.getExpression());
+	node.setExpression(cast<Expression>(returnValue));
+	returnValue = &node;
 }
 
 void CCodeAdapter::visit(LetStatement &node) {
-	Symbol &oldSymbol = node.getSymbol();
-	Expression *oldExpression = node.getExpression();
-	generatedStrings->push_back("CANYON_LOCAL_" + std::string(oldSymbol.s.contents));
-	std::string_view newName = generatedStrings->back();
-	std::unique_ptr<Symbol> newSymbol
-	      = std::make_unique<Symbol>(Slice(newName, inputModule->getSource(), 0, 0));
-	visitExpression(*oldExpression);
-	std::unique_ptr<Expression> newExpression = std::unique_ptr<Expression>(
-	      dynamic_cast<Expression *>(returnValue.release()));
-	std::unique_ptr<LetStatement> newLetStatement = std::make_unique<LetStatement>(
-	      std::move(newSymbol), std::move(newExpression));
-	newLetStatement->setSymbolTypeID(node.getSymbolTypeID());
-	returnValue = std::move(newLetStatement);
+	rename(node.getSymbol(), localNames);
+	visitExpression(*node.getExpression());
+	node.setExpression(cast<Expression>(returnValue));
+	returnValue = &node;
 }
 
 void CCodeAdapter::visit(Function &node) {
-	std::vector<std::pair<std::unique_ptr<Symbol>, std::unique_ptr<Symbol>>>
-	      newParameters;
-	node.forEachParameter([this, &newParameters](Symbol &parameter, Symbol &type) {
-		generatedStrings->push_back(
-		      "CANYON_PARAMETER_" + std::string(parameter.s.contents));
-		std::string_view newParameterName = generatedStrings->back();
-		std::unique_ptr<Symbol> newParameter = std::make_unique<Symbol>(
-		      Slice(newParameterName, inputModule->getSource(), 0, 0));
-		std::unique_ptr<Symbol> newType = std::make_unique<Symbol>(type);
-		newParameters.emplace_back(std::move(newParameter), std::move(newType));
+	node.forEachParameter([this](Symbol &parameter, [[maybe_unused]] Symbol &type) {
+		rename(parameter, parameterNames);
 	});
 
-	Expression &oldBody = node.getBody();
-	std::unique_ptr<BlockExpression> enclosingScope = std::make_unique<BlockExpression>();
-	scopeStack.push_back(enclosingScope.get());
-	visitExpression(oldBody);
-	std::unique_ptr<Expression> newBody = std::unique_ptr<Expression>(
-	      dynamic_cast<Expression *>(returnValue.release()));
+	BlockExpression *enclosingScope = arena->make<BlockExpression>(*arena);
+	scopeStack.push_back(enclosingScope);
+	visitExpression(node.getBody());
+	Expression *body = cast<Expression>(returnValue);
 	scopeStack.pop_back();
-	std::unique_ptr<ExpressionStatement> bodyStatement
-	      = std::make_unique<ExpressionStatement>(std::move(newBody));
-	enclosingScope->pushStatement(std::move(bodyStatement));
-	returnValue = std::make_unique<Function>(std::move(newParameters),
-	      std::move(enclosingScope));
+	enclosingScope->pushStatement(arena->make<ExpressionStatement>(body));
+	node.setBody(enclosingScope);
+	returnValue = &node;
 }
 
 void CCodeAdapter::visit(Module &node) {
-	node.forEachFunction([this](std::string_view name, Function &oldFunction,
+	node.forEachFunction([this](std::string_view name, Function &function,
 	                           bool isBuiltin) {
-		oldFunction.accept(*this);
-		std::unique_ptr<Function> newFunction = std::unique_ptr<Function>(
-		      dynamic_cast<Function *>(returnValue.release()));
-		generatedStrings->push_back("CANYON_FUNCTION_" + std::string(name));
-		std::string_view newName = generatedStrings->back();
-		newFunction->setTypeID(oldFunction.getTypeID());
-		outputModule->addFunction(
-		      std::make_unique<Symbol>(Slice(newName, inputModule->getSource(), 0, 0)),
-		      std::move(newFunction), isBuiltin);
+		function.accept(*this);
+		SymbolID id = spell(interner->find(name), functionNames);
+		Symbol cName(Slice(interner->getName(id), inputModule->getSource()), id);
+		outputModule->addFunction(cName, &function, isBuiltin);
 	});
 }
 
+Symbol *CCodeAdapter::makeSymbol(std::string_view name) {
+	SymbolID id = interner->intern(name);
+	Slice text = Slice(interner->getName(id), inputModule->getSource());
+	return arena->make<Symbol>(text, id);
+}
+
+Symbol *CCodeAdapter::makeTemporarySymbol(std::string_view prefix) {
+	nameBuffer.assign(prefix);
+	nameBuffer += std::to_string(blockCount++);
+	return makeSymbol(nameBuffer);
+}
+
+SymbolID CCodeAdapter::spell(SymbolID name, Renaming &renaming) {
+	if (name >= renaming.spellings.size()) {
+		renaming.spellings.resize(name + 1, Interner::NO_SYMBOL);
+	}
+	if (renaming.spellings[name] == Interner::NO_SYMBOL) {
+		nameBuffer.assign(renaming.prefix);
+		nameBuffer += interner->getName(name);
+		renaming.spellings[name] = interner->intern(nameBuffer);
+	}
+	return renaming.spellings[name];
+}
+
+void CCodeAdapter::rename(Symbol &symbol, Renaming &renaming) {
+	SymbolID id = spell(symbol.id, renaming);
+	symbol.s = Slice(interner->getName(id), inputModule->getSource());
+	symbol.id = id;
+}
+
+Symbol *CCodeAdapter::declareTemporary(std::string_view prefix, int typeID) {
+	Symbol *temporary = makeTemporarySymbol(prefix);
+	LetStatement *declaration = arena->make<LetStatement>(temporary, nullptr);
+	declaration->setSymbolTypeID(typeID);
+	scopeStack.back()->pushStatement(declaration);
+	return temporary;
+}
+
+ExpressionStatement *CCodeAdapter::assignTemporary(const Symbol &temporary,
+      Expression *value) {
+	Punctuation equalSign
+	      = Punctuation(Slice("=", inputModule->getSource()), Punctuation::Type::Equals);
+	Operator *assignmentOperator
+	      = arena->make<Operator>(equalSign, Operator::Type::Assignment);
+	BinaryExpression *assignment = arena->make<BinaryExpression>(assignmentOperator,
+	      arena->make<SymbolExpression>(arena->make<Symbol>(temporary)), value);
+	return arena->make<ExpressionStatement>(assignment);
+}
+
 void CCodeAdapter::visitExpression(Expression &node) {
 	// TODO(#11) move this logic into visit BlockExpression
-	auto *blockExpression = dynamic_cast<BlockExpression *>(&node);
-	if (blockExpression != nullptr
-	      && blockExpression->getTypeID() != inputModule->getType("()").id
-	      && blockExpression->getTypeID() != inputModule->getType("!").id) {
-		generatedStrings->push_back("CANYON_BLOCK_" + std::to_string(blockCount++));
-		std::string_view tempVariableName = generatedStrings->back();
-		std::unique_ptr<LetStatement> declaration = std::make_unique<LetStatement>(
-		      std::make_unique<Symbol>(
-		            Slice(tempVariableName, inputModule->getSource(), 0, 0)),
-		      nullptr);
-		scopeStack.back()->pushSymbol(tempVariableName, node.getTypeID(),
-		      SymbolSource::GENERATED_Block);
-		declaration->setSymbolTypeID(node.getTypeID());
-		scopeStack.back()->pushStatement(std::move(declaration));
-		blockTemporaryVariables.push(tempVariableName);
+	auto *blockExpression = dyn_cast<BlockExpression>(&node);
+	if (blockExpression != nullptr && blockExpression->getTypeID() != Type::UNIT
+	      && blockExpression->getTypeID() != Type::NEVER) {
+		Symbol *tempVariable = declareTemporary("CANYON_BLOCK_", node.getTypeID());
+		blockTemporaryVariables.push(tempVariable);
 		node.accept(*this);
-		std::unique_ptr<BlockExpression> newBlock = std::unique_ptr<BlockExpression>(
-		      dynamic_cast<BlockExpression *>(returnValue.release()));
-		std::unique_ptr<ExpressionStatement> blockExpressionStatement
-		      = std::make_unique<ExpressionStatement>(std::move(newBlock));
-		scopeStack.back()->pushStatement(std::move(blockExpressionStatement));
-		returnValue = std::make_unique<SymbolExpression>(std::make_unique<Symbol>(
-		      Slice(tempVariableName, inputModule->getSource(), 0, 0)));
+		scopeStack.back()->pushStatement(arena->make<ExpressionStatement>(
+		      cast<BlockExpression>(returnValue)));
+		returnValue = arena->make<SymbolExpression>(arena->make<Symbol>(*tempVariable));
 	} else {
 		node.accept(*this);
 	}
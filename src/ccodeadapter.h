@@ -1,29 +1,59 @@
 #ifndef CCODEADAPTER_H
 #define CCODEADAPTER_H
 
+#include "arena.h"
 #include "ast.h"
+#include "interner.h"
 
-#include <list>
 #include <memory>
 #include <stack>
+#include <string>
 #include <string_view>
 #include <vector>
 
 /**
- * @brief Transforms an AST into one that is more suitable for generating C code
+ * @brief Lowers an AST in place into one that is more suitable for generating C code.
+ * Names are rewritten to their C spellings, and blocks, ifs, whiles and arguments whose
+ * values are needed are hoisted into temporaries declared before the statement using
+ * them. Every other node is reused as it is
  *
  */
 class CCodeAdapter : ASTVisitor {
 private:
+	/**
+	 * @brief The C spellings of the names rewritten with one prefix. Each name is spelled
+	 * and interned the first time it is renamed, and only looked up after that
+	 */
+	struct Renaming {
+		std::string_view prefix;
+		// Indexed by the SymbolID of the Canyon name, or NO_SYMBOL if not yet spelled
+		std::vector<SymbolID> spellings;
+	};
+
 	Module *inputModule;
 	std::unique_ptr<Module> outputModule;
-	std::unique_ptr<ASTComponent> returnValue = nullptr;
+	// The Arena of inputModule, from which the nodes spliced into its AST are allocated
+	Arena *arena;
+	ASTComponent *returnValue = nullptr;
 	int blockCount = 0;
-	std::stack<std::string_view> blockTemporaryVariables;
+	std::stack<Symbol *> blockTemporaryVariables;
 	std::vector<BlockExpression *> scopeStack;
-	std::list<std::string> *generatedStrings;
+	// Shared by both Modules, and keeps the text of every generated name
+	Interner *interner;
+	// Reused to spell each generated name, so that generating one does not allocate
+	std::string nameBuffer;
+	Renaming functionNames{"CANYON_FUNCTION_", {}};
+	Renaming parameterNames{"CANYON_PARAMETER_", {}};
+	Renaming localNames{"CANYON_LOCAL_", {}};
 public:
-	CCodeAdapter(Module *module, std::list<std::string> *generatedStrings);
+	explicit CCodeAdapter(Module *module);
+	/**
+	 * @brief Lowers the AST of the Module given to the constructor, which can no longer
+	 * be analyzed afterwards
+	 *
+	 * @return a Module listing the lowered Functions under their C names. It shares their
+	 * nodes with the input Module, so it must not outlive it
+	 */
 	std::unique_ptr<Module> transform();
 	void visit(FunctionCallExpression &node) override;
 	void visit(BinaryExpression &node) override;
@@ -43,6 +73,40 @@ public:
 	void visit(Module &node) override;
 	virtual ~CCodeAdapter() = default;
 private:
+	/**
+	 * @brief Creates a Symbol in the output Module for a generated name
+	 */
+	Symbol *makeSymbol(std::string_view name);
+	/**
+	 * @brief Creates a Symbol for a generated name which has not been used before
+	 *
+	 * @param prefix how the name begins, before its unique number
+	 */
+	Symbol *makeTemporarySymbol(std::string_view prefix);
+	/**
+	 * @brief Gets the C spelling of a name, spelling it if this is its first use
+	 *
+	 * @param name the SymbolID of the Canyon name
+	 * @param renaming the prefix to spell it with
+	 * @return the SymbolID of the C name
+	 */
+	SymbolID spell(SymbolID name, Renaming &renaming);
+	/**
+	 * @brief Rewrites a Symbol in the AST to its C spelling
+	 */
+	void rename(Symbol &symbol, Renaming &renaming);
+	/**
+	 * @brief Declares an uninitialized temporary in the innermost block being lowered
+	 *
+	 * @param prefix how the name of the temporary begins, before its unique number
+	 * @param typeID the type of the temporary
+	 * @return the name of the temporary
+	 */
+	Symbol *declareTemporary(std::string_view prefix, int typeID);
+	/**
+	 * @brief Makes the statement `temporary = value;`
+	 */
+	ExpressionStatement *assignTemporary(const Symbol &temporary, Expression *value);
 	void visitExpression(Expression &node);
 };
 
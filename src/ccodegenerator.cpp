@@ -1,39 +1,45 @@
 #include "ccodegenerator.h"
 
+#include "casting.h"
 #include "ccodeadapter.h"
+#include "outputfile.h"
+#include "threadpool.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
-#include <list>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
 
-CCodeGenerator::CCodeGenerator(Module *module, std::ostream *os)
-    : module(module), os(os) {
+CCodeGenerator::CCodeGenerator(Module *module, OutputFile *out, ThreadPool *threadPool)
+    : module(module), out(out), threadPool(threadPool) {
 	cTypes[-1] = "UNKNOWN_TYPE";
-	cTypes[this->module->getType("()").id] = "void";
-	cTypes[this->module->getType("i8").id] = "int8_t";
-	cTypes[this->module->getType("i16").id] = "int16_t";
-	cTypes[this->module->getType("i32").id] = "int32_t";
-	cTypes[this->module->getType("i64").id] = "int64_t";
-	cTypes[this->module->getType("u8").id] = "uint8_t";
-	cTypes[this->module->getType("u16").id] = "uint16_t";
-	cTypes[this->module->getType("u32").id] = "uint32_t";
-	cTypes[this->module->getType("u64").id] = "uint64_t";
-	cTypes[this->module->getType("bool").id] = "bool";
-	cTypes[this->module->getType("char").id] = "char";
+	cTypes[Type::UNIT] = "void";
+	cTypes[Type::I8] = "int8_t";
+	cTypes[Type::I16] = "int16_t";
+	cTypes[Type::I32] = "int32_t";
+	cTypes[Type::I64] = "int64_t";
+	cTypes[Type::U8] = "uint8_t";
+	cTypes[Type::U16] = "uint16_t";
+	cTypes[Type::U32] = "uint32_t";
+	cTypes[Type::U64] = "uint64_t";
+	cTypes[Type::BOOL] = "bool";
+	cTypes[Type::CHAR] = "char";
 }
 
 void CCodeGenerator::generate() {
 	generateIncludes();
-	CCodeAdapter adapter = CCodeAdapter(module, &generatedStrings);
+	CCodeAdapter adapter = CCodeAdapter(module);
 	std::unique_ptr<Module> adapted = adapter.transform();
 	visit(*adapted);
 }
 
 void CCodeGenerator::generateIncludes() {
-	*os << "#include <stdint.h>\n"
+	*out << "#include <stdint.h>\n"
 	       "#include <stdbool.h>\n"
 	       "#include <stdio.h>\n"
 	       "#include <inttypes.h>\n"
@@ -42,31 +48,36 @@ void CCodeGenerator::generateIncludes() {
 
 void CCodeGenerator::visit(FunctionCallExpression &node) {
 	node.getFunction().accept(*this);
-	*os << '(';
+	*out << '(';
 	bool first = true;
 	node.forEachArgument([this, &first](Expression &argument) {
 		if (!first) {
-			*os << ", ";
+			*out << ", ";
 		}
 		first = false;
 		argument.accept(*this);
 	});
-	*os << ')';
+	*out << ')';
 }
 
 void CCodeGenerator::visit(BinaryExpression &node) {
-	*os << '(';
-	node.getLeft().accept(*this);
-	*os << ") " << node.getOperator().s << " (";
-	node.getRight().accept(*this);
-	*os << ')';
+	std::vector<BinaryExpression *> chain = node.getLeftChain();
+	for (size_t i = 0; i < chain.size(); i++) {
+		*out << '(';
+	}
+	chain.back()->getLeft().accept(*this);
+	for (auto it = chain.rbegin(); it != chain.rend(); it++) {
+		*out << ") " << Operator::typeToStringView((*it)->getOperator().type) << " (";
+		(*it)->getRight().accept(*this);
+		*out << ')';
+	}
 }
 
 void CCodeGenerator::visit(UnaryExpression &node) {
-	*os << node.getOperator().s;
-	*os << '(';
+	*out << Operator::typeToStringView(node.getOperator().type);
+	*out << '(';
 	node.getExpression().accept(*this);
-	*os << ')';
+	*out << ')';
 }
 
 void CCodeGenerator::visit(IntegerLiteralExpression &node) {
@@ -75,91 +86,91 @@ void CCodeGenerator::visit(IntegerLiteralExpression &node) {
 		case IntegerLiteral::Type::I8:
 		case IntegerLiteral::Type::I16:
 		case IntegerLiteral::Type::I32:
-			*os << literal.value;
+			*out << literal.value;
 			break;
 		case IntegerLiteral::Type::I64:
-			*os << literal.value << "LL";
+			*out << literal.value << "LL";
 			break;
 		case IntegerLiteral::Type::U8:
 		case IntegerLiteral::Type::U16:
 		case IntegerLiteral::Type::U32:
-			*os << literal.value << "U";
+			*out << literal.value << "U";
 			break;
 		case IntegerLiteral::Type::U64:
-			*os << literal.value << "ULL";
+			*out << literal.value << "ULL";
 			break;
 	}
 }
 
 void CCodeGenerator::visit(BoolLiteralExpression &node) {
-	*os << (node.getLiteral().value ? "true" : "false");
+	*out << (node.getLiteral().value ? "true" : "false");
 }
 
 void CCodeGenerator::visit(CharacterLiteralExpression &node) {
-	*os << '\'';
+	*out << '\'';
 	char c = node.getLiteral().value;
 	switch (c) {
 		case '\a':
-			*os << "\\a";
+			*out << "\\a";
 			break;
 		case '\b':
-			*os << "\\b";
+			*out << "\\b";
 			break;
 		case '\f':
-			*os << "\\f";
+			*out << "\\f";
 			break;
 		case '\n':
-			*os << "\\n";
+			*out << "\\n";
 			break;
 		case '\r':
-			*os << "\\r";
+			*out << "\\r";
 			break;
 		case '\t':
-			*os << "\\t";
+			*out << "\\t";
 			break;
 		case '\v':
-			*os << "\\v";
+			*out << "\\v";
 			break;
 		case '\\':
-			*os << "\\\\";
+			*out << "\\\\";
 			break;
 		case '\'':
-			*os << "\\'";
+			*out << "\\'";
 			break;
 		case '\"':
-			*os << "\\\"";
+			*out << "\\\"";
 			break;
 		default:
-			*os << c;
+			*out << c;
 			break;
 	}
-	*os << '\'';
+	*out << '\'';
 }
 
 void CCodeGenerator::visit(SymbolExpression &node) {
-	*os << node.getSymbol().s;
+	*out << node.getSymbol().s.contents;
 }
 
 void CCodeGenerator::visit(BlockExpression &node) {
-	*os << "{\n";
+	*out << "{\n";
 	tabLevel++;
 	node.forEachStatement([this](Statement &statement) {
-		*os << std::string(tabLevel, '\t');
+		out->indent(tabLevel);
 		statement.accept(*this);
 	});
 	tabLevel--;
-	*os << std::string(tabLevel, '\t');
-	*os << "}\n";
+	out->indent(tabLevel);
+	*out << "}\n";
 }
 
 void CCodeGenerator::visit(ReturnExpression &node) {
 	// Invariant: the return expression will only ever be in an ExpressionStatement (not
 	// nested inside another expression) Otherwise it would trigger unreachable code error
 	// before reaching the codegen phase
-	*os << "return";
+	*out << "return";
 	Expression *expression = node.getExpression();
 	if (expression != nullptr) {
-		*os << ' ';
+		*out << ' ';
 		expression->accept(*this);
 	}
 }
@@ -169,29 +180,29 @@ void CCodeGenerator::visit(ParenthesizedExpression &node) {
 }
 
 void CCodeGenerator::visit(IfElseExpression &node) {
-	*os << "if (";
+	*out << "if (";
 	node.getCondition().accept(*this);
-	*os << ") ";
+	*out << ") ";
 	node.getThenBlock().accept(*this);
 	Expression *elseExpression = node.getElseExpression();
 	if (elseExpression != nullptr) {
-		*os << std::string(tabLevel, '\t');
-		*os << "else ";
+		out->indent(tabLevel);
+		*out << "else ";
 		elseExpression->accept(*this);
 	}
 }
 
 void CCodeGenerator::visit(WhileExpression &node) {
-	*os << "while (";
+	*out << "while (";
 	node.getCondition().accept(*this);
-	*os << ") ";
+	*out << ") ";
 	node.getBody().accept(*this);
 }
 
 void CCodeGenerator::visit(ExpressionStatement &node) {
 	node.getExpression().accept(*this);
-	if (!dynamic_cast<BlockExpression *>(&node.getExpression())) {
-		*os << ";\n";
+	if (!isa<BlockExpression>(node.getExpression())) {
+		*out << ";\n";
 	}
 }
 
@@ -199,11 +210,11 @@ void CCodeGenerator::visit(LetStatement &node) {
 	const std::string &cType = cTypes[node.getSymbolTypeID()];
 	Expression *expression = node.getExpression();
 	if (expression != nullptr) {
-		*os << cType << ' ' << node.getSymbol().s << " = ";
+		*out << cType << ' ' << node.getSymbol().s.contents << " = ";
 		node.getExpression()->accept(*this);
-		*os << ";\n";
+		*out << ";\n";
 	} else {
-		*os << cType << ' ' << node.getSymbol().s << ";\n";
+		*out << cType << ' ' << node.getSymbol().s.contents << ";\n";
 	}
 }
 
@@ -212,97 +223,118 @@ void CCodeGenerator::visit([[maybe_unused]] Function &node) {
 }
 
 void CCodeGenerator::visit(Module &node) {
-	// Forward declarations
+	std::vector<std::tuple<std::string_view, Function *, bool>> functions;
 	node.forEachFunction(
-	      [this](std::string_view name, Function &function, bool /*unused*/) {
-		      Type functionType = module->getType(function.getTypeID());
-		      const std::string &cType = cTypes[functionType.id];
-		      *os << cType << ' ' << name << '(';
-		      bool first = true;
-		      function.forEachParameter([this, &first](Symbol &parameter, Symbol &type) {
-			      const std::string &cType = cTypes[module->getType(type.s.contents).id];
-			      if (!first) {
-				      *os << ", ";
-			      }
-			      first = false;
-			      *os << cType << ' ' << parameter.s;
-		      });
-		      *os << ");\n";
+	      [this, &functions](std::string_view name, Function &function, bool isBuiltin) {
+		      functions.emplace_back(name, &function, isBuiltin);
+		      generateSignature(name, function);
+		      *out << ");\n";
 	      });
-	*os << '\n';
+	*out << '\n';
 	generateMain();
 
-	// Function definitions
-	node.forEachFunction(
-	      [this](std::string_view name, Function &function, bool isBuiltin) {
-		      Type functionType = module->getType(function.getTypeID());
-		      const std::string &cType = cTypes[functionType.id];
-		      *os << cType << ' ' << name << '(';
-		      bool first = true;
-		      function.forEachParameter([this, &first](Symbol &parameter, Symbol &type) {
-			      const std::string &cType = cTypes[module->getType(type.s.contents).id];
-			      if (!first) {
-				      *os << ", ";
-			      }
-			      first = false;
-			      *os << cType << ' ' << parameter.s;
-		      });
-		      *os << ") ";
-		      if (!isBuiltin) {
-			      function.getBody().accept(*this);
-			      *os << "\n";
-			      return;
-		      }
-		      if (name == "CANYON_FUNCTION_printI8") {
-			      *os << "{\n"
-			             "    printf(\"%\" PRId8, CANYON_PARAMETER_value);\n"
-			             "}\n";
-		      } else if (name == "CANYON_FUNCTION_printI16") {
-			      *os << "{\n"
-			             "    printf(\"%\" PRId16, CANYON_PARAMETER_value);\n"
-			             "}\n";
-		      } else if (name == "CANYON_FUNCTION_printI32") {
-			      *os << "{\n"
-			             "    printf(\"%\" PRId32, CANYON_PARAMETER_value);\n"
-			             "}\n";
-		      } else if (name == "CANYON_FUNCTION_printI64") {
-			      *os << "{\n"
-			             "    printf(\"%\" PRId64, CANYON_PARAMETER_value);\n"
-			             "}\n";
-		      } else if (name == "CANYON_FUNCTION_printU8") {
-			      *os << "{\n"
-			             "    printf(\"%\" PRIu8, CANYON_PARAMETER_value);\n"
-			             "}\n";
-		      } else if (name == "CANYON_FUNCTION_printU16") {
-			      *os << "{\n"
-			             "    printf(\"%\" PRIu16, CANYON_PARAMETER_value);\n"
-			             "}\n";
-		      } else if (name == "CANYON_FUNCTION_printU32") {
-			      *os << "{\n"
-			             "    printf(\"%\" PRIu32, CANYON_PARAMETER_value);\n"
-			             "}\n";
-		      } else if (name == "CANYON_FUNCTION_printU64") {
-			      *os << "{\n"
-			             "    printf(\"%\" PRIu64, CANYON_PARAMETER_value);\n"
-			             "}\n";
-		      } else if (name == "CANYON_FUNCTION_printBool") {
-			      *os << "{\n"
-			             "    printf(CANYON_PARAMETER_value ? \"true\" : \"false\");\n"
-			             "}\n";
-		      } else if (name == "CANYON_FUNCTION_printChar") {
-			      *os << "{\n"
-			             "    printf(\"%c\", CANYON_PARAMETER_value);\n"
-			             "}\n";
-		      } else {
-			      std::cerr << "Unknown builtin function: " << name << '\n';
-			      exit(EXIT_FAILURE);
-		      }
-		      *os << "\n";
-	      });
+	// Buffering definitions only pays off when they are generated on several threads
+	if (threadPool == nullptr || threadPool->size() == 1) {
+		for (auto &[name, function, isBuiltin] : functions) {
+			generateDefinition(name, *function, isBuiltin);
+		}
+		return;
+	}
+	// Definitions only read the lowered AST, so runs of them are generated at once, each
+	// into its own buffer by its own generator. The buffers are then written out in
+	// order, giving exactly the output of generating one definition at a time
+	size_t runs = threadPool->countRuns(functions.size());
+	std::vector<OutputFile> texts;
+	texts.reserve(runs);
+	for (size_t run = 0; run < runs; run++) {
+		texts.push_back(OutputFile::inMemory());
+	}
+	auto generateRun = [this, &functions, &texts](size_t run, size_t begin, size_t end) {
+		CCodeGenerator generator(module, &texts[run]);
+		for (size_t i = begin; i < end; i++) {
+			auto &[name, function, isBuiltin] = functions[i];
+			generator.generateDefinition(name, *function, isBuiltin);
+		}
+	};
+	threadPool->forEachRun(functions.size(), generateRun);
+	for (const OutputFile &text : texts) {
+		*out << text.getContents();
+	}
+}
+
+void CCodeGenerator::generateSignature(std::string_view name, Function &function) {
+	const Type &functionType = module->getType(function.getTypeID());
+	const std::string &cType = cTypes[functionType.id];
+	*out << cType << ' ' << name << '(';
+	bool first = true;
+	function.forEachParameter([this, &first](Symbol &parameter, Symbol &type) {
+		const std::string &cType = cTypes[module->getType(type).id];
+		if (!first) {
+			*out << ", ";
+		}
+		first = false;
+		*out << cType << ' ' << parameter.s.contents;
+	});
+}
+
+void CCodeGenerator::generateDefinition(std::string_view name, Function &function,
+      bool isBuiltin) {
+	generateSignature(name, function);
+	*out << ") ";
+	if (!isBuiltin) {
+		function.getBody().accept(*this);
+		*out << "\n";
+		return;
+	}
+	if (name == "CANYON_FUNCTION_printI8") {
+		*out << "{\n"
+		       "    printf(\"%\" PRId8, CANYON_PARAMETER_value);\n"
+		       "}\n";
+	} else if (name == "CANYON_FUNCTION_printI16") {
+		*out << "{\n"
+		       "    printf(\"%\" PRId16, CANYON_PARAMETER_value);\n"
+		       "}\n";
+	} else if (name == "CANYON_FUNCTION_printI32") {
+		*out << "{\n"
+		       "    printf(\"%\" PRId32, CANYON_PARAMETER_value);\n"
+		       "}\n";
+	} else if (name == "CANYON_FUNCTION_printI64") {
+		*out << "{\n"
+		       "    printf(\"%\" PRId64, CANYON_PARAMETER_value);\n"
+		       "}\n";
+	} else if (name == "CANYON_FUNCTION_printU8") {
+		*out << "{\n"
+		       "    printf(\"%\" PRIu8, CANYON_PARAMETER_value);\n"
+		       "}\n";
+	} else if (name == "CANYON_FUNCTION_printU16") {
+		*out << "{\n"
+		       "    printf(\"%\" PRIu16, CANYON_PARAMETER_value);\n"
+		       "}\n";
+	} else if (name == "CANYON_FUNCTION_printU32") {
+		*out << "{\n"
+		       "    printf(\"%\" PRIu32, CANYON_PARAMETER_value);\n"
+		       "}\n";
+	} else if (name == "CANYON_FUNCTION_printU64") {
+		*out << "{\n"
+		       "    printf(\"%\" PRIu64, CANYON_PARAMETER_value);\n"
+		       "}\n";
+	} else if (name == "CANYON_FUNCTION_printBool") {
+		*out << "{\n"
+		       "    printf(CANYON_PARAMETER_value ? \"true\" : \"false\");\n"
+		       "}\n";
+	} else if (name == "CANYON_FUNCTION_printChar") {
+		*out << "{\n"
+		       "    printf(\"%c\", CANYON_PARAMETER_value);\n"
+		       "}\n";
+	} else {
+		std::cerr << "Unknown builtin function: " << name << '\n';
+		exit(EXIT_FAILURE);
+	}
+	*out << "\n";
 }
 
 void CCodeGenerator::generateMain() {
-	*os << "int main() {\n"
+	*out << "int main() {\n"
 	       "    CANYON_FUNCTION_main();\n"
 	       "    return 0;\n"
 	       "}\n"
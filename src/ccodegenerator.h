@@ -2,10 +2,13 @@
 #define CCODEGENERATOR_H
 
 #include "ast.h"
+#include "outputfile.h"
+#include "threadpool.h"
 
-#include <iostream>
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 /**
@@ -15,12 +18,17 @@
 class CCodeGenerator : public ASTVisitor {
 private:
 	Module *module;
-	std::ostream *os;
+	OutputFile *out;
 	std::unordered_map<int, std::string> cTypes;
 	int tabLevel = 0;
-	std::list<std::string> generatedStrings;
+	// Generates function definitions in parallel if not null
+	ThreadPool *threadPool = nullptr;
 public:
-	CCodeGenerator(Module *module, std::ostream *os);
+	CCodeGenerator(Module *module, OutputFile *out, ThreadPool *threadPool = nullptr);
+	/**
+	 * @brief Writes the C translation of the Module. Its AST is lowered in place first,
+	 * so the Module cannot be analyzed or generated again afterwards
+	 */
 	void generate();
 	void visit(FunctionCallExpression &node) override;
 	void visit(BinaryExpression &node) override;
@@ -42,6 +50,12 @@ public:
 private:
 	void generateIncludes();
 	void generateMain();
+	/**
+	 * @brief Writes a function's return type, name and parameters, up to but not
+	 * including the closing parenthesis
+	 */
+	void generateSignature(std::string_view name, Function &function);
+	void generateDefinition(std::string_view name, Function &function, bool isBuiltin);
 };
 
 #endif
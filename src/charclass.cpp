@@ -0,0 +1,261 @@
+#include "charclass.h"
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// SSE2 is part of the x86-64 baseline, so only AVX2 must be enabled per function
+#if defined(__GNUC__) && defined(__x86_64__)
+#	define CANYON_X86_KERNELS
+#	include <immintrin.h>
+#endif
+
+constinit const std::array<uint8_t, 256> CharClass::table = []() {
+	std::array<uint8_t, 256> table{};
+	for (unsigned char c : std::string_view(" \t\n\v\f\r")) {
+		table[c] |= SPACE;
+	}
+	for (unsigned char c = '0'; c <= '9'; c++) {
+		table[c] |= ALNUM | DIGIT;
+	}
+	for (unsigned char c = 'a'; c <= 'z'; c++) {
+		table[c] |= ALNUM;
+		table[c - 'a' + 'A'] |= ALNUM;
+	}
+	for (unsigned char c : std::string_view("();{}.,+-*/%=:!<>&|~^'")) {
+		table[c] |= SEPARATOR;
+	}
+	return table;
+}();
+
+namespace {
+
+struct Kernels {
+	CharClass::Kernel kernel;
+	size_t (*skipSpace)(std::string_view text, size_t offset);
+	size_t (*skipAlnum)(std::string_view text, size_t offset);
+	size_t (*find)(std::string_view text, size_t offset, char c);
+};
+
+size_t skipSpaceScalar(std::string_view text, size_t offset) {
+	while (offset < text.size() && CharClass::isSpace(text[offset])) {
+		offset++;
+	}
+	return offset;
+}
+
+size_t skipAlnumScalar(std::string_view text, size_t offset) {
+	while (offset < text.size() && CharClass::isAlnum(text[offset])) {
+		offset++;
+	}
+	return offset;
+}
+
+size_t findScalar(std::string_view text, size_t offset, char c) {
+	while (offset < text.size() && text[offset] != c) {
+		offset++;
+	}
+	return offset;
+}
+
+constexpr Kernels SCALAR_KERNELS = {
+      CharClass::Kernel::Scalar, skipSpaceScalar, skipAlnumScalar, findScalar};
+
+#ifdef CANYON_X86_KERNELS
+
+// Each kernel builds a bitmask of which bytes of a block belong to the class, and stops
+// at the first block with a byte outside of it. Unsigned range checks use the identity
+// x - lo <= hi - lo  <=>  min(x - lo, hi - lo) == x - lo
+
+size_t skipSpaceSSE2(std::string_view text, size_t offset) {
+	constexpr size_t WIDTH = 16;
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i controlRange = _mm_set1_epi8('\r' - '\t');
+	for (; offset + WIDTH <= text.size(); offset += WIDTH) {
+		__m128i block
+		      = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + offset));
+		__m128i control = _mm_sub_epi8(block, tab);
+		__m128i matches = _mm_or_si128(_mm_cmpeq_epi8(block, space),
+		      _mm_cmpeq_epi8(_mm_min_epu8(control, controlRange), control));
+		auto mask = static_cast<uint32_t>(~_mm_movemask_epi8(matches) & 0xFFFF);
+		if (mask != 0) {
+			return offset + __builtin_ctz(mask);
+		}
+	}
+	return skipSpaceScalar(text, offset);
+}
+
+size_t skipAlnumSSE2(std::string_view text, size_t offset) {
+	constexpr size_t WIDTH = 16;
+	const __m128i zero = _mm_set1_epi8('0');
+	const __m128i digitRange = _mm_set1_epi8('9' - '0');
+	const __m128i lowercase = _mm_set1_epi8(0x20);
+	const __m128i a = _mm_set1_epi8('a');
+	const __m128i letterRange = _mm_set1_epi8('z' - 'a');
+	for (; offset + WIDTH <= text.size(); offset += WIDTH) {
+		__m128i block
+		      = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + offset));
+		__m128i digit = _mm_sub_epi8(block, zero);
+		__m128i letter = _mm_sub_epi8(_mm_or_si128(block, lowercase), a);
+		__m128i matches
+		      = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(digit, digitRange), digit),
+		            _mm_cmpeq_epi8(_mm_min_epu8(letter, letterRange), letter));
+		auto mask = static_cast<uint32_t>(~_mm_movemask_epi8(matches) & 0xFFFF);
+		if (mask != 0) {
+			return offset + __builtin_ctz(mask);
+		}
+	}
+	return skipAlnumScalar(text, offset);
+}
+
+size_t findSSE2(std::string_view text, size_t offset, char c) {
+	constexpr size_t WIDTH = 16;
+	const __m128i target = _mm_set1_epi8(c);
+	for (; offset + WIDTH <= text.size(); offset += WIDTH) {
+		__m128i block
+		      = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + offset));
+		auto mask
+		      = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, target)));
+		if (mask != 0) {
+			return offset + __builtin_ctz(mask);
+		}
+	}
+	return findScalar(text, offset, c);
+}
+
+__attribute__((target("avx2"))) size_t skipSpaceAVX2(std::string_view text,
+      size_t offset) {
+	constexpr size_t WIDTH = 32;
+	const __m256i space = _mm256_set1_epi8(' ');
+	const __m256i tab = _mm256_set1_epi8('\t');
+	const __m256i controlRange = _mm256_set1_epi8('\r' - '\t');
+	for (; offset + WIDTH <= text.size(); offset += WIDTH) {
+		__m256i block = _mm256_loadu_si256(
+		      reinterpret_cast<const __m256i *>(text.data() + offset));
+		__m256i control = _mm256_sub_epi8(block, tab);
+		__m256i matches = _mm256_or_si256(_mm256_cmpeq_epi8(block, space),
+		      _mm256_cmpeq_epi8(_mm256_min_epu8(control, controlRange), control));
+		auto mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+		if (mask != 0) {
+			return offset + __builtin_ctz(mask);
+		}
+	}
+	return skipSpaceSSE2(text, offset);
+}
+
+__attribute__((target("avx2"))) size_t skipAlnumAVX2(std::string_view text,
+      size_t offset) {
+	constexpr size_t WIDTH = 32;
+	const __m256i zero = _mm256_set1_epi8('0');
+	const __m256i digitRange = _mm256_set1_epi8('9' - '0');
+	const __m256i lowercase = _mm256_set1_epi8(0x20);
+	const __m256i a = _mm256_set1_epi8('a');
+	const __m256i letterRange = _mm256_set1_epi8('z' - 'a');
+	for (; offset + WIDTH <= text.size(); offset += WIDTH) {
+		__m256i block = _mm256_loadu_si256(
+		      reinterpret_cast<const __m256i *>(text.data() + offset));
+		__m256i digit = _mm256_sub_epi8(block, zero);
+		__m256i letter = _mm256_sub_epi8(_mm256_or_si256(block, lowercase), a);
+		__m256i matches = _mm256_or_si256(
+		      _mm256_cmpeq_epi8(_mm256_min_epu8(digit, digitRange), digit),
+		      _mm256_cmpeq_epi8(_mm256_min_epu8(letter, letterRange), letter));
+		auto mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+		if (mask != 0) {
+			return offset + __builtin_ctz(mask);
+		}
+	}
+	return skipAlnumSSE2(text, offset);
+}
+
+__attribute__((target("avx2"))) size_t findAVX2(std::string_view text, size_t offset,
+      char c) {
+	constexpr size_t WIDTH = 32;
+	const __m256i target = _mm256_set1_epi8(c);
+	for (; offset + WIDTH <= text.size(); offset += WIDTH) {
+		__m256i block = _mm256_loadu_si256(
+		      reinterpret_cast<const __m256i *>(text.data() + offset));
+		auto mask = static_cast<uint32_t>(
+		      _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, target)));
+		if (mask != 0) {
+			return offset + __builtin_ctz(mask);
+		}
+	}
+	return findSSE2(text, offset, c);
+}
+
+constexpr Kernels SSE2_KERNELS
+      = {CharClass::Kernel::SSE2, skipSpaceSSE2, skipAlnumSSE2, findSSE2};
+constexpr Kernels AVX2_KERNELS
+      = {CharClass::Kernel::AVX2, skipSpaceAVX2, skipAlnumAVX2, findAVX2};
+
+#endif
+
+const Kernels *bestKernels() {
+#ifdef CANYON_X86_KERNELS
+	// This runs during static initialization, possibly before the CPU has been queried
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return &AVX2_KERNELS;
+	}
+	if (__builtin_cpu_supports("sse2")) {
+		return &SSE2_KERNELS;
+	}
+#endif
+	return &SCALAR_KERNELS;
+}
+
+const Kernels *kernels = bestKernels();
+
+} // namespace
+
+size_t CharClass::skipSpace(std::string_view text, size_t offset) {
+	return kernels->skipSpace(text, offset);
+}
+
+size_t CharClass::skipAlnum(std::string_view text, size_t offset) {
+	return kernels->skipAlnum(text, offset);
+}
+
+size_t CharClass::find(std::string_view text, size_t offset, char c) {
+	return kernels->find(text, offset, c);
+}
+
+CharClass::Kernel CharClass::getKernel() {
+	return kernels->kernel;
+}
+
+bool CharClass::isSupported(Kernel kernel) {
+	switch (kernel) {
+		case Kernel::Scalar:
+			return true;
+#ifdef CANYON_X86_KERNELS
+		case Kernel::SSE2:
+			return __builtin_cpu_supports("sse2");
+		case Kernel::AVX2:
+			return __builtin_cpu_supports("avx2");
+#endif
+		default:
+			return false;
+	}
+}
+
+bool CharClass::setKernel(Kernel kernel) {
+	if (!isSupported(kernel)) {
+		return false;
+	}
+	switch (kernel) {
+#ifdef CANYON_X86_KERNELS
+		case Kernel::SSE2:
+			kernels = &SSE2_KERNELS;
+			break;
+		case Kernel::AVX2:
+			kernels = &AVX2_KERNELS;
+			break;
+#endif
+		default:
+			kernels = &SCALAR_KERNELS;
+			break;
+	}
+	return true;
+}
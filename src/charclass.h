@@ -0,0 +1,113 @@
+#ifndef CHARCLASS_H
+#define CHARCLASS_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief Classifies the characters of Canyon source code using a lookup table, and skips
+ * over runs of characters of the same class many bytes at a time. The widest vector
+ * kernel the CPU supports is picked at runtime, falling back to a scalar loop
+ *
+ */
+class CharClass {
+public:
+	/**
+	 * @brief The implementations of the run-skipping operations
+	 *
+	 */
+	enum class Kernel {
+		Scalar,
+		SSE2,
+		AVX2,
+	};
+private:
+	enum Flags : uint8_t {
+		SPACE = 1 << 0,
+		ALNUM = 1 << 1,
+		DIGIT = 1 << 2,
+		// Punctuation and quotes, which always begin a new token
+		SEPARATOR = 1 << 3,
+	};
+	static const std::array<uint8_t, 256> table;
+
+	static uint8_t flags(char c) {
+		return table[static_cast<unsigned char>(c)];
+	}
+public:
+	/**
+	 * @brief Determines whether c is whitespace in the "C" locale
+	 */
+	static bool isSpace(char c) {
+		return (flags(c) & SPACE) != 0;
+	}
+
+	/**
+	 * @brief Determines whether c is an ASCII letter or digit
+	 */
+	static bool isAlnum(char c) {
+		return (flags(c) & ALNUM) != 0;
+	}
+
+	static bool isDigit(char c) {
+		return (flags(c) & DIGIT) != 0;
+	}
+
+	/**
+	 * @brief Determines whether c is whitespace, punctuation, or a quote, any of which
+	 * ends the token before it
+	 */
+	static bool isSeparator(char c) {
+		return (flags(c) & (SPACE | SEPARATOR)) != 0;
+	}
+
+	/**
+	 * @brief Determines whether c is any other character, which is neither a separator
+	 * nor alphanumeric
+	 */
+	static bool isOther(char c) {
+		return (flags(c) & (SPACE | SEPARATOR | ALNUM)) == 0;
+	}
+
+	/**
+	 * @brief Finds the end of a run of whitespace
+	 *
+	 * @param text the text to search
+	 * @param offset where the run begins
+	 * @return the offset of the first character at or after offset which is not
+	 * whitespace, or text.size() if there is none
+	 */
+	static size_t skipSpace(std::string_view text, size_t offset);
+	/**
+	 * @brief Finds the end of a run of letters and digits
+	 *
+	 * @param text the text to search
+	 * @param offset where the run begins
+	 * @return the offset of the first character at or after offset which is not
+	 * alphanumeric, or text.size() if there is none
+	 */
+	static size_t skipAlnum(std::string_view text, size_t offset);
+	/**
+	 * @brief Finds the next occurrence of a character
+	 *
+	 * @param text the text to search
+	 * @param offset where to begin searching
+	 * @param c the character to search for
+	 * @return the offset of the first c at or after offset, or text.size() if there is
+	 * none
+	 */
+	static size_t find(std::string_view text, size_t offset, char c);
+
+	static Kernel getKernel();
+	/**
+	 * @brief Overrides the kernel picked at startup, e.g. to compare kernels
+	 *
+	 * @param kernel the kernel to use from now on
+	 * @return false if the CPU does not support kernel, in which case it is not changed
+	 */
+	static bool setKernel(Kernel kernel);
+	static bool isSupported(Kernel kernel);
+};
+
+#endif
@@ -1,51 +1,52 @@
 #include "errorhandler.h"
 
+#include "sourcemanager.h"
 #include "tokens.h"
 
-#include <filesystem>
 #include <iostream>
 #include <string>
 #include <utility>
 #include <vector>
 
-ErrorHandler::Error::Error(std::filesystem::path source, std::string message)
-    : message(std::move(message)), source(std::move(source)) {
+ErrorHandler::Error::Error(FileID source, std::string message, bool hasLocation)
+    : message(std::move(message)), source(source), hasLocation(hasLocation) {
 }
 
 std::string ErrorHandler::Error::toString() {
 	std::stringstream stream;
-	stream << "Error at " << source.string() << ": " << message;
+	stream << "Error at " << SourceManager::getPath(source).string() << ": " << message;
 	return stream.str();
 }
 
-ErrorHandler::ErrorWithLocation::ErrorWithLocation(std::filesystem::path source,
-      size_t row, size_t col, std::string message)
-    : Error(std::move(source), std::move(message)), row(row), col(col) {
+ErrorHandler::ErrorWithLocation::ErrorWithLocation(const Slice &slice,
+      std::string message)
+    : Error(slice.source, std::move(message), true), slice(slice) {
 }
 
 std::string ErrorHandler::ErrorWithLocation::toString() {
 	std::stringstream stream;
-	stream << "Error at " << source.string() << ':' << row << ':' << col << ": "
-	       << message;
+	auto [row, col] = SourceManager::getLocation(source, slice.contents.data());
+	stream << "Error at " << SourceManager::getPath(source).string() << ':' << row << ':'
+	       << col << ": " << message;
 	return stream.str();
 }
 
 void ErrorHandler::error(const Slice &slice, std::string message) {
-	return error(slice.source, slice.row, slice.col, std::move(message));
+	errors.push(std::make_unique<ErrorWithLocation>(slice, std::move(message)));
 }
 
 void ErrorHandler::error(const Token &token, std::string message) {
-	return error(token.s.source, token.s.row, token.s.col, std::move(message));
+	return error(token.s, std::move(message));
 }
 
-void ErrorHandler::error(std::filesystem::path source, size_t row, size_t col,
-      std::string message) {
-	errors.push(std::make_unique<ErrorWithLocation>(std::move(source), row, col,
-	      std::move(message)));
+void ErrorHandler::error(FileID source, std::string message) {
+	errors.push(std::make_unique<Error>(source, std::move(message)));
 }
 
-void ErrorHandler::error(std::filesystem::path source, std::string message) {
-	errors.push(std::make_unique<Error>(std::move(source), std::move(message)));
+void ErrorHandler::append(ErrorHandler &other) {
+	for (; !other.errors.empty(); other.errors.pop()) {
+		errors.push(std::move(other.errors.front()));
+	}
 }
 
 bool ErrorHandler::handleErrors(std::ostream &os) {
@@ -54,8 +55,5 @@ bool ErrorHandler::handleErrors(std::ostream &os) {
 		std::unique_ptr<Error> &e = errors.front();
 		os << e->toString() << std::endl;
 	}
-	if (hasErrors) {
-		exit(EXIT_FAILURE);
-	}
 	return hasErrors;
 }
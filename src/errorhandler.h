@@ -1,10 +1,10 @@
 #ifndef ERRORHANDLER_H
 #define ERRORHANDLER_H
 
+#include "sourcemanager.h"
 #include "tokens.h"
 
 #include <cstdint>
-#include <filesystem>
 #include <memory>
 #include <queue>
 #include <string>
@@ -23,19 +23,24 @@ class ErrorHandler {
 protected:
 	struct Error {
 		std::string message;
-		std::filesystem::path source;
-		Error(std::filesystem::path source, std::string message);
+		FileID source;
+		// Set for an ErrorWithLocation, which cast<> checks in place of RTTI
+		bool hasLocation;
+		Error(FileID source, std::string message, bool hasLocation = false);
 		virtual std::string toString();
 		virtual ~Error() = default;
 	};
 
 	struct ErrorWithLocation : Error {
-		size_t row;
-		size_t col;
-		ErrorWithLocation(std::filesystem::path source, size_t row, size_t col,
-		      std::string message);
+		// The line and column are only looked up when the error is reported
+		Slice slice;
+		ErrorWithLocation(const Slice &slice, std::string message);
 		std::string toString() override;
 		virtual ~ErrorWithLocation() = default;
+
+		static bool classof(const Error *error) {
+			return error->hasLocation;
+		}
 	};
 
 	std::queue<std::unique_ptr<Error>> errors;
@@ -43,9 +48,18 @@ public:
 	ErrorHandler() = default;
 	test_virtual void error(const Slice &slice, std::string message);
 	test_virtual void error(const Token &token, std::string message);
-	test_virtual void error(std::filesystem::path source, size_t row, size_t col,
-	      std::string message);
-	test_virtual void error(std::filesystem::path source, std::string message);
+	test_virtual void error(FileID source, std::string message);
+	/**
+	 * @brief Moves every error reported to another ErrorHandler after the errors reported
+	 * to this one, as though they had been reported here in the same order
+	 */
+	test_virtual void append(ErrorHandler &other);
+	/**
+	 * @brief Reports every error in the order it was reported, then forgets them. Leaves
+	 * it to the caller to stop compiling, since other files may still be compiled
+	 *
+	 * @return whether there were any errors
+	 */
 	test_virtual bool handleErrors(std::ostream &os);
 	test_virtual ~ErrorHandler() = default;
 };
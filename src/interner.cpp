@@ -0,0 +1,78 @@
+#include "interner.h"
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+namespace {
+/**
+ * @brief Hashes the text of an identifier with FNV-1a, which is cheap for the short
+ * names that make up most programs
+ */
+size_t hashName(std::string_view name) {
+	size_t hash = 14695981039346656037ULL;
+	for (char c : name) {
+		hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+	}
+	return hash;
+}
+} // namespace
+
+Interner::Interner() : slots(INITIAL_SLOTS, NO_SYMBOL) {
+}
+
+size_t Interner::probe(std::string_view name, size_t hash) const {
+	const size_t mask = slots.size() - 1;
+	size_t slot = hash & mask;
+	while (slots[slot] != NO_SYMBOL) {
+		SymbolID id = slots[slot];
+		if (hashes[id] == hash && names[id] == name) {
+			break;
+		}
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+void Interner::grow() {
+	slots.assign(slots.size() * 2, NO_SYMBOL);
+	const size_t mask = slots.size() - 1;
+	for (SymbolID id = 0; id < names.size(); id++) {
+		size_t slot = hashes[id] & mask;
+		while (slots[slot] != NO_SYMBOL) {
+			slot = (slot + 1) & mask;
+		}
+		slots[slot] = id;
+	}
+}
+
+SymbolID Interner::intern(std::string_view name) {
+	const size_t hash = hashName(name);
+	size_t slot = probe(name, hash);
+	if (slots[slot] != NO_SYMBOL) {
+		return slots[slot];
+	}
+	char *copy = static_cast<char *>(storage.getResource()->allocate(name.size(), 1));
+	std::memcpy(copy, name.data(), name.size());
+	auto id = static_cast<SymbolID>(names.size());
+	names.emplace_back(copy, name.size());
+	hashes.push_back(hash);
+	slots[slot] = id;
+	// Keeps the table at most half full, so that probes stay short
+	if (names.size() * 2 > slots.size()) {
+		grow();
+	}
+	return id;
+}
+
+SymbolID Interner::find(std::string_view name) const {
+	return slots[probe(name, hashName(name))];
+}
+
+std::string_view Interner::getName(SymbolID id) const {
+	return names[id];
+}
+
+size_t Interner::size() const {
+	return names.size();
+}
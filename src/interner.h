@@ -0,0 +1,84 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include "arena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Identifies a distinct identifier recorded by an Interner
+ *
+ */
+using SymbolID = uint32_t;
+
+/**
+ * @brief Assigns each distinct identifier a dense SymbolID, counting up from 0, so that
+ * later phases can compare identifiers as integers and index tables by them rather than
+ * hashing their text again. The text of each identifier is copied into the Interner the
+ * first time it is seen, so it remains valid after the code it came from. Identifiers are
+ * looked up in an open-addressed table of SymbolIDs, which the lexer probes once for
+ * every Symbol it reads
+ *
+ */
+class Interner {
+	static constexpr size_t INITIAL_SLOTS = 1024;
+	// Holds the text of every identifier
+	Arena storage;
+	// Indexed by SymbolID
+	std::vector<std::string_view> names;
+	std::vector<size_t> hashes;
+	// A power of two in size, with empty slots holding NO_SYMBOL
+	std::vector<SymbolID> slots;
+
+	/**
+	 * @brief Finds the slot which holds an identifier, or the empty slot where it belongs
+	 *
+	 * @param name the text of the identifier
+	 * @param hash the hash of the text
+	 * @return the index of the slot
+	 */
+	size_t probe(std::string_view name, size_t hash) const;
+	/**
+	 * @brief Doubles the number of slots and reinserts every identifier
+	 */
+	void grow();
+public:
+	/**
+	 * @brief Never assigned to an identifier, for use where there is none
+	 */
+	static constexpr SymbolID NO_SYMBOL = UINT32_MAX;
+
+	Interner();
+	Interner(const Interner &) = delete;
+	Interner &operator=(const Interner &) = delete;
+	~Interner() = default;
+
+	/**
+	 * @brief Gets the SymbolID of an identifier, assigning the next one if it is new
+	 *
+	 * @param name the text of the identifier
+	 * @return the SymbolID of the identifier
+	 */
+	SymbolID intern(std::string_view name);
+	/**
+	 * @brief Gets the SymbolID of an identifier without assigning one
+	 *
+	 * @param name the text of the identifier
+	 * @return the SymbolID of the identifier, or NO_SYMBOL if it has not been interned
+	 */
+	SymbolID find(std::string_view name) const;
+	/**
+	 * @brief Gets the text of an interned identifier, which lives as long as the Interner
+	 */
+	std::string_view getName(SymbolID id) const;
+	/**
+	 * @brief Gets how many distinct identifiers have been interned, which is one more
+	 * than the largest SymbolID
+	 */
+	size_t size() const;
+};
+
+#endif
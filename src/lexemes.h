@@ -0,0 +1,166 @@
+#ifndef LEXEMES_H
+#define LEXEMES_H
+
+#include "tokens.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief A fixed spelling and the token it always lexes to
+ *
+ */
+struct Lexeme {
+	std::string_view spelling;
+	TokenKind kind;
+	uint8_t subtype;
+	uint64_t value;
+
+	constexpr Lexeme(std::string_view spelling, Keyword::Type type)
+	    : spelling(spelling), kind(TokenKind::Keyword), subtype(type), value(0) {
+	}
+
+	constexpr Lexeme(std::string_view spelling, Punctuation::Type type)
+	    : spelling(spelling), kind(TokenKind::Punctuation),
+	      subtype(static_cast<uint8_t>(type)), value(0) {
+	}
+
+	constexpr Lexeme(std::string_view spelling, Operator::Type type)
+	    : spelling(spelling), kind(TokenKind::Operator),
+	      subtype(static_cast<uint8_t>(type)), value(0) {
+	}
+
+	constexpr Lexeme(std::string_view spelling, bool value)
+	    : spelling(spelling), kind(TokenKind::BoolLiteral), subtype(0), value(value) {
+	}
+};
+
+/**
+ * @brief Recognizes every keyword, boolean literal, punctuation character, and
+ * two-character operator of Canyon with a perfect hash that is generated at compile time
+ * from the single list below. Adding a new lexeme only requires adding it to the list,
+ * unless another lexeme has the same length and the same first, middle, and last
+ * characters, which no seed can tell apart and which fails the build
+ *
+ */
+class LexemeTable {
+	static constexpr std::array LEXEMES = {
+	      Lexeme{"return", Keyword::Type::RETURN},
+	      Lexeme{"let", Keyword::Type::LET},
+	      Lexeme{"fun", Keyword::Type::FUN},
+	      Lexeme{"if", Keyword::Type::IF},
+	      Lexeme{"else", Keyword::Type::ELSE},
+	      Lexeme{"while", Keyword::Type::WHILE},
+	      Lexeme{"true", true},
+	      Lexeme{"false", false},
+	      Lexeme{"(", Punctuation::Type::OpenParen},
+	      Lexeme{")", Punctuation::Type::CloseParen},
+	      Lexeme{";", Punctuation::Type::Semicolon},
+	      Lexeme{"{", Punctuation::Type::OpenBrace},
+	      Lexeme{"}", Punctuation::Type::CloseBrace},
+	      Lexeme{".", Punctuation::Type::Period},
+	      Lexeme{",", Punctuation::Type::Comma},
+	      Lexeme{":", Punctuation::Type::Colon},
+	      Lexeme{"=", Operator::Type::Assignment},
+	      Lexeme{"+", Operator::Type::Addition},
+	      Lexeme{"-", Operator::Type::Subtraction},
+	      Lexeme{"*", Operator::Type::Multiplication},
+	      Lexeme{"/", Operator::Type::Division},
+	      Lexeme{"%", Operator::Type::Modulus},
+	      Lexeme{"!", Operator::Type::LogicalNot},
+	      Lexeme{"<", Operator::Type::LessThan},
+	      Lexeme{">", Operator::Type::GreaterThan},
+	      Lexeme{"&", Operator::Type::BitwiseAnd},
+	      Lexeme{"|", Operator::Type::BitwiseOr},
+	      Lexeme{"~", Operator::Type::BitwiseNot},
+	      Lexeme{"^", Operator::Type::BitwiseXor},
+	      Lexeme{"==", Operator::Type::Equality},
+	      Lexeme{"::", Operator::Type::Scope},
+	      Lexeme{"!=", Operator::Type::Inequality},
+	      Lexeme{"<=", Operator::Type::LessThanOrEqual},
+	      Lexeme{"<<", Operator::Type::BitwiseShiftLeft},
+	      Lexeme{">=", Operator::Type::GreaterThanOrEqual},
+	      Lexeme{">>", Operator::Type::BitwiseShiftRight},
+	      Lexeme{"&&", Operator::Type::LogicalAnd},
+	      Lexeme{"||", Operator::Type::LogicalOr},
+	};
+	static constexpr size_t BITS = 8;
+	static constexpr size_t SLOTS = size_t{1} << BITS;
+	static_assert(LEXEMES.size() < SLOTS / 2, "Too many lexemes for the hash table");
+
+	/**
+	 * @brief Hashes the length and the first, middle, and last characters of text, which
+	 * tell every lexeme apart once mixed by a suitable seed
+	 */
+	static constexpr size_t hash(std::string_view text, uint32_t seed) {
+		auto middle = static_cast<uint8_t>(text[text.size() / 2]);
+		uint32_t key = static_cast<uint8_t>(text.front())
+		               | (static_cast<uint32_t>(static_cast<uint8_t>(text.back())) << 8)
+		               | (static_cast<uint32_t>(middle) << 16)
+		               | (static_cast<uint32_t>(text.size()) << 24);
+		return (key * seed) >> (32 - BITS);
+	}
+
+	/**
+	 * @brief Tries odd multiples of the golden ratio as multipliers until no two lexemes
+	 * hash to the same slot
+	 *
+	 * @return the multiplier, or 0 if none was found
+	 */
+	static constexpr uint32_t findSeed() {
+		constexpr uint32_t GOLDEN = 0x9E3779B1;
+		constexpr uint32_t ATTEMPTS = 1 << 12;
+		uint32_t seed = GOLDEN;
+		for (uint32_t attempt = 0; attempt < ATTEMPTS; attempt++, seed += 2 * GOLDEN) {
+			std::array<bool, SLOTS> used{};
+			bool collision = false;
+			for (const Lexeme &lexeme : LEXEMES) {
+				size_t slot = hash(lexeme.spelling, seed);
+				collision = collision || used[slot];
+				used[slot] = true;
+			}
+			if (!collision) {
+				return seed;
+			}
+		}
+		return 0;
+	}
+
+	static const uint32_t SEED;
+	// Each slot holds one more than the index of the lexeme which hashes to it, or 0
+	static const std::array<uint8_t, SLOTS> slots;
+public:
+	/**
+	 * @brief Looks up a lexeme in a constant number of steps
+	 *
+	 * @param text the characters of a token
+	 * @return the lexeme spelled exactly as text, or nullptr if there is none
+	 */
+	static constexpr const Lexeme *find(std::string_view text);
+};
+
+inline constexpr uint32_t LexemeTable::SEED = LexemeTable::findSeed();
+
+inline constexpr std::array<uint8_t, LexemeTable::SLOTS> LexemeTable::slots = []() {
+	static_assert(SEED != 0, "No perfect hash was found for the lexemes");
+	std::array<uint8_t, SLOTS> slots{};
+	for (size_t i = 0; i < LEXEMES.size(); i++) {
+		slots[hash(LEXEMES[i].spelling, SEED)] = static_cast<uint8_t>(i + 1);
+	}
+	return slots;
+}();
+
+constexpr const Lexeme *LexemeTable::find(std::string_view text) {
+	if (text.empty()) {
+		return nullptr;
+	}
+	uint8_t slot = slots[hash(text, SEED)];
+	if (slot == 0 || LEXEMES[slot - 1].spelling != text) {
+		return nullptr;
+	}
+	return &LEXEMES[slot - 1];
+}
+
+#endif
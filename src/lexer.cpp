@@ -1,11 +1,24 @@
 #include "lexer.h"
 
+#include "charclass.h"
+#include "interner.h"
+#include "lexemes.h"
+#include "sourcemanager.h"
+#include "threadpool.h"
+#include "tokenbuffer.h"
+#include "tokens.h"
+
+#include <algorithm>
+#include <array>
 #include <cctype>
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
-#include <memory>
+#include <optional>
 #include <stdexcept>
+#include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 static constexpr int DECIMAL = 10;
@@ -14,12 +27,20 @@ static constexpr int OCTAL = 8;
 static constexpr int BINARY = 2;
 
 Lexer::Lexer(std::string_view program, std::filesystem::path source,
-      ErrorHandler *errorHandler, uint32_t tabSize)
-    : program(program), source(std::move(source)), tabSize(tabSize),
-      errorHandler(errorHandler) {
+      ErrorHandler *errorHandler, uint32_t tabSize, ThreadPool *threadPool)
+    : program(program), errorHandler(errorHandler), threadPool(threadPool) {
 	if (tabSize == 0) {
 		throw std::invalid_argument("Tab size must be greater than 0");
 	}
+	// TokenBuffer stores offsets into the source code as 32 bits
+	if (program.size() > UINT32_MAX) {
+		throw std::invalid_argument("Source code must be smaller than 4 GiB");
+	}
+	this->source = SourceManager::addFile(std::move(source), program, tabSize);
+}
+
+Lexer::Lexer(std::string_view program, FileID source, ErrorHandler *errorHandler)
+    : program(program), source(source), errorHandler(errorHandler) {
 }
 
 Lexer &Lexer::operator=(const Lexer &l) {
@@ -29,503 +50,261 @@ Lexer &Lexer::operator=(const Lexer &l) {
 	program = l.program;
 	current = l.current;
 	source = l.source;
-	tabSize = l.tabSize;
 	errorHandler = l.errorHandler;
-	line = l.line;
-	col = l.col;
+	threadPool = l.threadPool;
 	return *this;
 }
 
-std::vector<std::unique_ptr<Token>> Lexer::lex() {
-	return evaluate(scan());
-}
-
-std::vector<std::unique_ptr<Token>> Lexer::scan() {
-	slice();
+TokenBuffer Lexer::lex() {
+	TokenBuffer tokens(program, source);
+	literalErrors.clear();
+	std::vector<size_t> splits;
+	if (threadPool != nullptr && threadPool->size() > 1) {
+		splits = findSplits(threadPool->countRuns(program.size() / MIN_CHUNK_SIZE));
+	}
+	if (splits.size() > 1) {
+		lexChunks(tokens, splits);
+	} else {
+		// Most tokens in typical code are a few characters long, and followed by
+		// whitespace
+		tokens.reserve(program.size() / 4 + 1);
+		lexTokens(tokens);
+	}
 
-	std::vector<std::unique_ptr<Token>> tokens;
-	while (!slices.empty()) {
-		auto s = slices.front();
-		slices.pop();
-		std::unique_ptr<Whitespace> whitespace = createWhitespace(s);
-		if (whitespace != nullptr) {
-			tokens.push_back(std::move(whitespace));
-			continue;
-		}
-		std::unique_ptr<Keyword> keyword = createKeyword(s);
-		if (keyword != nullptr) {
-			tokens.push_back(std::move(keyword));
-			continue;
-		}
-		std::unique_ptr<Punctuation> punctuation = createPunctuation(s);
-		if (punctuation != nullptr) {
-			tokens.push_back(std::move(punctuation));
-			continue;
-		}
-		tokens.push_back(createSymbolOrLiteral(s));
+	// Malformed literals are only reported once the structure of the whole source is
+	// known, after any unterminated comment or character literal
+	for (const auto &[slice, message] : literalErrors) {
+		errorHandler->error(slice, std::string(message));
 	}
+	literalErrors.clear();
 
-	tokens.push_back(std::make_unique<EndOfFile>(Slice("", source, line, col)));
+	tokens.push(TokenKind::EndOfFile, 0, program.size(), 0, 0);
 
 	return tokens;
 }
 
-void Lexer::slice() {
+void Lexer::lexTokens(TokenBuffer &tokens) {
+	// The previous token's character if it was a single punctuation which may still
+	// combine with the next one. Block comments may separate the two, whitespace may not
+	char combinable = '\0';
 	while (current < program.size()) {
-		while (std::isspace(program[current]) != 0) {
-			if (program[current] == '\n') {
-				slices.emplace(std::string_view(program).substr(current, 1), source, line,
-				      col);
-				line++;
-				col = 1;
-			} else if (program[current] == '\r') {
-				if (current + 1 < program.size() && program[current + 1] == '\n') {
-					slices.emplace(std::string_view(program).substr(current, 2), source,
-					      line, col);
-					current++;
-					line++;
-					col = 1;
-				} else {
-					slices.emplace(std::string_view(program).substr(current, 1), source,
-					      line, col);
-					line++;
-					col = 1;
-				}
-			} else if (program[current] == '\t') {
-				slices.emplace(std::string_view(program).substr(current, 1), source, line,
-				      col);
-				col = ((col + tabSize - 1) / tabSize) * tabSize + 1;
-			} else {
-				if (std::isspace(program[current]) != 0) {
-					slices.emplace(std::string_view(program).substr(current, 1), source,
-					      line, col);
-				}
-				col++;
-			}
-			if (++current >= program.size()) {
-				break;
-			}
-		}
-		if (current >= program.size()) {
-			break;
+		const char c = program[current];
+		if (CharClass::isSpace(c)) {
+			current = CharClass::skipSpace(program, current);
+			combinable = '\0';
+			continue;
 		}
-
-		if (program[current] == '/' && current + 1 < program.size()
-		      && program[current + 1] == '/') {
-			do {
-				current++;
-				col++;
-			} while (current < program.size() && program[current] != '\n');
+		if (c == '/' && current + 1 < program.size() && program[current + 1] == '/') {
+			skipLineComment();
 			continue;
 		}
-		if (program[current] == '/' && current + 1 < program.size()
-		      && program[current + 1] == '*') {
-			size_t startLine = line;
-			size_t startCol = col;
-			do {
-				if (program[current] == '\n') {
-					line++;
-					col = 1;
-				}
-				if (program[current] == '\r') {
-					if (current + 1 < program.size() && program[current + 1] == '\n') {
-						current++;
-						line++;
-						col = 1;
-					} else {
-						line++;
-						col = 1;
-					}
-				}
-				current++;
-				col++;
-			} while (current + 1 < program.size()
-			         && (program[current] != '*' || program[current + 1] != '/'));
-			if (current + 1 >= program.size()) {
-				errorHandler->error(Slice(std::string_view(program).substr(current,
-				                                program.size() - current),
-				                          source, startLine, startCol),
-				      "Unterminated block comment");
+		if (c == '/' && current + 1 < program.size() && program[current + 1] == '*') {
+			if (!skipBlockComment()) {
 				break;
 			}
-			current += 2;
-			col += 2;
 			continue;
 		}
 
 		size_t tokenStart = current;
-		size_t startCol = col;
-		if (program[current] == '\'') {
-			do {
-				if (program[current] == '\\') {
-					current++;
-					col++;
-				}
-				current++;
-				col++;
-			} while (current < program.size() && program[current] != '\'');
-			if (current >= program.size()) {
-				errorHandler->error(Slice(std::string_view(program).substr(tokenStart,
-				                                current - tokenStart),
-				                          source, line, startCol),
-				      "Unterminated character literal");
+		if (c == '\'') {
+			if (!skipCharacterLiteral(tokenStart)) {
 				break;
 			}
-			current++;
-			col++;
 		} else {
-			do {
-				current++;
-				col++;
-			} while (current < program.size() && !isSep(current));
+			skipWord();
+		}
+
+		const Lexeme *lexeme
+		      = LexemeTable::find(program.substr(tokenStart, current - tokenStart));
+		if (lexeme == nullptr) {
+			pushWord(tokens, tokenStart);
+			combinable = '\0';
+			continue;
+		}
+		// Only single punctuation characters may combine into a two-character Operator
+		bool punctuation
+		      = lexeme->kind == TokenKind::Punctuation || lexeme->kind == TokenKind::Operator;
+		if (!punctuation) {
+			pushLexeme(tokens, tokenStart, *lexeme);
+			combinable = '\0';
+			continue;
+		}
+		const Lexeme *combined = combinePunctuation(combinable, c);
+		if (combined != nullptr) {
+			tokens.replaceLast(combined->kind, combined->subtype, current);
+			combinable = '\0';
+		} else {
+			pushLexeme(tokens, tokenStart, *lexeme);
+			combinable = c;
 		}
-		slices.emplace(std::string_view(program).substr(tokenStart, current - tokenStart),
-		      source, line, startCol);
 	}
 }
 
-bool Lexer::isSep(size_t offset) {
-	// If c is any of these characters, it is by default a separator
-	if (std::isspace(program[offset]) != 0 || program[offset] == '('
-	      || program[offset] == ')' || program[offset] == ';' || program[offset] == '{'
-	      || program[offset] == '}' || program[offset] == '.' || program[offset] == ','
-	      || program[offset] == '+' || program[offset] == '-' || program[offset] == '*'
-	      || program[offset] == '/' || program[offset] == '%' || program[offset] == '='
-	      || program[offset] == ':' || program[offset] == '!' || program[offset] == '<'
-	      || program[offset] == '>' || program[offset] == '&' || program[offset] == '|'
-	      || program[offset] == '~' || program[offset] == '^'
-	      || program[offset] == '\'') {
-		return true;
+std::vector<size_t> Lexer::findSplits(size_t chunks) const {
+	std::vector<size_t> splits = {0};
+	if (chunks < 2) {
+		return splits;
+	}
+	const size_t chunkSize = program.size() / chunks;
+	size_t i = 0;
+	while (i < program.size() && splits.size() < chunks) {
+		const char c = program[i];
+		if (c == '\n') {
+			i++;
+			if (i - splits.back() >= chunkSize && program.compare(i, 3, "fun") == 0
+			      && i + 3 < program.size() && CharClass::isSpace(program[i + 3])) {
+				splits.push_back(i);
+			}
+		} else if (c == '/' && i + 1 < program.size() && program[i + 1] == '/') {
+			i = CharClass::find(program, i, '\n');
+		} else if (c == '/' && i + 1 < program.size() && program[i + 1] == '*') {
+			size_t star = CharClass::find(program, i + 1, '*');
+			while (star + 1 < program.size() && program[star + 1] != '/') {
+				star = CharClass::find(program, star + 1, '*');
+			}
+			i = star + 2;
+		} else if (c == '\'') {
+			do {
+				if (program[i] == '\\') {
+					i++;
+				}
+				i++;
+			} while (i < program.size() && program[i] != '\'');
+			i++;
+		} else {
+			i++;
+		}
 	}
+	return splits;
+}
+
+void Lexer::lexChunks(TokenBuffer &tokens, const std::vector<size_t> &splits) {
+	const size_t chunks = splits.size();
+	// Each chunk has its own Interner, whose SymbolIDs are remapped when it is appended
+	std::vector<TokenBuffer> chunkTokens;
+	chunkTokens.reserve(chunks);
+	for (size_t chunk = 0; chunk < chunks; chunk++) {
+		chunkTokens.emplace_back(program, source);
+	}
+	std::vector<ErrorHandler> chunkErrors(chunks);
+	std::vector<decltype(literalErrors)> chunkLiteralErrors(chunks);
+	threadPool->forEach(chunks, [&](size_t chunk) {
+		// Each chunk ends where the next begins, so that no Slice reaches past it, and
+		// is lexed in place so that every offset and Slice is the same as in sequence
+		size_t end = chunk + 1 < chunks ? splits[chunk + 1] : program.size();
+		Lexer lexer(program.substr(0, end), source, &chunkErrors[chunk]);
+		lexer.current = splits[chunk];
+		chunkTokens[chunk].reserve((end - splits[chunk]) / 4 + 1);
+		lexer.lexTokens(chunkTokens[chunk]);
+		chunkLiteralErrors[chunk] = std::move(lexer.literalErrors);
+	});
+	current = program.size();
 
-	// If c is alnum, it is sep as long as prev is not alnum
-	if (std::isalnum(program[offset]) != 0 && std::isalnum(program[offset - 1]) == 0) {
-		return true;
+	size_t total = 1;
+	for (const TokenBuffer &buffer : chunkTokens) {
+		total += buffer.size();
+	}
+	tokens.reserve(total);
+	for (size_t chunk = 0; chunk < chunks; chunk++) {
+		tokens.append(chunkTokens[chunk]);
+		// Only the last chunk can end in an unterminated comment or character literal,
+		// which consumes the rest of the program
+		errorHandler->append(chunkErrors[chunk]);
+		literalErrors.insert(literalErrors.end(), chunkLiteralErrors[chunk].begin(),
+		      chunkLiteralErrors[chunk].end());
 	}
+}
 
-	return false;
+void Lexer::skipLineComment() {
+	current = CharClass::find(program, current, '\n');
+}
+
+bool Lexer::skipBlockComment() {
+	size_t commentStart = current;
+	// The star of the opening slash-star may also begin the closing star-slash
+	size_t star = CharClass::find(program, current + 1, '*');
+	while (star + 1 < program.size() && program[star + 1] != '/') {
+		star = CharClass::find(program, star + 1, '*');
+	}
+	if (star + 1 >= program.size()) {
+		errorHandler->error(Slice(program.substr(commentStart), source),
+		      "Unterminated block comment");
+		current = program.size();
+		return false;
+	}
+	current = star + 2;
+	return true;
 }
 
-std::unique_ptr<Whitespace> Lexer::createWhitespace(const Slice &s) {
-	for (char c : s.contents) {
-		if (std::isspace(c) == 0) {
-			return nullptr;
+bool Lexer::skipCharacterLiteral(size_t tokenStart) {
+	do {
+		if (program[current] == '\\') {
+			current++;
 		}
-	}
-	return std::make_unique<Whitespace>(s);
+		current++;
+	} while (current < program.size() && program[current] != '\'');
+	if (current >= program.size()) {
+		errorHandler->error(
+		      Slice(program.substr(tokenStart, current - tokenStart), source),
+		      "Unterminated character literal");
+		return false;
+	}
+	current++;
+	return true;
 }
 
-std::unique_ptr<Keyword> Lexer::createKeyword(const Slice &s) {
-	if (s.contents == "return") {
-		return std::make_unique<Keyword>(s, Keyword::Type::RETURN);
-	}
-	if (s.contents == "let") {
-		return std::make_unique<Keyword>(s, Keyword::Type::LET);
-	}
-	if (s.contents == "fun") {
-		return std::make_unique<Keyword>(s, Keyword::Type::FUN);
-	}
-	if (s.contents == "if") {
-		return std::make_unique<Keyword>(s, Keyword::Type::IF);
-	}
-	if (s.contents == "else") {
-		return std::make_unique<Keyword>(s, Keyword::Type::ELSE);
+void Lexer::skipWord() {
+	const char first = program[current];
+	current++;
+	if (CharClass::isAlnum(first)) {
+		current = CharClass::skipAlnum(program, current);
 	}
-	if (s.contents == "while") {
-		return std::make_unique<Keyword>(s, Keyword::Type::WHILE);
+	// Characters which are neither separators nor alphanumeric continue any word, but a
+	// letter or digit after one of them begins a new word
+	while (current < program.size() && CharClass::isOther(program[current])) {
+		current++;
 	}
-	return nullptr;
 }
 
-std::unique_ptr<Punctuation> Lexer::createPunctuation(const Slice &s) {
-	if (s.contents == "(") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen);
-	}
-	if (s.contents == ")") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen);
-	}
-	if (s.contents == ";") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::Semicolon);
-	}
-	if (s.contents == "{") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace);
-	}
-	if (s.contents == "}") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace);
-	}
-	if (s.contents == ".") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::Period);
-	}
-	if (s.contents == ",") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::Comma);
-	}
-	if (s.contents == "=") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::Equals);
-	}
-	if (s.contents == ":") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::Colon);
-	}
-	if (s.contents == "+") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::Plus);
-	}
-	if (s.contents == "-") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::Hyphen);
-	}
-	if (s.contents == "*") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::Asterisk);
-	}
-	if (s.contents == "/") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::ForwardSlash);
-	}
-	if (s.contents == "%") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::Percent);
-	}
-	if (s.contents == "!") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::Exclamation);
-	}
-	if (s.contents == "<") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::LessThan);
-	}
-	if (s.contents == ">") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::GreaterThan);
-	}
-	if (s.contents == "&") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::Ampersand);
-	}
-	if (s.contents == "|") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::VerticalBar);
-	}
-	if (s.contents == "~") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::Tilde);
-	}
-	if (s.contents == "^") {
-		return std::make_unique<Punctuation>(s, Punctuation::Type::Caret);
-	}
-	return nullptr;
+void Lexer::pushLexeme(TokenBuffer &tokens, size_t offset, const Lexeme &lexeme) {
+	tokens.push(lexeme.kind, lexeme.subtype, offset, lexeme.spelling.size(),
+	      lexeme.value);
 }
 
-std::unique_ptr<SymbolOrLiteral> Lexer::createSymbolOrLiteral(const Slice &s) {
-	return std::make_unique<SymbolOrLiteral>(s);
+const Lexeme *Lexer::combinePunctuation(char first, char second) {
+	if (first == '\0') {
+		return nullptr;
+	}
+	const std::array<char, 2> pair = {first, second};
+	return LexemeTable::find(std::string_view(pair.data(), pair.size()));
 }
 
-std::vector<std::unique_ptr<Token>> Lexer::evaluate(
-      std::vector<std::unique_ptr<Token>> tokens) {
-	size_t i = 0;
-	std::unique_ptr<Token> token = std::move(tokens[i]);
-	std::vector<std::unique_ptr<Token>> evaluated;
-	while (!dynamic_cast<EndOfFile *>(token.get())) {
-		if (dynamic_cast<Keyword *>(token.get())) {
-			evaluated.push_back(std::move(token));
-		} else if (dynamic_cast<Punctuation *>(token.get())) {
-			switch (dynamic_cast<Punctuation *>(token.get())->type) {
-				case Punctuation::Type::OpenParen:
-				case Punctuation::Type::CloseParen:
-				case Punctuation::Type::Semicolon:
-				case Punctuation::Type::OpenBrace:
-				case Punctuation::Type::CloseBrace:
-				case Punctuation::Type::Period:
-				case Punctuation::Type::Comma: {
-					evaluated.push_back(std::move(token));
-					break;
-				}
-				case Punctuation::Type::Equals: {
-					Token *next = tokens[i + 1].get();
-					if (dynamic_cast<Punctuation *>(next)
-					      && dynamic_cast<Punctuation *>(next)->type
-					               == Punctuation::Type::Equals) {
-						token->s.contents = "==";
-						evaluated.push_back(std::make_unique<Operator>(*token,
-						      Operator::Type::Equality));
-						i++;
-					} else {
-						evaluated.push_back(std::make_unique<Operator>(*token,
-						      Operator::Type::Assignment));
-					}
-					break;
-				}
-				case Punctuation::Type::Colon: {
-					Token *next = tokens[i + 1].get();
-					if (dynamic_cast<Punctuation *>(next)
-					      && dynamic_cast<Punctuation *>(next)->type
-					               == Punctuation::Type::Colon) {
-						token->s.contents = "::";
-						evaluated.push_back(
-						      std::make_unique<Operator>(*token, Operator::Type::Scope));
-						i++;
-					} else {
-						evaluated.push_back(std::move(token));
-					}
-					break;
-				}
-				case Punctuation::Type::Plus: {
-					evaluated.push_back(
-					      std::make_unique<Operator>(*token, Operator::Type::Addition));
-					break;
-				}
-				case Punctuation::Type::Hyphen: {
-					evaluated.push_back(std::make_unique<Operator>(*token,
-					      Operator::Type::Subtraction));
-					break;
-				}
-				case Punctuation::Type::Asterisk: {
-					evaluated.push_back(std::make_unique<Operator>(*token,
-					      Operator::Type::Multiplication));
-					break;
-				}
-				case Punctuation::Type::ForwardSlash: {
-					evaluated.push_back(
-					      std::make_unique<Operator>(*token, Operator::Type::Division));
-					break;
-				}
-				case Punctuation::Type::Percent: {
-					evaluated.push_back(
-					      std::make_unique<Operator>(*token, Operator::Type::Modulus));
-					break;
-				}
-				case Punctuation::Type::Exclamation: {
-					Token *next = tokens[i + 1].get();
-					if (dynamic_cast<Punctuation *>(next)
-					      && dynamic_cast<Punctuation *>(next)->type
-					               == Punctuation::Type::Equals) {
-						token->s.contents = "!=";
-						evaluated.push_back(std::make_unique<Operator>(*token,
-						      Operator::Type::Inequality));
-						i++;
-					} else {
-						evaluated.push_back(std::make_unique<Operator>(*token,
-						      Operator::Type::LogicalNot));
-					}
-					break;
-				}
-				case Punctuation::Type::LessThan: {
-					Token *next = tokens[i + 1].get();
-					if (dynamic_cast<Punctuation *>(next)
-					      && dynamic_cast<Punctuation *>(next)->type
-					               == Punctuation::Type::Equals) {
-						token->s.contents = "<=";
-						evaluated.push_back(std::make_unique<Operator>(*token,
-						      Operator::Type::LessThanOrEqual));
-						i++;
-					} else if (dynamic_cast<Punctuation *>(next)
-					           && dynamic_cast<Punctuation *>(next)->type
-					                    == Punctuation::Type::LessThan) {
-						token->s.contents = "<<";
-						evaluated.push_back(std::make_unique<Operator>(*token,
-						      Operator::Type::BitwiseShiftLeft));
-						i++;
-					} else {
-						evaluated.push_back(std::make_unique<Operator>(*token,
-						      Operator::Type::LessThan));
-					}
-					break;
-				}
-				case Punctuation::Type::GreaterThan: {
-					Token *next = tokens[i + 1].get();
-					if (dynamic_cast<Punctuation *>(next)
-					      && dynamic_cast<Punctuation *>(next)->type
-					               == Punctuation::Type::Equals) {
-						token->s.contents = ">=";
-						evaluated.push_back(std::make_unique<Operator>(*token,
-						      Operator::Type::GreaterThanOrEqual));
-						i++;
-					} else if (dynamic_cast<Punctuation *>(next)
-					           && dynamic_cast<Punctuation *>(next)->type
-					                    == Punctuation::Type::GreaterThan) {
-						token->s.contents = ">>";
-						evaluated.push_back(std::make_unique<Operator>(*token,
-						      Operator::Type::BitwiseShiftRight));
-						i++;
-					} else {
-						evaluated.push_back(std::make_unique<Operator>(*token,
-						      Operator::Type::GreaterThan));
-					}
-					break;
-				}
-				case Punctuation::Type::Ampersand: {
-					Token *next = tokens[i + 1].get();
-					if (dynamic_cast<Punctuation *>(next)
-					      && dynamic_cast<Punctuation *>(next)->type
-					               == Punctuation::Type::Ampersand) {
-						token->s.contents = "&&";
-						evaluated.push_back(std::make_unique<Operator>(*token,
-						      Operator::Type::LogicalAnd));
-						i++;
-					} else {
-						evaluated.push_back(std::make_unique<Operator>(*token,
-						      Operator::Type::BitwiseAnd));
-					}
-					break;
-				}
-				case Punctuation::Type::VerticalBar: {
-					Token *next = tokens[i + 1].get();
-					if (dynamic_cast<Punctuation *>(next)
-					      && dynamic_cast<Punctuation *>(next)->type
-					               == Punctuation::Type::VerticalBar) {
-						token->s.contents = "||";
-						evaluated.push_back(std::make_unique<Operator>(*token,
-						      Operator::Type::LogicalOr));
-						i++;
-					} else {
-						evaluated.push_back(std::make_unique<Operator>(*token,
-						      Operator::Type::BitwiseOr));
-					}
-					break;
-				}
-				case Punctuation::Type::Tilde: {
-					evaluated.push_back(
-					      std::make_unique<Operator>(*token, Operator::Type::BitwiseNot));
-					break;
-				}
-				case Punctuation::Type::Caret: {
-					evaluated.push_back(
-					      std::make_unique<Operator>(*token, Operator::Type::BitwiseXor));
-					break;
-				}
-			}
-		} else if (dynamic_cast<SymbolOrLiteral *>(token.get())) {
-			if (std::isdigit(dynamic_cast<SymbolOrLiteral *>(token.get())->s.contents[0])
-			      != 0) {
-				std::unique_ptr<Token> literal = evaluateIntegerLiteral(
-				      dynamic_cast<SymbolOrLiteral *>(token.get()));
-				if (literal == nullptr) {
-					errorHandler->error(*token, "Invalid integer literal");
-					evaluated.push_back(std::move(token));
-				} else {
-					evaluated.push_back(std::move(literal));
-				}
-			} else if (dynamic_cast<SymbolOrLiteral *>(token.get())->s.contents[0]
-			           == '\'') {
-				std::unique_ptr<Token> literal = evaluateCharacterLiteral(
-				      dynamic_cast<SymbolOrLiteral *>(token.get()));
-				if (literal == nullptr) {
-					errorHandler->error(*token, "Invalid character literal");
-					evaluated.push_back(std::move(token));
-				} else {
-					evaluated.push_back(std::move(literal));
-				}
-			} else if (dynamic_cast<SymbolOrLiteral *>(token.get())->s.contents
-			           == "true") {
-				evaluated.push_back(std::make_unique<BoolLiteral>(
-				      *dynamic_cast<SymbolOrLiteral *>(token.get()), true));
-			} else if (dynamic_cast<SymbolOrLiteral *>(token.get())->s.contents
-			           == "false") {
-				evaluated.push_back(std::make_unique<BoolLiteral>(
-				      *dynamic_cast<SymbolOrLiteral *>(token.get()), false));
-			} else {
-				evaluated.push_back(std::make_unique<Symbol>(
-				      dynamic_cast<SymbolOrLiteral *>(token.get())));
-			}
-		} else if (dynamic_cast<Whitespace *>(token.get())) {
-			// Ignore whitespace
-		} else {
-			std::cerr << "Unknown token type\n";
-			exit(EXIT_FAILURE);
+void Lexer::pushWord(TokenBuffer &tokens, size_t offset) {
+	std::string_view word = program.substr(offset, current - offset);
+	auto push = [&](TokenKind kind, uint8_t subtype, uint64_t value) {
+		tokens.push(kind, subtype, offset, word.size(), value);
+	};
+	if (CharClass::isDigit(word[0])) {
+		std::optional<std::pair<IntegerLiteral::Type, uint64_t>> literal
+		      = evaluateIntegerLiteral(word);
+		if (!literal.has_value()) {
+			literalErrors.emplace_back(Slice(word, source),
+			      "Invalid integer literal");
+			return push(TokenKind::SymbolOrLiteral, 0, 0);
 		}
-		i++;
-		token = std::move(tokens[i]);
+		return push(TokenKind::IntegerLiteral, static_cast<uint8_t>(literal->first),
+		      literal->second);
+	}
+	if (word[0] == '\'') {
+		std::optional<char> literal = evaluateCharacterLiteral(word);
+		if (!literal.has_value()) {
+			literalErrors.emplace_back(Slice(word, source),
+			      "Invalid character literal");
+			return push(TokenKind::SymbolOrLiteral, 0, 0);
+		}
+		return push(TokenKind::CharacterLiteral, 0, static_cast<uint8_t>(*literal));
 	}
-	evaluated.push_back(std::move(token));
-	return evaluated;
+	return push(TokenKind::Symbol, 0, tokens.getInterner()->intern(word));
 }
 
 bool Lexer::isDigitInBase(char c, int base) {
@@ -544,33 +323,34 @@ bool Lexer::isDigitInBase(char c, int base) {
 	return false;
 }
 
-std::unique_ptr<IntegerLiteral> Lexer::evaluateIntegerLiteral(SymbolOrLiteral *literal) {
+std::optional<std::pair<IntegerLiteral::Type, uint64_t>> Lexer::evaluateIntegerLiteral(
+      std::string_view literal) {
 	int base = DECIMAL;
 	size_t start = 0;
 	size_t pos = 0;
-	for (size_t i = 0; i < literal->s.contents.size(); i++) {
-		if (!isDigitInBase(literal->s.contents[i], base)) {
+	for (size_t i = 0; i < literal.size(); i++) {
+		if (!isDigitInBase(literal[i], base)) {
 			if (i == 1) {
-				if (literal->s.contents[0] == '0') {
-					if (literal->s.contents[1] == 'x') {
+				if (literal[0] == '0') {
+					if (literal[1] == 'x') {
 						base = HEXADECIMAL;
 						start = 2;
 						continue;
 					}
-					if (literal->s.contents[1] == 'o') {
+					if (literal[1] == 'o') {
 						base = OCTAL;
 						start = 2;
 						continue;
 					}
-					if (literal->s.contents[1] == 'b') {
+					if (literal[1] == 'b') {
 						base = BINARY;
 						start = 2;
 						continue;
 					}
 				}
 			}
-			std::string_view suffix = literal->s.contents.substr(i);
-			std::string_view value = literal->s.contents.substr(start, i);
+			std::string_view suffix = literal.substr(i);
+			std::string_view value = literal.substr(start, i);
 			// Inspired by Rust - parse all integers as u128 (here, u64 since no support
 			// for 128bit at the moment) and then when we build the AST we will convert to
 			// the proper sized type
@@ -579,125 +359,113 @@ std::unique_ptr<IntegerLiteral> Lexer::evaluateIntegerLiteral(SymbolOrLiteral *l
 			if (suffix == "i8") {
 				uint64_t intValue = std::stoul(std::string(value), &pos, base);
 				if (pos != i - start) {
-					return nullptr;
+					return std::nullopt;
 				}
-				return std::make_unique<IntegerLiteral>(*literal,
-				      IntegerLiteral::Type::I8, intValue);
+				return std::pair(IntegerLiteral::Type::I8, intValue);
 			}
 			if (suffix == "i16") {
 				uint64_t intValue = std::stoul(std::string(value), &pos, base);
 				if (pos != i - start) {
-					return nullptr;
+					return std::nullopt;
 				}
-				return std::make_unique<IntegerLiteral>(*literal,
-				      IntegerLiteral::Type::I16, intValue);
+				return std::pair(IntegerLiteral::Type::I16, intValue);
 			}
 			if (suffix == "i32") {
 				uint64_t intValue = std::stoul(std::string(value), &pos, base);
 				if (pos != i - start) {
-					return nullptr;
+					return std::nullopt;
 				}
-				return std::make_unique<IntegerLiteral>(*literal,
-				      IntegerLiteral::Type::I32, intValue);
+				return std::pair(IntegerLiteral::Type::I32, intValue);
 			}
 			if (suffix == "i64") {
 				uint64_t intValue = std::stoul(std::string(value), &pos, base);
 				if (pos != i - start) {
-					return nullptr;
+					return std::nullopt;
 				}
-				return std::make_unique<IntegerLiteral>(*literal,
-				      IntegerLiteral::Type::I64, intValue);
+				return std::pair(IntegerLiteral::Type::I64, intValue);
 			}
 			if (suffix == "u8") {
 				uint64_t intValue = std::stoul(std::string(value), &pos, base);
 				if (pos != i - start) {
-					return nullptr;
+					return std::nullopt;
 				}
-				return std::make_unique<IntegerLiteral>(*literal,
-				      IntegerLiteral::Type::U8, intValue);
+				return std::pair(IntegerLiteral::Type::U8, intValue);
 			}
 			if (suffix == "u16") {
 				uint64_t intValue = std::stoul(std::string(value), &pos, base);
 				if (pos != i - start) {
-					return nullptr;
+					return std::nullopt;
 				}
-				return std::make_unique<IntegerLiteral>(*literal,
-				      IntegerLiteral::Type::U16, intValue);
+				return std::pair(IntegerLiteral::Type::U16, intValue);
 			}
 			if (suffix == "u32") {
 				uint64_t intValue = std::stoul(std::string(value), &pos, base);
 				if (pos != i - start) {
-					return nullptr;
+					return std::nullopt;
 				}
-				return std::make_unique<IntegerLiteral>(*literal,
-				      IntegerLiteral::Type::U32, intValue);
+				return std::pair(IntegerLiteral::Type::U32, intValue);
 			}
 			if (suffix == "u64") {
 				uint64_t intValue = std::stoul(std::string(value), &pos, base);
 				if (pos != i - start) {
-					return nullptr;
+					return std::nullopt;
 				}
-				return std::make_unique<IntegerLiteral>(*literal,
-				      IntegerLiteral::Type::U64, intValue);
+				return std::pair(IntegerLiteral::Type::U64, intValue);
 			}
 			// Not a suffix, but not a digit, so not a valid literal
-			return nullptr;
+			return std::nullopt;
 		}
 	}
 	// No non-digit character found, treat as regular i32 literal
-	std::string_view value
-	      = literal->s.contents.substr(start, literal->s.contents.size());
+	std::string_view value = literal.substr(start, literal.size());
 	uint64_t intValue = std::stoul(std::string(value), &pos, base);
-	if (pos != literal->s.contents.size() - start) {
-		return nullptr;
+	if (pos != literal.size() - start) {
+		return std::nullopt;
 	}
-	return std::make_unique<IntegerLiteral>(*literal, IntegerLiteral::Type::I32,
-	      intValue);
+	return std::pair(IntegerLiteral::Type::I32, intValue);
 }
 
-std::unique_ptr<CharacterLiteral> Lexer::evaluateCharacterLiteral(
-      SymbolOrLiteral *literal) {
-	if (literal->s.contents.size() < 3) {
-		return nullptr;
+std::optional<char> Lexer::evaluateCharacterLiteral(std::string_view literal) {
+	if (literal.size() < 3) {
+		return std::nullopt;
 	}
-	if (literal->s.contents[0] != '\'') {
-		return nullptr;
+	if (literal[0] != '\'') {
+		return std::nullopt;
 	}
-	if (literal->s.contents[1] == '\\') {
-		if (literal->s.contents.size() < 4) {
-			return nullptr;
+	if (literal[1] == '\\') {
+		if (literal.size() < 4) {
+			return std::nullopt;
 		}
-		if (literal->s.contents[3] != '\'') {
-			return nullptr;
+		if (literal[3] != '\'') {
+			return std::nullopt;
 		}
-		switch (literal->s.contents[2]) {
+		switch (literal[2]) {
 			case 'a':
-				return std::make_unique<CharacterLiteral>(*literal, '\a');
+				return '\a';
 			case 'b':
-				return std::make_unique<CharacterLiteral>(*literal, '\b');
+				return '\b';
 			case 'f':
-				return std::make_unique<CharacterLiteral>(*literal, '\f');
+				return '\f';
 			case 'n':
-				return std::make_unique<CharacterLiteral>(*literal, '\n');
+				return '\n';
 			case 'r':
-				return std::make_unique<CharacterLiteral>(*literal, '\r');
+				return '\r';
 			case 't':
-				return std::make_unique<CharacterLiteral>(*literal, '\t');
+				return '\t';
 			case 'v':
-				return std::make_unique<CharacterLiteral>(*literal, '\v');
+				return '\v';
 			case '\\':
-				return std::make_unique<CharacterLiteral>(*literal, '\\');
+				return '\\';
 			case '\'':
-				return std::make_unique<CharacterLiteral>(*literal, '\'');
+				return '\'';
 			case '\"':
-				return std::make_unique<CharacterLiteral>(*literal, '\"');
+				return '\"';
 			default:
-				return nullptr;
+				return std::nullopt;
 		}
 	}
-	if (literal->s.contents[2] != '\'') {
-		return nullptr;
+	if (literal[2] != '\'') {
+		return std::nullopt;
 	}
-	char value = literal->s.contents[1];
-	return std::make_unique<CharacterLiteral>(*literal, value);
+	return literal[1];
 }
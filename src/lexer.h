@@ -2,13 +2,18 @@
 #define LEXER_H
 
 #include "errorhandler.h"
+#include "lexemes.h"
+#include "sourcemanager.h"
+#include "threadpool.h"
+#include "tokenbuffer.h"
 #include "tokens.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
-#include <memory>
-#include <queue>
+#include <optional>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 /**
@@ -16,61 +21,117 @@
  *
  */
 class Lexer {
+	// Smaller chunks are not worth handing to another thread
+	static constexpr size_t MIN_CHUNK_SIZE = 64 * 1024;
+
 	std::string_view program;
 	size_t current = 0;
-	std::filesystem::path source;
-	std::queue<Slice> slices;
-	uint32_t tabSize;
+	FileID source = SourceManager::NO_FILE;
 	ErrorHandler *errorHandler;
-	size_t line = 1;
-	size_t col = 1;
+	std::vector<std::pair<Slice, std::string_view>> literalErrors;
+	// Lexes large programs in parallel if not null
+	ThreadPool *threadPool = nullptr;
+
+	/**
+	 * @brief Construct a Lexer for part of a program whose file is already registered
+	 */
+	Lexer(std::string_view program, FileID source, ErrorHandler *errorHandler);
 public:
+	static constexpr uint32_t DEFAULT_TAB_SIZE = 4;
+
 	/**
 	 * @brief Construct a new Lexer object to tokenize Canyon source code
 	 *
 	 * @param program the source code to tokenize
-	 * @param source the name of the source code file
+	 * @param source the name of the source code file, which is registered with the
+	 * SourceManager
 	 * @param errorHandler the error handler to use
-	 * @param tabSize the width of a tab stop (default = 4)
+	 * @param tabSize the width of a tab stop, used when reporting columns
+	 * @param threadPool if not null, large programs are split into runs of functions
+	 * which are lexed at once. The result is the same as lexing sequentially
 	 */
 	Lexer(std::string_view program, std::filesystem::path source,
-	      ErrorHandler *errorHandler, uint32_t tabSize = 4);
+	      ErrorHandler *errorHandler, uint32_t tabSize = DEFAULT_TAB_SIZE,
+	      ThreadPool *threadPool = nullptr);
 	Lexer &operator=(const Lexer &l);
 	~Lexer() = default;
-	std::vector<std::unique_ptr<Token>> lex();
+	/**
+	 * @brief Tokenizes the Canyon source code in a single pass over its characters
+	 *
+	 * @return the source code as a series of Tokens, terminated by an EndOfFile
+	 */
+	TokenBuffer lex();
 private:
 	/**
-	 * @brief Scans the Canyon source code
+	 * @brief Appends the Tokens from the current position to the end of the program,
+	 * stopping early at an unterminated comment or character literal
+	 */
+	void lexTokens(TokenBuffer &tokens);
+	/**
+	 * @brief Finds where the program can be split into chunks which lex the same on
+	 * their own as they do in sequence: each is a fun keyword at the start of a line,
+	 * outside any comment or character literal. This mirrors how the lexer skips those,
+	 * both of which can only begin where a token does
 	 *
-	 * @return the source code as a series of Tokens, stored in a vector
+	 * @param chunks how many chunks of roughly equal size to aim for
+	 * @return the offset where each chunk begins, starting with 0
 	 */
-	std::vector<std::unique_ptr<Token>> scan();
-	std::vector<std::unique_ptr<Token>> evaluate(
-	      std::vector<std::unique_ptr<Token>> tokens);
-	static bool isDigitInBase(char c, int base);
-	static std::unique_ptr<IntegerLiteral> evaluateIntegerLiteral(
-	      SymbolOrLiteral *literal);
-	static std::unique_ptr<CharacterLiteral> evaluateCharacterLiteral(
-	      SymbolOrLiteral *literal);
+	std::vector<size_t> findSplits(size_t chunks) const;
 	/**
-	 * @brief Splits the input source file into Slices based on whitespace and other token
-	 * separator rules
+	 * @brief Lexes each chunk of the program on the ThreadPool, then appends their Tokens
+	 * and errors in order
+	 *
+	 * @param splits the offset where each chunk begins
 	 */
-	void slice();
+	void lexChunks(TokenBuffer &tokens, const std::vector<size_t> &splits);
+
+	static bool isDigitInBase(char c, int base);
+	static std::optional<std::pair<IntegerLiteral::Type, uint64_t>>
+	evaluateIntegerLiteral(std::string_view literal);
+	static std::optional<char> evaluateCharacterLiteral(std::string_view literal);
 
 	/**
-	 * @brief Determines whether a character in the program represents the start of a new
-	 * token. If offset == 0 && isalnum(program[offset]), this is considered UB
+	 * @brief Consumes a // comment up to, but not including, the next newline
+	 */
+	void skipLineComment();
+	/**
+	 * @brief Consumes a block comment, including its terminating star-slash
+	 *
+	 * @return false if the comment is unterminated, in which case an error is reported
+	 */
+	bool skipBlockComment();
+	/**
+	 * @brief Consumes a character literal, including both of its quotes
 	 *
-	 * @param offset where in the string to test at
-	 * @returns whether program[offset] is at the start of a new token
+	 * @param tokenStart the offset of the opening quote
+	 * @return false if the literal is unterminated, in which case an error is reported
+	 */
+	bool skipCharacterLiteral(size_t tokenStart);
+
+	/**
+	 * @brief Consumes a Keyword, Symbol, integer literal, or punctuation character along
+	 * with any characters that are attached to it rather than beginning a new token
 	 */
-	bool isSep(size_t offset);
+	void skipWord();
 
-	static std::unique_ptr<Whitespace> createWhitespace(const Slice &s);
-	static std::unique_ptr<Keyword> createKeyword(const Slice &s);
-	static std::unique_ptr<Punctuation> createPunctuation(const Slice &s);
-	static std::unique_ptr<SymbolOrLiteral> createSymbolOrLiteral(const Slice &s);
+	/**
+	 * @brief Appends the token spelled by lexeme at offset
+	 */
+	static void pushLexeme(TokenBuffer &tokens, size_t offset, const Lexeme &lexeme);
+	/**
+	 * @brief Looks up the Operator formed by two adjacent punctuation characters
+	 *
+	 * @param first the earlier punctuation character, or '\0' if there is none
+	 * @param second the later punctuation character
+	 * @return the combined Operator, or nullptr if the two characters do not combine
+	 */
+	static const Lexeme *combinePunctuation(char first, char second);
+	/**
+	 * @brief Appends the literal or Symbol spanning from offset to the current position.
+	 * A Symbol is interned as it is appended. Malformed literals are recorded in
+	 * literalErrors and appended as a SymbolOrLiteral
+	 */
+	void pushWord(TokenBuffer &tokens, size_t offset);
 };
 
 #endif
@@ -1,92 +1,266 @@
 #include "ast.h"
+#include "builtinapi.h"
 #include "ccodegenerator.h"
-#include "config.h"
 #include "errorhandler.h"
 #include "lexer.h"
+#include "outputfile.h"
 #include "parser.h"
 #include "semanticanalyzer.h"
+#include "sourcefile.h"
+#include "threadpool.h"
+#include "tokenbuffer.h"
 #include "tokens.h"
+#include <nlohmann/json.hpp>
 
+#include <atomic>
+#include <cctype>
 #include <cerrno>
+#include <charconv>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
 #include <span>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
 #include <vector>
 
-int main(int argc, char **argv) {
-	if (argc != 3) {
-		std::cerr << "Unexpected argument count. Usage: ./build/main infile outfile\n";
-		return EXIT_FAILURE;
-	}
-
-	auto args = std::span(argv, size_t(argc));
-	std::filesystem::path infileName = std::filesystem::path(args[1]);
-	std::filesystem::path outfileName = std::filesystem::path(args[2]);
-	std::filesystem::path apiJsonFile = std::filesystem::path(BUILTIN_API_PATH);
-
-	// Read the source file into a string
-	std::ifstream infile = std::ifstream(infileName);
-	if (!infile) {
+/**
+ * @brief Compiles one source file to C
+ *
+ * @param builtinApi the builtin API, which is shared with every other file
+ * @param threadPool splits the work on the file across threads, alongside other files
+ * @param diagnostics where every error about the file is written
+ * @return whether the file compiled without errors
+ */
+static bool compile(const std::filesystem::path &infileName,
+      const std::filesystem::path &outfileName, const BuiltinApi &builtinApi,
+      ThreadPool &threadPool, std::ostream &diagnostics) {
+	// Map the source file into memory, which every Slice will then point into
+	std::optional<SourceFile> infile = SourceFile::open(infileName);
+	if (!infile.has_value()) {
 		int e = errno;
-		std::cerr << "Failed to open source file " << infileName << ": " << strerror(e)
-		          << '\n';
-		return EXIT_FAILURE;
+		diagnostics << "Failed to open source file " << infileName << ": " << strerror(e)
+		            << '\n';
+		return false;
 	}
-	std::string fileData = std::string((std::istreambuf_iterator<char>(infile)),
-	      std::istreambuf_iterator<char>());
 
 	ErrorHandler errorHandler;
 
-	Lexer l = Lexer(fileData, infileName, &errorHandler);
-	std::vector<std::unique_ptr<Token>> tokens = l.lex();
-	if (errorHandler.handleErrors(std::cerr)) {
-		return EXIT_FAILURE;
+	Lexer l = Lexer(infile->getContents(), infileName, &errorHandler,
+	      Lexer::DEFAULT_TAB_SIZE, &threadPool);
+	TokenBuffer tokens = l.lex();
+	if (errorHandler.handleErrors(diagnostics)) {
+		return false;
 	}
 
-	Parser p = Parser(infileName, std::move(tokens), &errorHandler);
+	Parser p = Parser(std::move(tokens), &errorHandler, &threadPool);
 	std::unique_ptr<Module> mod = p.parse();
-	if (errorHandler.handleErrors(std::cerr)) {
-		return EXIT_FAILURE;
+	if (errorHandler.handleErrors(diagnostics)) {
+		return false;
 	}
 
-	std::ifstream apiFile = std::ifstream(apiJsonFile);
-	SemanticAnalyzer analyzer = SemanticAnalyzer(mod.get(), &errorHandler, apiFile);
+	SemanticAnalyzer analyzer
+	      = SemanticAnalyzer(mod.get(), &errorHandler, builtinApi, &threadPool);
 	analyzer.analyze();
-	if (errorHandler.handleErrors(std::cerr)) {
-		return EXIT_FAILURE;
+	if (errorHandler.handleErrors(diagnostics)) {
+		return false;
 	}
 
-	std::ofstream outfile = std::ofstream(outfileName, std::ios::out | std::ios::trunc);
-	if (!outfile) {
+	std::optional<OutputFile> outfile = OutputFile::open(outfileName);
+	if (!outfile.has_value()) {
 		int e = errno;
-		std::cerr << "Failed to open outfile " << outfileName << ": " << strerror(e)
-		          << '\n';
-		return EXIT_FAILURE;
+		diagnostics << "Failed to open outfile " << outfileName << ": " << strerror(e)
+		            << '\n';
+		return false;
 	}
 
-	CCodeGenerator codeGenerator = CCodeGenerator(mod.get(), &outfile);
+	CCodeGenerator codeGenerator = CCodeGenerator(mod.get(), &*outfile, &threadPool);
 	codeGenerator.generate();
 
-	// Close the files
-	outfile.close();
-	if (!outfile) {
+	// Write out whatever is still buffered and close the file
+	if (!outfile->close()) {
 		int e = errno;
-		std::cerr << "Error closing outfile " << outfileName << ": " << strerror(e)
-		          << '\n';
+		diagnostics << "Error closing outfile " << outfileName << ": " << strerror(e)
+		            << '\n';
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Splits the contents of a response file into arguments as GCC and Clang do.
+ * Arguments are separated by whitespace, which is kept within single or double quotes.
+ * A backslash keeps the next character as is, except within single quotes
+ */
+static std::vector<std::string> splitArguments(std::string_view text) {
+	std::vector<std::string> arguments;
+	std::string argument;
+	// Quotes may make an argument empty, so whether one has started is kept apart
+	bool inArgument = false;
+	char quote = '\0';
+	for (size_t i = 0; i < text.size(); i++) {
+		char c = text[i];
+		if (c == '\\' && quote != '\'' && i + 1 < text.size()) {
+			argument += text[++i];
+			inArgument = true;
+		} else if (quote != '\0') {
+			if (c == quote) {
+				quote = '\0';
+			} else {
+				argument += c;
+			}
+		} else if (c == '\'' || c == '"') {
+			quote = c;
+			inArgument = true;
+		} else if (std::isspace(static_cast<unsigned char>(c)) != 0) {
+			if (inArgument) {
+				arguments.push_back(std::move(argument));
+				argument.clear();
+				inArgument = false;
+			}
+		} else {
+			argument += c;
+			inArgument = true;
+		}
+	}
+	if (inArgument) {
+		arguments.push_back(std::move(argument));
+	}
+	return arguments;
+}
+
+/**
+ * @brief Replaces each argument of the form @file with the arguments in that file, so
+ * that a build can pass more files than fit on a command line
+ *
+ * @return the expanded arguments, or std::nullopt if a file could not be read
+ */
+static std::optional<std::vector<std::string>> expandResponseFiles(
+      std::span<char *> args) {
+	std::vector<std::string> expanded;
+	for (std::string_view arg : args) {
+		if (!arg.starts_with('@')) {
+			expanded.emplace_back(arg);
+			continue;
+		}
+		std::filesystem::path responseFileName(arg.substr(1));
+		std::ifstream responseFile(responseFileName);
+		if (!responseFile) {
+			int e = errno;
+			std::cerr << "Failed to open response file " << responseFileName << ": "
+			          << strerror(e) << '\n';
+			return std::nullopt;
+		}
+		std::string contents(std::istreambuf_iterator<char>(responseFile),
+		      std::istreambuf_iterator<char>{});
+		for (std::string &argument : splitArguments(contents)) {
+			expanded.push_back(std::move(argument));
+		}
+	}
+	return expanded;
+}
+
+static constexpr std::string_view USAGE
+      = "Usage: ./build/canyon [--builtin-api file] [-j threads] infile outfile [infile "
+        "outfile]...\nArguments may also be read from @file, quoted as in a shell\n";
+
+int main(int argc, char **argv) {
+	std::optional<std::vector<std::string>> args
+	      = expandResponseFiles(std::span(argv, size_t(argc)).subspan(1));
+	if (!args.has_value()) {
 		return EXIT_FAILURE;
 	}
-	infile.close();
-	if (!infile) {
-		int e = errno;
-		std::cerr << "Error closing infile " << infileName << ": " << strerror(e) << '\n';
+	std::vector<std::filesystem::path> paths;
+	// Overrides the builtin API embedded at build time, for developing the runtime
+	std::optional<std::filesystem::path> apiJsonFile;
+	// How many threads compile the files, or 0 for one per hardware thread
+	size_t threads = 0;
+	for (size_t i = 0; i < args->size(); i++) {
+		std::string_view arg = (*args)[i];
+		if ((arg == "--builtin-api" || arg == "-j") && i + 1 == args->size()) {
+			std::cerr << "Missing value for " << arg << ". " << USAGE;
+			return EXIT_FAILURE;
+		}
+		if (arg == "--builtin-api") {
+			apiJsonFile = std::filesystem::path((*args)[++i]);
+		} else if (arg == "-j") {
+			std::string_view count = (*args)[++i];
+			const char *countEnd = count.data() + count.size();
+			auto [end, error] = std::from_chars(count.data(), countEnd, threads);
+			if (error != std::errc() || end != countEnd) {
+				std::cerr << "Invalid thread count " << count << '\n';
+				return EXIT_FAILURE;
+			}
+		} else if (arg.starts_with('-') && arg != "-") {
+			std::cerr << "Unknown option " << arg << ". " << USAGE;
+			return EXIT_FAILURE;
+		} else {
+			paths.emplace_back(arg);
+		}
+	}
+	if (paths.empty() || paths.size() % 2 != 0) {
+		std::cerr << "Unexpected argument count. " << USAGE;
 		return EXIT_FAILURE;
 	}
 
-	return EXIT_SUCCESS;
+	// Read once and shared by every file
+	std::optional<BuiltinApi> readApi;
+	if (apiJsonFile.has_value()) {
+		std::ifstream apiFile(*apiJsonFile);
+		if (!apiFile) {
+			int e = errno;
+			std::cerr << "Failed to open builtin API file " << *apiJsonFile << ": "
+			          << strerror(e) << '\n';
+			return EXIT_FAILURE;
+		}
+		try {
+			readApi.emplace(apiFile);
+		} catch (const nlohmann::json::exception &e) {
+			std::cerr << "Failed to read builtin API file " << *apiJsonFile << ": "
+			          << e.what() << '\n';
+			return EXIT_FAILURE;
+		}
+	}
+	const BuiltinApi &builtinApi
+	      = readApi.has_value() ? *readApi : BuiltinApi::embedded();
+
+	// Files are compiled alongside each other, and the work on each is split across the
+	// same threads
+	ThreadPool threadPool(threads);
+	size_t files = paths.size() / 2;
+	std::atomic<bool> failed = false;
+	// The errors about each file are reported once every file before it has been
+	// reported, so they come out in the order the files were given
+	std::vector<std::string> diagnostics(files);
+	std::vector<bool> finished(files, false);
+	size_t reported = 0;
+	std::mutex reportMutex;
+	threadPool.forEach(files, [&](size_t file) {
+		std::ostringstream fileDiagnostics;
+		if (!compile(paths[2 * file], paths[2 * file + 1], builtinApi, threadPool,
+		          fileDiagnostics)) {
+			failed = true;
+		}
+		std::lock_guard lock(reportMutex);
+		diagnostics[file] = std::move(fileDiagnostics).str();
+		finished[file] = true;
+		for (; reported < files && finished[reported]; reported++) {
+			std::cerr << diagnostics[reported];
+			diagnostics[reported].clear();
+		}
+	});
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
 }
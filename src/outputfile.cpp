@@ -0,0 +1,155 @@
+#include "outputfile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+std::optional<OutputFile> OutputFile::open(const std::filesystem::path &path) {
+	bool standardOutput = path == "-";
+	int fd = standardOutput
+	               ? STDOUT_FILENO
+	               : ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+	if (fd < 0) {
+		return std::nullopt;
+	}
+	return OutputFile(fd, standardOutput, BUFFER_SIZE);
+}
+
+OutputFile OutputFile::inMemory() {
+	return OutputFile(-1, false, INITIAL_MEMORY_SIZE);
+}
+
+OutputFile::OutputFile(int fd, bool standardOutput, size_t capacity)
+    : fd(fd), standardOutput(standardOutput), keptInMemory(fd < 0),
+      buffer(std::make_unique_for_overwrite<char[]>(capacity)), capacity(capacity) {
+}
+
+OutputFile::OutputFile(OutputFile &&other) noexcept
+    : fd(std::exchange(other.fd, -1)), standardOutput(other.standardOutput),
+      keptInMemory(other.keptInMemory), buffer(std::move(other.buffer)),
+      capacity(std::exchange(other.capacity, 0)), used(std::exchange(other.used, 0)),
+      flushed(other.flushed), error(other.error) {
+}
+
+OutputFile::~OutputFile() {
+	if (fd >= 0) {
+		close();
+	}
+}
+
+void OutputFile::writeAll(iovec *chunks, int count) {
+	while (error == 0 && count > 0) {
+		ssize_t written = ::writev(fd, chunks, count);
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+		if (written < 0) {
+			error = errno;
+			return;
+		}
+		flushed += written;
+		// Skip past whatever was written, which may end partway through a chunk
+		auto remaining = static_cast<size_t>(written);
+		while (count > 0 && remaining >= chunks->iov_len) {
+			remaining -= chunks->iov_len;
+			chunks++;
+			count--;
+		}
+		if (count > 0) {
+			chunks->iov_base = static_cast<char *>(chunks->iov_base) + remaining;
+			chunks->iov_len -= remaining;
+		}
+	}
+}
+
+void OutputFile::flush() {
+	iovec chunk{buffer.get(), used};
+	writeAll(&chunk, 1);
+	used = 0;
+}
+
+void OutputFile::makeRoom(size_t size) {
+	if (!keptInMemory) {
+		flush();
+		return;
+	}
+	size_t grown = std::max(capacity * 2, used + size);
+	auto larger = std::make_unique_for_overwrite<char[]>(grown);
+	std::memcpy(larger.get(), buffer.get(), used);
+	buffer = std::move(larger);
+	capacity = grown;
+}
+
+OutputFile &OutputFile::operator<<(std::string_view text) {
+	if (text.size() > capacity - used) {
+		if (!keptInMemory && text.size() >= capacity) {
+			iovec chunks[] = {{buffer.get(), used},
+			      {const_cast<char *>(text.data()), text.size()}};
+			writeAll(chunks, 2);
+			used = 0;
+			return *this;
+		}
+		makeRoom(text.size());
+	}
+	std::memcpy(buffer.get() + used, text.data(), text.size());
+	used += text.size();
+	return *this;
+}
+
+OutputFile &OutputFile::operator<<(char c) {
+	if (used == capacity) {
+		makeRoom(1);
+	}
+	buffer[used++] = c;
+	return *this;
+}
+
+OutputFile &OutputFile::operator<<(uint64_t value) {
+	char digits[20];
+	char *end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+	return *this << std::string_view(digits, end - digits);
+}
+
+void OutputFile::indent(int level) {
+	for (auto remaining = static_cast<size_t>(std::max(level, 0)); remaining > 0;) {
+		size_t count = std::min(remaining, TABS.size());
+		*this << TABS.substr(0, count);
+		remaining -= count;
+	}
+}
+
+size_t OutputFile::size() const {
+	return flushed + used;
+}
+
+std::string_view OutputFile::getContents() const {
+	return std::string_view(buffer.get(), used);
+}
+
+bool OutputFile::close() {
+	if (keptInMemory) {
+		return true;
+	}
+	flush();
+	if (!standardOutput && ::close(fd) != 0 && error == 0) {
+		error = errno;
+	}
+	fd = -1;
+	if (error != 0) {
+		errno = error;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,97 @@
+#ifndef OUTPUTFILE_H
+#define OUTPUTFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+struct iovec;
+
+/**
+ * @brief Writes generated code to a file through a large buffer, so that emitting a
+ * fragment is a copy rather than a formatted stream operation. The buffer is written out
+ * in one system call whenever it fills up, and fragments too large for it are written
+ * from where they are together with whatever was buffered before them. An OutputFile
+ * may instead keep everything in memory, so that parts of a file can be generated
+ * separately and then written out in order
+ *
+ */
+class OutputFile {
+	// Written a slice at a time to indent lines
+	static constexpr std::string_view TABS = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+
+	int fd;
+	bool standardOutput;
+	bool keptInMemory;
+	std::unique_ptr<char[]> buffer;
+	size_t capacity;
+	size_t used = 0;
+	size_t flushed = 0;
+	// The errno of the first failed write, after which all output is discarded
+	int error = 0;
+
+	OutputFile(int fd, bool standardOutput, size_t capacity);
+	void writeAll(iovec *chunks, int count);
+	void flush();
+	/**
+	 * @brief Makes room in the buffer for at least the given number of bytes, by
+	 * flushing it or, if everything is kept in memory, by growing it
+	 */
+	void makeRoom(size_t size);
+public:
+	static constexpr size_t BUFFER_SIZE = 256 * 1024;
+	// The buffer of an OutputFile kept in memory is doubled whenever it fills up
+	static constexpr size_t INITIAL_MEMORY_SIZE = 4 * 1024;
+
+	/**
+	 * @brief Creates or truncates a file to write to
+	 *
+	 * @param path the name of the file, or "-" for standard output
+	 * @return the opened file, or std::nullopt if it could not be opened, in which case
+	 * errno describes the failure
+	 */
+	static std::optional<OutputFile> open(const std::filesystem::path &path);
+	/**
+	 * @brief Creates an OutputFile which keeps everything written to it in memory
+	 */
+	static OutputFile inMemory();
+	OutputFile(OutputFile &&other) noexcept;
+	OutputFile &operator=(OutputFile &&other) = delete;
+	OutputFile(const OutputFile &) = delete;
+	OutputFile &operator=(const OutputFile &) = delete;
+	/**
+	 * @brief Closes the file if close has not been called, ignoring any error
+	 */
+	~OutputFile();
+
+	OutputFile &operator<<(std::string_view text);
+	OutputFile &operator<<(char c);
+	/**
+	 * @brief Writes an integer in decimal
+	 */
+	OutputFile &operator<<(uint64_t value);
+	/**
+	 * @brief Writes a tab for each level of indentation
+	 */
+	void indent(int level);
+	/**
+	 * @brief Gets how many bytes have been written, including those still buffered
+	 */
+	size_t size() const;
+	/**
+	 * @brief Gets everything written to an OutputFile which keeps it in memory
+	 */
+	std::string_view getContents() const;
+	/**
+	 * @brief Writes out everything buffered and closes the file
+	 *
+	 * @return whether every write and the close succeeded. If not, errno describes the
+	 * first failure
+	 */
+	bool close();
+};
+
+#endif
@@ -1,33 +1,132 @@
 #include "parser.h"
 
+#include "arena.h"
 #include "ast.h"
+#include "casting.h"
 #include "errorhandler.h"
-
+#include "threadpool.h"
+#include "tokenbuffer.h"
+#include "tokens.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
 #include <memory>
+#include <optional>
+#include <string>
+#include <utility>
 #include <vector>
 
-Parser::Parser(std::filesystem::path source, std::vector<std::unique_ptr<Token>> tokens,
-      ErrorHandler *errorHandler)
-    : tokens(std::move(tokens)), errorHandler(errorHandler), source(std::move(source)) {
+/**
+ * @brief The ways an Operator may appear in an expression
+ *
+ */
+struct OperatorSyntax {
+	// How tightly the Operator binds as a binary operator, or None if it cannot be one
+	Precedence precedence = Precedence::None;
+	bool rightAssociative = false;
+	// Whether the Operator may prefix an operand as a unary operator
+	bool prefix = false;
+};
+
+// Adding an Operator to the grammar only takes a row here
+static constexpr std::array<OperatorSyntax, Operator::TYPE_COUNT> OPERATOR_SYNTAX = [] {
+	std::array<OperatorSyntax, Operator::TYPE_COUNT> table{};
+	auto row = [&table](Operator::Type type, OperatorSyntax syntax) {
+		table[static_cast<size_t>(type)] = syntax;
+	};
+	using enum Operator::Type;
+	row(Assignment, {Precedence::Assignment, true, false});
+	row(LogicalOr, {Precedence::LogicalOr, false, false});
+	row(LogicalAnd, {Precedence::LogicalAnd, false, false});
+	row(Equality, {Precedence::Relational, false, false});
+	row(Inequality, {Precedence::Relational, false, false});
+	row(LessThan, {Precedence::Relational, false, false});
+	row(LessThanOrEqual, {Precedence::Relational, false, false});
+	row(GreaterThan, {Precedence::Relational, false, false});
+	row(GreaterThanOrEqual, {Precedence::Relational, false, false});
+	row(BitwiseOr, {Precedence::BitwiseOr, false, false});
+	row(BitwiseXor, {Precedence::BitwiseXor, false, false});
+	row(BitwiseAnd, {Precedence::BitwiseAnd, false, false});
+	row(BitwiseShiftLeft, {Precedence::Bitshift, false, false});
+	row(BitwiseShiftRight, {Precedence::Bitshift, false, false});
+	row(Addition, {Precedence::Additive, false, true});
+	row(Subtraction, {Precedence::Additive, false, true});
+	row(Multiplication, {Precedence::Multiplicative, false, false});
+	row(Division, {Precedence::Multiplicative, false, false});
+	row(Modulus, {Precedence::Multiplicative, false, false});
+	row(LogicalNot, {Precedence::None, false, true});
+	row(BitwiseNot, {Precedence::None, false, true});
+	return table;
+}();
+
+static const OperatorSyntax &operatorSyntax(Operator::Type type) {
+	return OPERATOR_SYNTAX[static_cast<size_t>(type)];
+}
+
+namespace {
+
+/**
+ * @brief Counts one more level of nesting for as long as it is in scope
+ *
+ */
+class NestingLevel {
+	size_t &depth;
+public:
+	explicit NestingLevel(size_t &depth) : depth(depth) {
+		depth++;
+	}
+	NestingLevel(const NestingLevel &) = delete;
+	NestingLevel &operator=(const NestingLevel &) = delete;
+	~NestingLevel() {
+		depth--;
+	}
+};
+
+} // namespace
+
+Parser::Parser(TokenBuffer tokens, ErrorHandler *errorHandler, ThreadPool *threadPool)
+    : ownedTokens(std::move(tokens)), tokens(&*ownedTokens), cursor(*ownedTokens),
+      errorHandler(errorHandler), threadPool(threadPool) {
+}
+
+Parser::Parser(const TokenBuffer &tokens, Arena *arena)
+    : tokens(&tokens), cursor(tokens), errorHandler(nullptr), arena(arena) {
 }
 
 std::unique_ptr<Module> Parser::parse() {
-	auto mod = std::make_unique<Module>(source);
+	auto mod = std::make_unique<Module>(tokens->getSource(), tokens->getInterner());
+	arena = &mod->getArena();
+	std::vector<ParsedFunction> parsed;
+	if (threadPool != nullptr && threadPool->size() > 1) {
+		parsed = parseFunctionsInParallel(*mod);
+	}
+	size_t next = 0;
 	while (!isAtEnd()) {
-		std::pair<std::unique_ptr<Symbol>, std::unique_ptr<Function>> func
-		      = parseFunction();
+		// A function parsed ahead of time began in the same state the loop is in, so the
+		// loop would parse it the same way
+		while (next < parsed.size() && parsed[next].begin < cursor.getIndex()) {
+			next++;
+		}
+		if (next < parsed.size() && parsed[next].begin == cursor.getIndex()
+		      && parsed[next].function != nullptr && !mustSynchronize) {
+			mod->addFunction(*parsed[next].name, parsed[next].function);
+			cursor.moveTo(parsed[next].end);
+			continue;
+		}
+		std::pair<Symbol *, Function *> func = parseFunction();
 		if (func.second == nullptr) {
 			synchronize();
 			mustSynchronize = false;
-			auto *punc = dynamic_cast<Punctuation *>(tokens[i].get());
-			while (punc != nullptr) {
-				if (punc->type == Punctuation::Type::Semicolon) {
-					i++;
+			while (cursor.kind() == TokenKind::Punctuation) {
+				if (cursor.isPunctuation(Punctuation::Type::Semicolon)) {
+					cursor.advance();
 					synchronize();
 					mustSynchronize = false;
-					punc = dynamic_cast<Punctuation *>(tokens[i].get());
-				} else if (punc->type == Punctuation::Type::CloseBrace) {
-					i++;
+				} else if (cursor.isPunctuation(Punctuation::Type::CloseBrace)) {
+					cursor.advance();
 					break;
 				} else {
 					std::cerr << "Unexpected token in parse" << std::endl;
@@ -36,706 +135,572 @@ std::unique_ptr<Module> Parser::parse() {
 			}
 			continue;
 		}
-		mod->addFunction(std::move(func.first), std::move(func.second));
+		mod->addFunction(*func.first, func.second);
 	}
 	return mod;
 }
 
-std::pair<std::unique_ptr<Symbol>, std::unique_ptr<Function>> Parser::parseFunction() {
-	auto *keyword = dynamic_cast<Keyword *>(tokens[i].get());
-	if (keyword == nullptr || keyword->type != Keyword::Type::FUN) {
-		errorHandler->error(*tokens[i], "Expected keyword `fun`");
+std::vector<Parser::ParsedFunction> Parser::findFunctions() const {
+	std::vector<ParsedFunction> functions;
+	size_t braces = 0;
+	// The final Token is the EndOfFile
+	const size_t end = tokens->size() - 1;
+	for (size_t i = 0; i < end; i++) {
+		TokenKind kind = tokens->kind(i);
+		if (kind == TokenKind::Keyword && braces == 0
+		      && static_cast<Keyword::Type>(tokens->subtype(i)) == Keyword::Type::FUN) {
+			// A function with no braces at all ends where the next one begins
+			if (!functions.empty() && functions.back().end == 0) {
+				functions.back().end = i;
+			}
+			functions.push_back({i, 0});
+			continue;
+		}
+		if (kind != TokenKind::Punctuation) {
+			continue;
+		}
+		auto type = static_cast<Punctuation::Type>(tokens->subtype(i));
+		if (type == Punctuation::Type::OpenBrace) {
+			braces++;
+		} else if (type == Punctuation::Type::CloseBrace && braces > 0) {
+			braces--;
+			if (braces == 0 && !functions.empty() && functions.back().end == 0) {
+				functions.back().end = i + 1;
+			}
+		}
+	}
+	if (!functions.empty() && functions.back().end == 0) {
+		functions.back().end = end;
+	}
+	return functions;
+}
+
+std::vector<Parser::ParsedFunction> Parser::parseFunctionsInParallel(Module &module) {
+	std::vector<ParsedFunction> functions = findFunctions();
+	if (functions.size() < 2) {
+		return {};
+	}
+	std::vector<std::unique_ptr<Arena>> arenas(threadPool->countRuns(functions.size()));
+	auto parseRun = [this, &functions, &arenas](size_t run, size_t begin, size_t end) {
+		arenas[run] = std::make_unique<Arena>();
+		Parser parser(*tokens, arenas[run].get());
+		for (size_t i = begin; i < end; i++) {
+			ParsedFunction &function = functions[i];
+			parser.cursor.moveTo(function.begin);
+			parser.mustSynchronize = false;
+			parser.nestedTooDeeply = false;
+			parser.reportedError = false;
+			auto [name, parsed] = parser.parseFunction();
+			// Anything else is left to be parsed in sequence, which reports its errors
+			// and recovers from them in order
+			if (parsed != nullptr && !parser.reportedError && !parser.mustSynchronize
+			      && parser.cursor.getIndex() == function.end) {
+				function.name = name;
+				function.function = parsed;
+			}
+		}
+	};
+	threadPool->forEachRun(functions.size(), parseRun);
+	for (std::unique_ptr<Arena> &arena : arenas) {
+		module.adoptArena(std::move(arena));
+	}
+	return functions;
+}
+
+std::pair<Symbol *, Function *> Parser::parseFunction() {
+	if (!cursor.isKeyword(Keyword::Type::FUN)) {
+		error(cursor.slice(), "Expected keyword `fun`");
 		return {nullptr, nullptr};
 	}
-	i++;
-	auto *symbol = dynamic_cast<Symbol *>(tokens[i].get());
-	if (symbol == nullptr) {
-		errorHandler->error(*tokens[i], "Expected symbol following `fun`");
+	Keyword funKeyword = cursor.keyword();
+	cursor.advance();
+	if (cursor.kind() != TokenKind::Symbol) {
+		error(cursor.slice(), "Expected symbol following `fun`");
 		return {nullptr, nullptr};
 	}
-	symbol = dynamic_cast<Symbol *>(tokens[i++].release());
-	auto *punc = dynamic_cast<Punctuation *>(tokens[i].get());
-	if (punc == nullptr || punc->type != Punctuation::Type::OpenParen) {
-		errorHandler->error(*tokens[i],
+	Symbol *symbol = cursor.createSymbol(*arena);
+	cursor.advance();
+	if (!cursor.isPunctuation(Punctuation::Type::OpenParen)) {
+		error(cursor.slice(),
 		      "Expected '(' following symbol in function definition");
 		mustSynchronize = true;
 		return {nullptr, nullptr};
 	}
-	i++;
+	cursor.advance();
 
-	std::vector<std::pair<std::unique_ptr<Symbol>, std::unique_ptr<Symbol>>> parameters;
-	auto *argSymbol = dynamic_cast<Symbol *>(tokens[i].get());
-	while (argSymbol != nullptr) {
-		argSymbol = dynamic_cast<Symbol *>(tokens[i++].release());
-		auto *p1 = dynamic_cast<Punctuation *>(tokens[i].get());
-		if (p1 == nullptr || p1->type != Punctuation::Type::Colon) {
-			errorHandler->error(*tokens[i],
+	ArenaVector<std::pair<Symbol *, Symbol *>> parameters
+	      = arena->makeVector<std::pair<Symbol *, Symbol *>>();
+	while (cursor.kind() == TokenKind::Symbol) {
+		Symbol *argSymbol = cursor.createSymbol(*arena);
+		cursor.advance();
+		if (!cursor.isPunctuation(Punctuation::Type::Colon)) {
+			error(cursor.slice(),
 			      "Expected ':' following symbol in function definition");
 			return {nullptr, nullptr};
 		}
-		i++;
-		auto *type = dynamic_cast<Symbol *>(tokens[i].get());
-		if (type == nullptr) {
-			errorHandler->error(*tokens[i],
+		cursor.advance();
+		if (cursor.kind() != TokenKind::Symbol) {
+			error(cursor.slice(),
 			      "Expected type following ':' in function definition");
 			return {nullptr, nullptr};
 		}
-		type = dynamic_cast<Symbol *>(tokens[i++].release());
-		parameters.emplace_back(std::unique_ptr<Symbol>(argSymbol),
-		      std::unique_ptr<Symbol>(type));
-		auto *p2 = dynamic_cast<Punctuation *>(tokens[i].get());
-		if (p2 == nullptr) {
-			errorHandler->error(*tokens[i], "Expected ',' or ')' in function definition");
+		parameters.emplace_back(argSymbol, cursor.createSymbol(*arena));
+		cursor.advance();
+		if (cursor.kind() != TokenKind::Punctuation) {
+			error(cursor.slice(),
+			      "Expected ',' or ')' in function definition");
 			return {nullptr, nullptr};
 		}
-		if (p2->type == Punctuation::Type::CloseParen) {
+		if (cursor.isPunctuation(Punctuation::Type::CloseParen)) {
 			break;
 		}
-		if (p2->type != Punctuation::Type::Comma) {
-			errorHandler->error(*tokens[i], "Expected ',' or ')' in function definition");
+		if (!cursor.isPunctuation(Punctuation::Type::Comma)) {
+			error(cursor.slice(),
+			      "Expected ',' or ')' in function definition");
 			return {nullptr, nullptr};
 		}
-		i++;
-		argSymbol = dynamic_cast<Symbol *>(tokens[i].get());
+		cursor.advance();
 	}
 
-	punc = dynamic_cast<Punctuation *>(tokens[i].get());
-	if (punc == nullptr || punc->type != Punctuation::Type::CloseParen) {
-		errorHandler->error(*tokens[i], "Expected ')' in function definition");
+	if (!cursor.isPunctuation(Punctuation::Type::CloseParen)) {
+		error(cursor.slice(), "Expected ')' in function definition");
 		return {nullptr, nullptr};
 	}
-	i++;
+	cursor.advance();
 	Symbol *type = nullptr;
-	punc = dynamic_cast<Punctuation *>(tokens[i].get());
-	if (punc != nullptr && punc->type == Punctuation::Type::Colon) {
-		i++;
-		type = dynamic_cast<Symbol *>(tokens[i].get());
-		if (type == nullptr) {
-			errorHandler->error(*tokens[i],
+	if (cursor.isPunctuation(Punctuation::Type::Colon)) {
+		cursor.advance();
+		if (cursor.kind() != TokenKind::Symbol) {
+			error(cursor.slice(),
 			      "Expected function return type following ':' in function definition");
 			return {nullptr, nullptr};
 		}
-		type = dynamic_cast<Symbol *>(tokens[i++].release());
-	} else {
-		type = nullptr;
+		type = cursor.createSymbol(*arena);
+		cursor.advance();
 	}
-	std::unique_ptr<BlockExpression> block = parseBlock();
+	BlockExpression *block = parseBlock();
 	if (block == nullptr) {
 		return {nullptr, nullptr};
 	}
 
-	return {std::unique_ptr<Symbol>(symbol),
-	      std::make_unique<Function>(std::move(parameters), std::unique_ptr<Symbol>(type),
-	            std::move(block))};
+	return {symbol,
+	      arena->make<Function>(funKeyword, std::move(parameters), type, block)};
 }
 
-std::unique_ptr<Statement> Parser::parseStatement() {
-	auto *keyword = dynamic_cast<Keyword *>(tokens[i].get());
-	if (keyword != nullptr && keyword->type == Keyword::Type::LET) {
-		i++;
-		auto *symbol = dynamic_cast<Symbol *>(tokens[i].get());
-		if (symbol == nullptr) {
-			errorHandler->error(*tokens[i], "Expected symbol following `let`");
+Statement *Parser::parseStatement() {
+	if (cursor.isKeyword(Keyword::Type::LET)) {
+		Keyword keyword = cursor.keyword();
+		cursor.advance();
+		if (cursor.kind() != TokenKind::Symbol) {
+			error(cursor.slice(), "Expected symbol following `let`");
 			mustSynchronize = true;
 			return nullptr;
 		}
-		symbol = dynamic_cast<Symbol *>(tokens[i++].release());
+		Symbol *symbol = cursor.createSymbol(*arena);
+		cursor.advance();
 		Symbol *type = nullptr;
-		auto *punc = dynamic_cast<Punctuation *>(tokens[i].get());
-		if (punc != nullptr && punc->type == Punctuation::Type::Colon) {
-			i++;
-			type = dynamic_cast<Symbol *>(tokens[i].get());
-			if (type == nullptr) {
-				errorHandler->error(*tokens[i],
+		if (cursor.isPunctuation(Punctuation::Type::Colon)) {
+			cursor.advance();
+			if (cursor.kind() != TokenKind::Symbol) {
+				error(cursor.slice(),
 				      "Expected type following ':' in `let` statement");
 				mustSynchronize = true;
 				return nullptr;
 			}
-			type = dynamic_cast<Symbol *>(tokens[i++].release());
-		} else {
-			type = nullptr;
-		}
-		punc = dynamic_cast<Punctuation *>(tokens[i].get());
-		if (punc != nullptr && punc->type == Punctuation::Type::Semicolon) {
-			i++;
-			return std::make_unique<LetStatement>(*keyword,
-			      std::unique_ptr<Symbol>(symbol), std::unique_ptr<Symbol>(type), nullptr,
-			      nullptr, punc);
-		}
-		auto *op = dynamic_cast<Operator *>(tokens[i].get());
-		if (op == nullptr || op->type != Operator::Type::Assignment) {
-			errorHandler->error(*tokens[i],
+			type = cursor.createSymbol(*arena);
+			cursor.advance();
+		}
+		if (cursor.isPunctuation(Punctuation::Type::Semicolon)) {
+			Punctuation semicolon = cursor.punctuation();
+			cursor.advance();
+			return arena->make<LetStatement>(keyword, symbol, type, nullptr, nullptr,
+			      &semicolon);
+		}
+		if (!cursor.isOperator(Operator::Type::Assignment)) {
+			error(cursor.slice(),
 			      "Expected assignment expression in `let` statement");
 			mustSynchronize = true;
 			return nullptr;
 		}
-		op = dynamic_cast<Operator *>(tokens[i].release());
-		i++;
-		std::unique_ptr<Expression> expr = parseExpression();
+		Operator *op = cursor.createOperator(*arena);
+		cursor.advance();
+		Expression *expr = parseExpression();
 		if (expr == nullptr) {
 			synchronize();
 			mustSynchronize = false;
-			auto *punc = dynamic_cast<Punctuation *>(tokens[i].get());
-			if (punc != nullptr) {
-				if (punc->type == Punctuation::Type::Semicolon) {
-					i++;
+			if (cursor.kind() == TokenKind::Punctuation) {
+				if (cursor.isPunctuation(Punctuation::Type::Semicolon)) {
+					cursor.advance();
 					return nullptr;
 				}
-				if (punc->type == Punctuation::Type::CloseBrace) {
+				if (cursor.isPunctuation(Punctuation::Type::CloseBrace)) {
 					return nullptr;
 				}
 				std::cerr << "Unexpected token in parseExpression" << std::endl;
 				exit(EXIT_FAILURE);
 			}
 		}
-		punc = dynamic_cast<Punctuation *>(tokens[i].get());
-		if (punc == nullptr || punc->type != Punctuation::Type::Semicolon) {
-			errorHandler->error(*tokens[i],
+		if (!cursor.isPunctuation(Punctuation::Type::Semicolon)) {
+			error(cursor.slice(),
 			      "Expected ';' following expression in `let` statement");
 			mustSynchronize = true;
 			return nullptr;
 		}
-		i++;
-		return std::make_unique<LetStatement>(*keyword, std::unique_ptr<Symbol>(symbol),
-		      std::unique_ptr<Symbol>(type), std::unique_ptr<Operator>(op),
-		      std::move(expr), punc);
+		Punctuation semicolon = cursor.punctuation();
+		cursor.advance();
+		return arena->make<LetStatement>(keyword, symbol, type, op, expr, &semicolon);
 	}
 
 	return nullptr;
 }
 
-std::unique_ptr<Expression> Parser::parseExpression() {
-	auto *p1 = dynamic_cast<Punctuation *>(tokens[i].get());
-	if (p1 != nullptr && (p1->type == Punctuation::Type::OpenBrace)) {
+Expression *Parser::parseExpression() {
+	if (cursor.isPunctuation(Punctuation::Type::OpenBrace)) {
 		return parseBlock();
 	}
 
 	return parseReturnBreakExpression();
 }
 
-std::unique_ptr<BlockExpression> Parser::parseBlock() {
-	auto *p1 = dynamic_cast<Punctuation *>(tokens[i].get());
-	if (p1 == nullptr || p1->type != Punctuation::Type::OpenBrace) {
-		errorHandler->error(*tokens[i], "Expected '{'");
+BlockExpression *Parser::parseBlock() {
+	NestingLevel level(depth);
+	if (depth > MAX_NESTING_DEPTH) {
+		return abandonNesting();
+	}
+	if (!cursor.isPunctuation(Punctuation::Type::OpenBrace)) {
+		error(cursor.slice(), "Expected '{'");
 		return nullptr;
 	}
-	std::vector<std::unique_ptr<Statement>> statements;
-	i++;
+	Punctuation p1 = cursor.punctuation();
+	ArenaVector<Statement *> statements = arena->makeVector<Statement *>();
+	cursor.advance();
 	while (true) {
-		std::unique_ptr<Statement> statement = parseStatement();
+		Statement *statement = parseStatement();
 		if (statement != nullptr) {
-			statements.push_back(std::move(statement));
+			statements.push_back(statement);
 			continue;
 		}
 		if (mustSynchronize) {
 			synchronize();
 			mustSynchronize = false;
-			auto *punc = dynamic_cast<Punctuation *>(tokens[i].get());
-			if (punc != nullptr) {
-				i++;
-				if (punc->type == Punctuation::Type::CloseBrace) {
-					return std::make_unique<BlockExpression>(*p1, std::move(statements),
-					      nullptr, *punc);
+			if (cursor.kind() == TokenKind::Punctuation) {
+				Punctuation punc = cursor.punctuation();
+				cursor.advance();
+				if (punc.type == Punctuation::Type::CloseBrace) {
+					return arena->make<BlockExpression>(p1, std::move(statements),
+					      nullptr, punc);
 				}
 			}
 			if (isAtEnd()) {
-				errorHandler->error(*tokens[i], "Expected '}'");
+				error(cursor.slice(), "Expected '}'");
 				return nullptr;
 			}
 			continue;
 		}
-		auto *p2 = dynamic_cast<Punctuation *>(tokens[i].get());
-		if (p2 != nullptr && p2->type == Punctuation::Type::CloseBrace) {
-			i++;
-			return std::make_unique<BlockExpression>(*p1, std::move(statements), nullptr,
-			      *p2);
+		if (cursor.isPunctuation(Punctuation::Type::CloseBrace)) {
+			Punctuation p2 = cursor.punctuation();
+			cursor.advance();
+			return arena->make<BlockExpression>(p1, std::move(statements), nullptr, p2);
 		}
 		if (isAtEnd()) {
-			errorHandler->error(*tokens[i], "Expected '}'");
+			error(cursor.slice(), "Expected '}'");
 			return nullptr;
 		}
-		std::unique_ptr<Expression> expr = parseExpression();
+		Expression *expr = parseExpression();
 		if (expr == nullptr) {
 			synchronize();
-			auto *punc = dynamic_cast<Punctuation *>(tokens[i].get());
-			if (punc != nullptr) {
-				i++;
-				if (punc->type == Punctuation::Type::CloseBrace) {
-					return std::make_unique<BlockExpression>(*p1, std::move(statements),
-					      nullptr, *punc);
+			if (cursor.kind() == TokenKind::Punctuation) {
+				Punctuation punc = cursor.punctuation();
+				cursor.advance();
+				if (punc.type == Punctuation::Type::CloseBrace) {
+					return arena->make<BlockExpression>(p1, std::move(statements),
+					      nullptr, punc);
 				}
 			}
 			if (isAtEnd()) {
-				errorHandler->error(*tokens[i], "Expected '}'");
+				error(cursor.slice(), "Expected '}'");
 				return nullptr;
 			}
 			continue;
 		}
-		auto *p3 = dynamic_cast<Punctuation *>(tokens[i].get());
-		if (p3 != nullptr && p3->type == Punctuation::Type::Semicolon) {
-			i++;
-			statements.push_back(
-			      std::make_unique<ExpressionStatement>(std::move(expr), *p3));
-		} else if (p3 != nullptr && p3->type == Punctuation::Type::CloseBrace) {
-			i++;
+		if (cursor.isPunctuation(Punctuation::Type::Semicolon)) {
+			Punctuation p3 = cursor.punctuation();
+			cursor.advance();
+			statements.push_back(arena->make<ExpressionStatement>(expr, p3));
+		} else if (cursor.isPunctuation(Punctuation::Type::CloseBrace)) {
+			Punctuation p3 = cursor.punctuation();
+			cursor.advance();
 			if (expr != nullptr) {
-				return std::make_unique<BlockExpression>(*p1, std::move(statements),
-				      std::move(expr), *p3);
+				return arena->make<BlockExpression>(p1, std::move(statements), expr, p3);
 			}
-			return std::make_unique<BlockExpression>(*p1, std::move(statements), nullptr,
-			      *p3);
-		} else if (dynamic_cast<BlockExpression *>(expr.get()) != nullptr) {
+			return arena->make<BlockExpression>(p1, std::move(statements), nullptr, p3);
+		} else if (isa<BlockExpression>(expr)) {
 			// A block expression can be a statement without semicolon if not at the end
 			// of the enclosing scope
-			statements.push_back(
-			      std::make_unique<ExpressionStatement>(std::unique_ptr<BlockExpression>(
-			            dynamic_cast<BlockExpression *>(expr.release()))));
-		} else if (dynamic_cast<IfElseExpression *>(expr.get()) != nullptr) {
+			statements.push_back(arena->make<ExpressionStatement>(expr));
+		} else if (isa<IfElseExpression>(expr)) {
 			// An if/else expression can be a statement without semicolon if not at the
 			// end of the enclosing scope
-			statements.push_back(
-			      std::make_unique<ExpressionStatement>(std::unique_ptr<IfElseExpression>(
-			            dynamic_cast<IfElseExpression *>(expr.release()))));
-		} else if (dynamic_cast<WhileExpression *>(expr.get()) != nullptr) {
+			statements.push_back(arena->make<ExpressionStatement>(expr));
+		} else if (isa<WhileExpression>(expr)) {
 			// A while expression can be a statement without semicolon if not at the end
 			// of the enclosing scope
-			statements.push_back(
-			      std::make_unique<ExpressionStatement>(std::unique_ptr<WhileExpression>(
-			            dynamic_cast<WhileExpression *>(expr.release()))));
+			statements.push_back(arena->make<ExpressionStatement>(expr));
 		} else {
-			errorHandler->error(*tokens[i], "Expected '}'");
+			error(cursor.slice(), "Expected '}'");
 			return nullptr;
 		}
 	}
 }
 
-std::unique_ptr<IfElseExpression> Parser::parseIfElse() {
-	auto *keyword = dynamic_cast<Keyword *>(tokens[i].get());
-	if (keyword == nullptr || keyword->type != Keyword::Type::IF) {
-		errorHandler->error(*tokens[i], "Expected keyword `if`");
+IfElseExpression *Parser::parseIfElse() {
+	NestingLevel level(depth);
+	if (depth > MAX_NESTING_DEPTH) {
+		return abandonNesting();
+	}
+	if (!cursor.isKeyword(Keyword::Type::IF)) {
+		error(cursor.slice(), "Expected keyword `if`");
 		return nullptr;
 	}
-	i++;
+	Keyword keyword = cursor.keyword();
+	cursor.advance();
 	auto condition = parseExpression();
-	auto *p1 = dynamic_cast<Punctuation *>(tokens[i].get());
-	if (p1 == nullptr || p1->type != Punctuation::Type::OpenBrace) {
-		errorHandler->error(*tokens[i], "Expected '{'");
+	if (!cursor.isPunctuation(Punctuation::Type::OpenBrace)) {
+		error(cursor.slice(), "Expected '{'");
 		return nullptr;
 	}
 	auto thenBlock = parseBlock();
 	if (thenBlock == nullptr) {
 		return nullptr;
 	}
-	auto *keyword2 = dynamic_cast<Keyword *>(tokens[i].get());
-	if (keyword2 == nullptr || keyword2->type != Keyword::Type::ELSE) {
-		return std::make_unique<IfElseExpression>(*keyword, std::move(condition),
-		      std::move(thenBlock));
+	if (!cursor.isKeyword(Keyword::Type::ELSE)) {
+		return arena->make<IfElseExpression>(keyword, condition, thenBlock);
 	}
-	i++;
-	auto *keyword3 = dynamic_cast<Keyword *>(tokens[i].get());
-	if (keyword3 != nullptr && keyword3->type == Keyword::Type::IF) {
+	Keyword keyword2 = cursor.keyword();
+	cursor.advance();
+	if (cursor.isKeyword(Keyword::Type::IF)) {
 		auto ifelse = parseIfElse();
 		if (ifelse == nullptr) {
 			return nullptr;
 		}
-		return std::make_unique<IfElseExpression>(*keyword, std::move(condition),
-		      std::move(thenBlock), *keyword2, std::move(ifelse));
+		return arena->make<IfElseExpression>(keyword, condition, thenBlock, keyword2,
+		      ifelse);
 	}
-	auto *p2 = dynamic_cast<Punctuation *>(tokens[i].get());
-	if (p2 == nullptr || p2->type != Punctuation::Type::OpenBrace) {
-		errorHandler->error(*tokens[i], "Expected '{'");
+	if (!cursor.isPunctuation(Punctuation::Type::OpenBrace)) {
+		error(cursor.slice(), "Expected '{'");
 		return nullptr;
 	}
 	auto elseExpression = parseBlock();
 	if (elseExpression == nullptr) {
 		return nullptr;
 	}
-	return std::make_unique<IfElseExpression>(*keyword, std::move(condition),
-	      std::move(thenBlock), *keyword2, std::move(elseExpression));
+	return arena->make<IfElseExpression>(keyword, condition, thenBlock, keyword2,
+	      elseExpression);
 }
 
-std::unique_ptr<WhileExpression> Parser::parseWhile() {
-	auto *keyword = dynamic_cast<Keyword *>(tokens[i].get());
-	if (keyword == nullptr || keyword->type != Keyword::Type::WHILE) {
-		errorHandler->error(*tokens[i], "Expected keyword `while`");
+WhileExpression *Parser::parseWhile() {
+	if (!cursor.isKeyword(Keyword::Type::WHILE)) {
+		error(cursor.slice(), "Expected keyword `while`");
 		return nullptr;
 	}
-	i++;
+	Keyword keyword = cursor.keyword();
+	cursor.advance();
 	auto condition = parseExpression();
-	auto *p1 = dynamic_cast<Punctuation *>(tokens[i].get());
-	if (p1 == nullptr || p1->type != Punctuation::Type::OpenBrace) {
-		errorHandler->error(*tokens[i], "Expected '{'");
+	if (!cursor.isPunctuation(Punctuation::Type::OpenBrace)) {
+		error(cursor.slice(), "Expected '{'");
 		return nullptr;
 	}
 	auto block = parseBlock();
 	if (block == nullptr) {
 		return nullptr;
 	}
-	return std::make_unique<WhileExpression>(*keyword, std::move(condition),
-	      std::move(block));
+	return arena->make<WhileExpression>(keyword, condition, block);
 }
 
-std::unique_ptr<Expression> Parser::parseReturnBreakExpression() {
-	auto *keyword = dynamic_cast<Keyword *>(tokens[i].get());
-	if (keyword != nullptr && keyword->type == Keyword::Type::RETURN) {
-		i++;
-		auto *punc = dynamic_cast<Punctuation *>(tokens[i].get());
-		if (punc != nullptr
-		      && (punc->type == Punctuation::Type::Semicolon
-		            || punc->type == Punctuation::Type::CloseBrace
-		            || punc->type == Punctuation::Type::CloseParen
-		            || punc->type == Punctuation::Type::Comma)) {
-			return std::make_unique<ReturnExpression>(*keyword, nullptr);
-		}
-		std::unique_ptr<Expression> expr = parseReturnBreakExpression();
-		return std::make_unique<ReturnExpression>(*keyword, std::move(expr));
-	}
-	return parseAssignmentExpression();
-}
-
-std::unique_ptr<Expression> Parser::parseAssignmentExpression() {
-	std::unique_ptr<Expression> expr = parseLogicalOrExpression();
-	if (expr == nullptr) {
-		return nullptr;
-	}
-	auto *op = dynamic_cast<Operator *>(tokens[i].get());
-	if (op != nullptr && (op->type == Operator::Type::Assignment)) {
-		op = dynamic_cast<Operator *>(tokens[i++].release());
-		std::unique_ptr<Expression> expr2 = parseAssignmentExpression();
-		if (expr2 == nullptr) {
-			return nullptr;
+Expression *Parser::parseReturnBreakExpression() {
+	if (cursor.isKeyword(Keyword::Type::RETURN)) {
+		Keyword keyword = cursor.keyword();
+		cursor.advance();
+		if (cursor.isPunctuation(Punctuation::Type::Semicolon)
+		      || cursor.isPunctuation(Punctuation::Type::CloseBrace)
+		      || cursor.isPunctuation(Punctuation::Type::CloseParen)
+		      || cursor.isPunctuation(Punctuation::Type::Comma)) {
+			return arena->make<ReturnExpression>(keyword, nullptr);
 		}
-		return std::make_unique<BinaryExpression>(std::unique_ptr<Operator>(op),
-		      std::move(expr), std::move(expr2));
-	}
-	return expr;
-}
-
-std::unique_ptr<Expression> Parser::parseLogicalOrExpression() {
-	std::unique_ptr<Expression> expr = parseLogicalAndExpression();
-	if (expr == nullptr) {
-		return nullptr;
-	}
-	while (true) {
-		auto *op = dynamic_cast<Operator *>(tokens[i].get());
-		if (op != nullptr && op->type == Operator::Type::LogicalOr) {
-			op = dynamic_cast<Operator *>(tokens[i++].release());
-			std::unique_ptr<Expression> expr2 = parseLogicalAndExpression();
-			if (expr2 == nullptr) {
-				return nullptr;
-			}
-			expr = std::make_unique<BinaryExpression>(std::unique_ptr<Operator>(op),
-			      std::move(expr), std::move(expr2));
-		} else {
-			return expr;
+		NestingLevel level(depth);
+		if (depth > MAX_NESTING_DEPTH) {
+			return abandonNesting();
 		}
+		Expression *expr = parseReturnBreakExpression();
+		return arena->make<ReturnExpression>(keyword, expr);
 	}
+	return parseBinaryExpression(Precedence::Assignment);
 }
 
-std::unique_ptr<Expression> Parser::parseLogicalAndExpression() {
-	std::unique_ptr<Expression> expr = parseRelationalExpression();
+Expression *Parser::parseBinaryExpression(Precedence minimum) {
+	Expression *expr = parseUnaryExpression();
 	if (expr == nullptr) {
 		return nullptr;
 	}
-	while (true) {
-		auto *op = dynamic_cast<Operator *>(tokens[i].get());
-		if (op != nullptr && op->type == Operator::Type::LogicalAnd) {
-			op = dynamic_cast<Operator *>(tokens[i++].release());
-			std::unique_ptr<Expression> expr2 = parseRelationalExpression();
-			if (expr2 == nullptr) {
-				return nullptr;
-			}
-			expr = std::make_unique<BinaryExpression>(std::unique_ptr<Operator>(op),
-			      std::move(expr), std::move(expr2));
-		} else {
+	while (cursor.kind() == TokenKind::Operator) {
+		const OperatorSyntax &syntax = operatorSyntax(cursor.getOperatorType());
+		if (syntax.precedence == Precedence::None || syntax.precedence < minimum) {
 			return expr;
 		}
-	}
-}
-
-std::unique_ptr<Expression> Parser::parseRelationalExpression() {
-	std::unique_ptr<Expression> expr = parseBitwiseOrExpression();
-	if (expr == nullptr) {
-		return nullptr;
-	}
-	while (true) {
-		auto *op = dynamic_cast<Operator *>(tokens[i].get());
-		if (op != nullptr
-		      && (op->type == Operator::Type::Equality
-		            || op->type == Operator::Type::Inequality
-		            || op->type == Operator::Type::LessThan
-		            || op->type == Operator::Type::LessThanOrEqual
-		            || op->type == Operator::Type::GreaterThan
-		            || op->type == Operator::Type::GreaterThanOrEqual)) {
-			op = dynamic_cast<Operator *>(tokens[i++].release());
-			std::unique_ptr<Expression> expr2 = parseBitwiseOrExpression();
-			if (expr2 == nullptr) {
-				return nullptr;
-			}
-			expr = std::make_unique<BinaryExpression>(std::unique_ptr<Operator>(op),
-			      std::move(expr), std::move(expr2));
-		} else {
-			return expr;
-		}
-	}
-}
-
-std::unique_ptr<Expression> Parser::parseBitwiseOrExpression() {
-	std::unique_ptr<Expression> expr = parseBitwiseXorExpression();
-	if (expr == nullptr) {
-		return nullptr;
-	}
-	while (true) {
-		auto *op = dynamic_cast<Operator *>(tokens[i].get());
-		if (op != nullptr && op->type == Operator::Type::BitwiseOr) {
-			op = dynamic_cast<Operator *>(tokens[i++].release());
-			std::unique_ptr<Expression> expr2 = parseBitwiseXorExpression();
-			if (expr2 == nullptr) {
-				return nullptr;
-			}
-			expr = std::make_unique<BinaryExpression>(std::unique_ptr<Operator>(op),
-			      std::move(expr), std::move(expr2));
-		} else {
-			return expr;
+		Operator *op = cursor.createOperator(*arena);
+		cursor.advance();
+		// The right operand of a left-associative Operator stops at the next Operator of
+		// the same Precedence, so that the loop here folds it in from the left instead
+		Precedence next = syntax.precedence;
+		if (!syntax.rightAssociative) {
+			next = static_cast<Precedence>(static_cast<uint8_t>(next) + 1);
 		}
-	}
-}
-
-std::unique_ptr<Expression> Parser::parseBitwiseXorExpression() {
-	std::unique_ptr<Expression> expr = parseBitwiseAndExpression();
-	if (expr == nullptr) {
-		return nullptr;
-	}
-	while (true) {
-		auto *op = dynamic_cast<Operator *>(tokens[i].get());
-		if (op != nullptr && op->type == Operator::Type::BitwiseXor) {
-			op = dynamic_cast<Operator *>(tokens[i++].release());
-			std::unique_ptr<Expression> expr2 = parseBitwiseAndExpression();
-			if (expr2 == nullptr) {
-				return nullptr;
-			}
-			expr = std::make_unique<BinaryExpression>(std::unique_ptr<Operator>(op),
-			      std::move(expr), std::move(expr2));
-		} else {
-			return expr;
+		NestingLevel level(depth);
+		if (depth > MAX_NESTING_DEPTH) {
+			return abandonNesting();
 		}
-	}
-}
-
-std::unique_ptr<Expression> Parser::parseBitwiseAndExpression() {
-	std::unique_ptr<Expression> expr = parseBitshiftExpression();
-	if (expr == nullptr) {
-		return nullptr;
-	}
-	while (true) {
-		auto *op = dynamic_cast<Operator *>(tokens[i].get());
-		if (op != nullptr && op->type == Operator::Type::BitwiseAnd) {
-			op = dynamic_cast<Operator *>(tokens[i++].release());
-			std::unique_ptr<Expression> expr2 = parseBitshiftExpression();
-			if (expr2 == nullptr) {
-				return nullptr;
-			}
-			expr = std::make_unique<BinaryExpression>(std::unique_ptr<Operator>(op),
-			      std::move(expr), std::move(expr2));
-		} else {
-			return expr;
+		Expression *expr2 = parseBinaryExpression(next);
+		if (expr2 == nullptr) {
+			return nullptr;
 		}
+		expr = arena->make<BinaryExpression>(op, expr, expr2);
 	}
+	return expr;
 }
 
-std::unique_ptr<Expression> Parser::parseBitshiftExpression() {
-	std::unique_ptr<Expression> expr = parseAdditiveExpression();
-	if (expr == nullptr) {
-		return nullptr;
+Expression *Parser::parseUnaryExpression() {
+	NestingLevel level(depth);
+	if (depth > MAX_NESTING_DEPTH) {
+		return abandonNesting();
 	}
-	while (true) {
-		auto *op = dynamic_cast<Operator *>(tokens[i].get());
-		if (op != nullptr
-		      && (op->type == Operator::Type::BitwiseShiftLeft
-		            || op->type == Operator::Type::BitwiseShiftRight)) {
-			op = dynamic_cast<Operator *>(tokens[i++].release());
-			std::unique_ptr<Expression> expr2 = parseAdditiveExpression();
-			if (expr2 == nullptr) {
-				return nullptr;
-			}
-			expr = std::make_unique<BinaryExpression>(std::unique_ptr<Operator>(op),
-			      std::move(expr), std::move(expr2));
-		} else {
-			return expr;
+	if (cursor.kind() == TokenKind::Operator
+	      && operatorSyntax(cursor.getOperatorType()).prefix) {
+		Operator *op = cursor.createOperator(*arena);
+		cursor.advance();
+		Expression *expr = parseUnaryExpression();
+		if (expr == nullptr) {
+			return nullptr;
 		}
+		return arena->make<UnaryExpression>(op, expr);
 	}
-}
-
-std::unique_ptr<Expression> Parser::parseAdditiveExpression() {
-	std::unique_ptr<Expression> expr = parseMultiplicativeExpression();
+	Expression *expr = parsePrimaryExpression();
 	if (expr == nullptr) {
 		return nullptr;
 	}
-	while (true) {
-		auto *op = dynamic_cast<Operator *>(tokens[i].get());
-		if (op != nullptr
-		      && (op->type == Operator::Type::Addition
-		            || op->type == Operator::Type::Subtraction)) {
-			op = dynamic_cast<Operator *>(tokens[i++].release());
-			std::unique_ptr<Expression> expr2 = parseMultiplicativeExpression();
-			if (expr2 == nullptr) {
-				return nullptr;
-			}
-			expr = std::make_unique<BinaryExpression>(std::unique_ptr<Operator>(op),
-			      std::move(expr), std::move(expr2));
-		} else {
-			return expr;
-		}
+	if (cursor.isPunctuation(Punctuation::Type::OpenParen)) {
+		return parseFunctionCallExpression(expr);
 	}
+	return expr;
 }
 
-std::unique_ptr<Expression> Parser::parseMultiplicativeExpression() {
-	std::unique_ptr<Expression> expr = parseUnaryExpression();
-	if (expr == nullptr) {
-		return nullptr;
-	}
-	while (true) {
-		auto *op = dynamic_cast<Operator *>(tokens[i].get());
-		if (op != nullptr
-		      && (op->type == Operator::Type::Multiplication
-		            || op->type == Operator::Type::Division
-		            || op->type == Operator::Type::Modulus)) {
-			op = dynamic_cast<Operator *>(tokens[i++].release());
-			std::unique_ptr<Expression> expr2 = parseUnaryExpression();
-			if (expr2 == nullptr) {
-				return nullptr;
-			}
-			expr = std::make_unique<BinaryExpression>(std::unique_ptr<Operator>(op),
-			      std::move(expr), std::move(expr2));
-		} else {
-			return expr;
+Expression *Parser::parseFunctionCallExpression(Expression *function) {
+	Punctuation p1 = cursor.punctuation();
+	cursor.advance();
+	ArenaVector<Expression *> arguments = arena->makeVector<Expression *>();
+	while (!cursor.isPunctuation(Punctuation::Type::CloseParen)) {
+		Expression *arg = parseExpression();
+		if (arg == nullptr) {
+			return nullptr;
 		}
-	}
-}
-
-std::unique_ptr<Expression> Parser::parseUnaryExpression() {
-	auto *op = dynamic_cast<Operator *>(tokens[i].get());
-	if (op != nullptr
-	      && (op->type == Operator::Type::LogicalNot
-	            || op->type == Operator::Type::BitwiseNot
-	            || op->type == Operator::Type::Subtraction
-	            || op->type == Operator::Type::Addition)) {
-		op = dynamic_cast<Operator *>(tokens[i++].release());
-		std::unique_ptr<Expression> expr = parseUnaryExpression();
-		if (expr == nullptr) {
+		arguments.push_back(arg);
+		if (cursor.kind() != TokenKind::Punctuation) {
+			error(cursor.slice(), "Expected ',' or ')'");
 			return nullptr;
 		}
-		return std::make_unique<UnaryExpression>(std::unique_ptr<Operator>(op),
-		      std::move(expr));
-	}
-	return parseFunctionCallExpression();
-}
-
-std::unique_ptr<Expression> Parser::parseFunctionCallExpression() {
-	std::unique_ptr<Expression> expr = parsePrimaryExpression();
-	if (expr == nullptr) {
-		return nullptr;
-	}
-	auto *p1 = dynamic_cast<Punctuation *>(tokens[i].get());
-	if (p1 != nullptr && (p1->type == Punctuation::Type::OpenParen)) {
-		i++;
-		std::vector<std::unique_ptr<Expression>> arguments;
-		auto *p2 = dynamic_cast<Punctuation *>(tokens[i].get());
-		while (p2 == nullptr || p2->type != Punctuation::Type::CloseParen) {
-			std::unique_ptr<Expression> arg = parseExpression();
-			if (arg == nullptr) {
-				return nullptr;
-			}
-			arguments.push_back(std::move(arg));
-			p2 = dynamic_cast<Punctuation *>(tokens[i].get());
-			if (p2 == nullptr) {
-				errorHandler->error(*tokens[i], "Expected ',' or ')'");
-				return nullptr;
-			}
-			if (p2->type == Punctuation::Type::CloseParen) {
-				break;
-			}
-			if (p2->type != Punctuation::Type::Comma) {
-				errorHandler->error(*tokens[i], "Expected ',' or ')'");
-				return nullptr;
-			}
-			i++;
+		if (cursor.isPunctuation(Punctuation::Type::CloseParen)) {
+			break;
+		}
+		if (!cursor.isPunctuation(Punctuation::Type::Comma)) {
+			error(cursor.slice(), "Expected ',' or ')'");
+			return nullptr;
 		}
-		i++;
-		return std::make_unique<FunctionCallExpression>(std::move(expr), *p1,
-		      std::move(arguments), *p2);
+		cursor.advance();
 	}
-	return expr;
+	Punctuation p2 = cursor.punctuation();
+	cursor.advance();
+	return arena->make<FunctionCallExpression>(function, p1, std::move(arguments), p2);
 }
 
-std::unique_ptr<Expression> Parser::parsePrimaryExpression() {
-	auto *integerLiteral = dynamic_cast<IntegerLiteral *>(tokens[i].get());
-	if (integerLiteral != nullptr) {
-		integerLiteral = dynamic_cast<IntegerLiteral *>(tokens[i++].release());
-		return std::make_unique<IntegerLiteralExpression>(
-		      std::unique_ptr<IntegerLiteral>(integerLiteral));
-	}
-
-	auto *boolLiteral = dynamic_cast<BoolLiteral *>(tokens[i].get());
-	if (boolLiteral != nullptr) {
-		boolLiteral = dynamic_cast<BoolLiteral *>(tokens[i++].release());
-		return std::make_unique<BoolLiteralExpression>(
-		      std::unique_ptr<BoolLiteral>(boolLiteral));
-	}
-
-	auto *charLiteral = dynamic_cast<CharacterLiteral *>(tokens[i].get());
-	if (charLiteral != nullptr) {
-		charLiteral = dynamic_cast<CharacterLiteral *>(tokens[i++].release());
-		return std::make_unique<CharacterLiteralExpression>(
-		      std::unique_ptr<CharacterLiteral>(charLiteral));
-	}
-
-	auto *symbol = dynamic_cast<Symbol *>(tokens[i].get());
-	if (symbol != nullptr) {
-		symbol = dynamic_cast<Symbol *>(tokens[i++].release());
-		return std::make_unique<SymbolExpression>(std::unique_ptr<Symbol>(symbol));
+Expression *Parser::parsePrimaryExpression() {
+	switch (cursor.kind()) {
+		case TokenKind::IntegerLiteral: {
+			auto literal = arena->make<IntegerLiteralExpression>(
+			      cursor.createIntegerLiteral(*arena));
+			cursor.advance();
+			return literal;
+		}
+		case TokenKind::BoolLiteral: {
+			auto literal
+			      = arena->make<BoolLiteralExpression>(cursor.createBoolLiteral(*arena));
+			cursor.advance();
+			return literal;
+		}
+		case TokenKind::CharacterLiteral: {
+			auto literal = arena->make<CharacterLiteralExpression>(
+			      cursor.createCharacterLiteral(*arena));
+			cursor.advance();
+			return literal;
+		}
+		case TokenKind::Symbol: {
+			auto symbol = arena->make<SymbolExpression>(cursor.createSymbol(*arena));
+			cursor.advance();
+			return symbol;
+		}
+		default:
+			break;
 	}
 
-	auto *p1 = dynamic_cast<Punctuation *>(tokens[i].get());
-	if (p1 != nullptr && (p1->type == Punctuation::Type::OpenParen)) {
-		i++;
+	if (cursor.isPunctuation(Punctuation::Type::OpenParen)) {
+		Punctuation p1 = cursor.punctuation();
+		cursor.advance();
 		auto expr = parseExpression();
-		auto *p2 = dynamic_cast<Punctuation *>(tokens[i].get());
-		if (p2 == nullptr || p2->type != Punctuation::Type::CloseParen) {
-			errorHandler->error(*tokens[i], "Expected ')'");
+		if (!cursor.isPunctuation(Punctuation::Type::CloseParen)) {
+			error(cursor.slice(), "Expected ')'");
 			return nullptr;
 		}
-		i++;
-		return std::make_unique<ParenthesizedExpression>(*p1, std::move(expr), *p2);
+		Punctuation p2 = cursor.punctuation();
+		cursor.advance();
+		return arena->make<ParenthesizedExpression>(p1, expr, p2);
 	}
-	if (p1 != nullptr && (p1->type == Punctuation::Type::OpenBrace)) {
+	if (cursor.isPunctuation(Punctuation::Type::OpenBrace)) {
 		return parseBlock();
 	}
 
-	auto *keyword = dynamic_cast<Keyword *>(tokens[i].get());
-	if (keyword != nullptr && keyword->type == Keyword::Type::IF) {
+	if (cursor.isKeyword(Keyword::Type::IF)) {
 		return parseIfElse();
 	}
-	if (keyword != nullptr && keyword->type == Keyword::Type::WHILE) {
+	if (cursor.isKeyword(Keyword::Type::WHILE)) {
 		return parseWhile();
 	}
 
-	errorHandler->error(*tokens[i], "Expected expression");
+	error(cursor.slice(), "Expected expression");
 	return nullptr;
 }
 
 void Parser::synchronize() {
 	while (!isAtEnd()) {
-		auto *p = dynamic_cast<Punctuation *>(tokens[i].get());
-		if (p != nullptr
-		      && (p->type == Punctuation::Type::Semicolon
-		            || p->type == Punctuation::Type::CloseBrace)) {
+		if (cursor.isPunctuation(Punctuation::Type::Semicolon)
+		      || cursor.isPunctuation(Punctuation::Type::CloseBrace)) {
 			return;
 		}
-		i++;
+		cursor.advance();
+	}
+}
+
+std::nullptr_t Parser::abandonNesting() {
+	error(cursor.slice(), "Expression is nested too deeply");
+	nestedTooDeeply = true;
+	cursor.skipToEnd();
+	return nullptr;
+}
+
+void Parser::error(const Slice &slice, std::string message) {
+	reportedError = true;
+	if (!nestedTooDeeply && errorHandler != nullptr) {
+		errorHandler->error(slice, std::move(message));
 	}
 }
 
 bool Parser::isAtEnd() const {
-	return dynamic_cast<EndOfFile *>(tokens[i].get()) != nullptr;
+	return cursor.isAtEnd();
 }
@@ -1,51 +1,136 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include "arena.h"
 #include "ast.h"
 #include "errorhandler.h"
+#include "threadpool.h"
+#include "tokenbuffer.h"
 #include "tokens.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
+/**
+ * @brief How tightly a binary Operator binds its operands, from loosest to tightest
+ *
+ */
+enum class Precedence : uint8_t {
+	None,
+	Assignment,
+	LogicalOr,
+	LogicalAnd,
+	Relational,
+	BitwiseOr,
+	BitwiseXor,
+	BitwiseAnd,
+	Bitshift,
+	Additive,
+	Multiplicative,
+};
+
 /**
  * @brief Parses a series of Tokens into an AST
  *
  */
 class Parser {
-	std::vector<std::unique_ptr<Token>> tokens;
+	/**
+	 * @brief A top-level function spanning the Tokens in [begin, end), as found by
+	 * matching braces, which may have been parsed ahead of time
+	 *
+	 */
+	struct ParsedFunction {
+		size_t begin;
+		size_t end;
+		// Both nullptr unless the function parsed without errors and ended at end
+		Symbol *name = nullptr;
+		Function *function = nullptr;
+	};
+
+	// Empty while parsing ahead of time, when the Tokens belong to another Parser
+	std::optional<TokenBuffer> ownedTokens;
+	const TokenBuffer *tokens;
+	TokenCursor cursor;
+	// Null while parsing ahead of time, when errors are only recorded in reportedError
 	ErrorHandler *errorHandler;
-	size_t i = 0;
+	// The Arena of the Module being parsed, from which every node is allocated
+	Arena *arena = nullptr;
 	bool mustSynchronize = false;
-	std::filesystem::path source;
+	// How many constructs enclose the one being parsed
+	size_t depth = 0;
+	// Set once MAX_NESTING_DEPTH has been exceeded, after which the rest of the Tokens
+	// are skipped and no further errors are reported
+	bool nestedTooDeeply = false;
+	bool reportedError = false;
+	// Parses top-level functions in parallel if not null
+	ThreadPool *threadPool = nullptr;
+
+	/**
+	 * @brief Construct a Parser which parses functions ahead of time from another
+	 * Parser's Tokens, which it refers to rather than owning a copy
+	 */
+	Parser(const TokenBuffer &tokens, Arena *arena);
 public:
-	Parser(std::filesystem::path source, std::vector<std::unique_ptr<Token>> tokens,
-	      ErrorHandler *errorHandler);
+	// How deeply constructs may nest. Each level recurses in the Parser and in every pass
+	// over the AST, so it is capped to bound their use of the native stack
+	static constexpr size_t MAX_NESTING_DEPTH = 2048;
+
+	Parser(TokenBuffer tokens, ErrorHandler *errorHandler,
+	      ThreadPool *threadPool = nullptr);
+	// The cursor may refer to this Parser's own TokenBuffer
+	Parser(const Parser &) = delete;
+	Parser &operator=(const Parser &) = delete;
+	/**
+	 * @brief Parses the Tokens into a Module. Given a ThreadPool, each top-level
+	 * function is first parsed on its own in parallel. The Tokens are then parsed in
+	 * sequence as usual, except that a function parsed ahead of time without errors is
+	 * taken as is once they reach it, so the result and errors are the same either way
+	 */
 	std::unique_ptr<Module> parse();
 	~Parser() = default;
 private:
-	std::pair<std::unique_ptr<Symbol>, std::unique_ptr<Function>> parseFunction();
-	std::unique_ptr<Statement> parseStatement();
-	std::unique_ptr<Expression> parseExpression();
-	std::unique_ptr<BlockExpression> parseBlock();
-	std::unique_ptr<IfElseExpression> parseIfElse();
-	std::unique_ptr<WhileExpression> parseWhile();
-	std::unique_ptr<Expression> parseReturnBreakExpression();
-	std::unique_ptr<Expression> parseAssignmentExpression();
-	std::unique_ptr<Expression> parseLogicalOrExpression();
-	std::unique_ptr<Expression> parseLogicalAndExpression();
-	std::unique_ptr<Expression> parseRelationalExpression();
-	std::unique_ptr<Expression> parseBitwiseOrExpression();
-	std::unique_ptr<Expression> parseBitwiseXorExpression();
-	std::unique_ptr<Expression> parseBitwiseAndExpression();
-	std::unique_ptr<Expression> parseBitshiftExpression();
-	std::unique_ptr<Expression> parseAdditiveExpression();
-	std::unique_ptr<Expression> parseMultiplicativeExpression();
-	std::unique_ptr<Expression> parseUnaryExpression();
-	std::unique_ptr<Expression> parseFunctionCallExpression();
-	std::unique_ptr<Expression> parsePrimaryExpression();
+	/**
+	 * @brief Finds the range of Tokens of each top-level function by matching braces,
+	 * without parsing them
+	 */
+	std::vector<ParsedFunction> findFunctions() const;
+	/**
+	 * @brief Parses each top-level function on the ThreadPool, in Arenas which are
+	 * handed to module
+	 */
+	std::vector<ParsedFunction> parseFunctionsInParallel(Module &module);
+	std::pair<Symbol *, Function *> parseFunction();
+	Statement *parseStatement();
+	Expression *parseExpression();
+	BlockExpression *parseBlock();
+	IfElseExpression *parseIfElse();
+	WhileExpression *parseWhile();
+	Expression *parseReturnBreakExpression();
+	/**
+	 * @brief Parses a chain of binary expressions by precedence climbing, stopping at
+	 * the first Operator which binds more loosely than minimum
+	 *
+	 * @param minimum the loosest Precedence to consume
+	 * @return the parsed Expression, or nullptr on error
+	 */
+	Expression *parseBinaryExpression(Precedence minimum);
+	Expression *parseUnaryExpression();
+	Expression *parseFunctionCallExpression(Expression *function);
+	Expression *parsePrimaryExpression();
 	void synchronize();
+	/**
+	 * @brief Reports that MAX_NESTING_DEPTH has been exceeded and skips to the end of the
+	 * Tokens, as nothing that follows can be parsed reliably
+	 *
+	 * @return nullptr, for the caller to return in place of the construct
+	 */
+	std::nullptr_t abandonNesting();
+	void error(const Slice &slice, std::string message);
 	bool isAtEnd() const;
 };
 
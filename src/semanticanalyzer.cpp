@@ -1,33 +1,48 @@
 #include "semanticanalyzer.h"
 
+#include "arena.h"
 #include "ast.h"
+#include "builtinapi.h"
+#include "casting.h"
 #include "errorhandler.h"
-#include <nlohmann/json.hpp>
-using json = nlohmann::json;
+#include "interner.h"
+#include "sourcemanager.h"
+#include "symboltable.h"
+#include "threadpool.h"
 
 #include <array>
+#include <cstddef>
 #include <initializer_list>
 #include <memory>
 #include <span>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 static void addDefaultOperators(Module *module);
 static void addDefaultIntegerOperators(Module *module);
 static void addSameSignIntegerArithmeticTypes(Module *module,
-      std::span<const std::string_view> types,
+      std::span<const int> types,
       std::span<const Operator::Type> binaryOperators,
       std::span<const Operator::Type> unaryOperators);
 static void addSameSignIntegerComparisonTypes(Module *module,
-      std::span<const std::string_view> types,
+      std::span<const int> types,
       std::span<const Operator::Type> comparisonOperators);
 static void addDefaultBoolOperators(Module *module);
-static void addRuntimeFunctions(Module *module, std::istream &builtinApiJsonFile);
+static void addBuiltinFunction(Module *module, std::string_view name,
+      std::span<const BuiltinParameter> parameters, std::string_view returnType);
+static void addRuntimeFunctions(Module *module, const BuiltinApi &builtinApi);
 
 SemanticAnalyzer::SemanticAnalyzer(Module *module, ErrorHandler *errorHandler,
-      std::istream &builtinApiJsonFile)
-    : module(module), errorHandler(errorHandler), builtinApiJsonFile(builtinApiJsonFile) {
+      ThreadPool *threadPool)
+    : module(module), errorHandler(errorHandler), threadPool(threadPool) {
+}
+
+SemanticAnalyzer::SemanticAnalyzer(Module *module, ErrorHandler *errorHandler,
+      const BuiltinApi &builtinApi, ThreadPool *threadPool)
+    : module(module), errorHandler(errorHandler), builtinApi(&builtinApi),
+      threadPool(threadPool) {
 }
 
 void SemanticAnalyzer::analyze() {
@@ -36,13 +51,13 @@ void SemanticAnalyzer::analyze() {
 
 void SemanticAnalyzer::visit(FunctionCallExpression &node) {
 	Expression &functionCall = node.getFunction();
-	auto *symbol = dynamic_cast<SymbolExpression *>(&functionCall);
+	auto *symbol = dyn_cast<SymbolExpression>(&functionCall);
 	if (symbol == nullptr) {
 		errorHandler->error(functionCall.getSlice(),
 		      "Function call target is not a symbol");
 		return;
 	}
-	Function *function = module->getFunction(symbol->getSymbol().s.contents);
+	Function *function = module->getFunction(symbol->getSymbol().id);
 	if (function == nullptr) {
 		errorHandler->error(symbol->getSymbol().s,
 		      "Function " + std::string(symbol->getSymbol().s.contents) + " not found");
@@ -52,7 +67,7 @@ void SemanticAnalyzer::visit(FunctionCallExpression &node) {
 	function->forEachParameter(
 	      [&parameters, &function](Symbol &parameter, [[maybe_unused]]
 	                                                  Symbol &type) {
-		      int typeId = function->getBody().getSymbolType(parameter.s.contents);
+		      int typeId = function->getBody().getSymbolType(parameter.id);
 		      parameters.emplace_back(parameter, typeId);
 	      });
 
@@ -96,7 +111,7 @@ void SemanticAnalyzer::visit(FunctionCallExpression &node) {
 		if (!unreachableHandled) {
 			errorHandler->error(node.getSlice(), "Unreachable function call");
 		}
-		node.setTypeID(module->getType("!").id);
+		node.setTypeID(Type::NEVER);
 		return;
 	}
 
@@ -104,34 +119,39 @@ void SemanticAnalyzer::visit(FunctionCallExpression &node) {
 }
 
 void SemanticAnalyzer::visit(BinaryExpression &node) {
-	Expression &left = node.getLeft();
-	Expression &right = node.getRight();
-	left.accept(*this);
-	if (inUnreachableCode) {
-		errorHandler->error(node.getOperator().s, "Unreachable code");
-		return;
-	}
-	right.accept(*this);
-	if (inUnreachableCode) {
-		errorHandler->error(node.getOperator().s, "Unreachable code");
-		return;
-	}
-	if (node.getOperator().type == Operator::Type::Assignment
-	      && (dynamic_cast<SymbolExpression *>(&left) == nullptr)) {
-		errorHandler->error(left.getSlice(),
-		      "Left side of assignment must be a variable");
-		return;
-	}
-	if (left.getTypeID() == -1 || right.getTypeID() == -1) {
-		return;
-	}
-	int typeID = module->getBinaryOperator(node.getOperator().type, left.getTypeID(),
-	      right.getTypeID());
-	if (typeID == -1) {
-		errorHandler->error(node.getOperator().s,
-		      "Binary operator not defined for types");
+	std::vector<BinaryExpression *> chain = node.getLeftChain();
+	chain.back()->getLeft().accept(*this);
+	// Each link is checked as though its left side had just been visited
+	for (auto it = chain.rbegin(); it != chain.rend(); it++) {
+		BinaryExpression &link = **it;
+		Expression &left = link.getLeft();
+		Expression &right = link.getRight();
+		if (inUnreachableCode) {
+			errorHandler->error(link.getOperator().s, "Unreachable code");
+			continue;
+		}
+		right.accept(*this);
+		if (inUnreachableCode) {
+			errorHandler->error(link.getOperator().s, "Unreachable code");
+			continue;
+		}
+		if (link.getOperator().type == Operator::Type::Assignment
+		      && !isa<SymbolExpression>(left)) {
+			errorHandler->error(left.getSlice(),
+			      "Left side of assignment must be a variable");
+			continue;
+		}
+		if (left.getTypeID() == -1 || right.getTypeID() == -1) {
+			continue;
+		}
+		int typeID = module->getBinaryOperator(link.getOperator().type,
+		      left.getTypeID(), right.getTypeID());
+		if (typeID == -1) {
+			errorHandler->error(link.getOperator().s,
+			      "Binary operator not defined for types");
+		}
+		link.setTypeID(typeID);
 	}
-	node.setTypeID(typeID);
 }
 
 void SemanticAnalyzer::visit(UnaryExpression &node) {
@@ -150,31 +170,34 @@ void SemanticAnalyzer::visit(UnaryExpression &node) {
 
 void SemanticAnalyzer::visit(IntegerLiteralExpression &node) {
 	IntegerLiteral &literal = node.getLiteral();
-	node.setTypeID(module->getType(IntegerLiteral::typeToStringView(literal.type)).id);
+	node.setTypeID(Type::I8 + static_cast<int>(literal.type));
 }
 
 void SemanticAnalyzer::visit(BoolLiteralExpression &node) {
-	node.setTypeID(module->getType("bool").id);
+	node.setTypeID(Type::BOOL);
 }
 
 void SemanticAnalyzer::visit(CharacterLiteralExpression &node) {
-	node.setTypeID(module->getType("char").id);
+	node.setTypeID(Type::CHAR);
 }
 
 void SemanticAnalyzer::visit(SymbolExpression &node) {
-	for (auto it = scopeStack.rbegin(); it != scopeStack.rend(); it++) {
-		int typeID = (*it)->getSymbolType(node.getSymbol().s.contents);
-		if (typeID != -1) {
-			node.setTypeID(typeID);
-			return;
-		}
+	const Binding *binding = symbols.lookup(node.getSymbol().id);
+	if (binding != nullptr) {
+		node.setBinding(*binding);
+		node.setTypeID(binding->typeID);
+		return;
 	}
 	errorHandler->error(node.getSymbol(),
 	      "Symbol " + std::string(node.getSymbol().s.contents) + " not found");
 }
 
 void SemanticAnalyzer::visit(BlockExpression &node) {
-	scopeStack.push_back(&node);
+	symbols.enterScope();
+	// A function's parameters are declared in the scope of its body
+	node.forEachSymbol([this](SymbolID symbol, int typeID, SymbolSource source) {
+		symbols.declare(symbol, {typeID, source});
+	});
 	node.forEachStatement([this](Statement &statement) {
 		if (inUnreachableCode) {
 			errorHandler->error(statement.getSlice(), "Unreachable code");
@@ -187,16 +210,16 @@ void SemanticAnalyzer::visit(BlockExpression &node) {
 		if (finalExpression != nullptr) {
 			errorHandler->error(finalExpression->getSlice(), "Unreachable code");
 		}
-		node.setTypeID(module->getType("!").id);
+		node.setTypeID(Type::NEVER);
 	} else {
 		if (finalExpression != nullptr) {
 			finalExpression->accept(*this);
 			node.setTypeID(finalExpression->getTypeID());
 		} else {
-			node.setTypeID(module->getType("()").id);
+			node.setTypeID(Type::UNIT);
 		}
 	}
-	scopeStack.pop_back();
+	symbols.exitScope();
 }
 
 void SemanticAnalyzer::visit(ReturnExpression &node) {
@@ -211,11 +234,11 @@ void SemanticAnalyzer::visit(ReturnExpression &node) {
 			errorHandler->error(expr->getSlice(),
 			      "Return type does not match function return type");
 		}
-	} else if (currentFunction->getTypeID() != module->getType("()").id) {
+	} else if (currentFunction->getTypeID() != Type::UNIT) {
 		errorHandler->error(node.getSlice(),
 		      "Return type does not match function return type");
 	}
-	node.setTypeID(module->getType("!").id);
+	node.setTypeID(Type::NEVER);
 	inUnreachableCode = true;
 }
 
@@ -232,7 +255,7 @@ void SemanticAnalyzer::visit(IfElseExpression &node) {
 		errorHandler->error(node.getThenBlock().getSlice(), "Unreachable code");
 		return;
 	}
-	if (condition.getTypeID() != module->getType("bool").id) {
+	if (condition.getTypeID() != Type::BOOL) {
 		errorHandler->error(condition.getSlice(), "Condition is not of type bool");
 	}
 	BlockExpression &thenBlock = node.getThenBlock();
@@ -242,7 +265,7 @@ void SemanticAnalyzer::visit(IfElseExpression &node) {
 	Expression *elseExpression = node.getElseExpression();
 	int elseTypeID = -1;
 	if (elseExpression == nullptr) {
-		elseTypeID = module->getType("()").id;
+		elseTypeID = Type::UNIT;
 	} else {
 		elseExpression->accept(*this);
 		inUnreachableCode = false;
@@ -256,7 +279,7 @@ void SemanticAnalyzer::visit(IfElseExpression &node) {
 		errorHandler->error(node.getSlice(),
 		      "If and else block types are not convertible");
 	}
-	if (typeID == module->getType("!").id) {
+	if (typeID == Type::NEVER) {
 		inUnreachableCode = true;
 	}
 	node.setTypeID(typeID);
@@ -269,7 +292,7 @@ void SemanticAnalyzer::visit(WhileExpression &node) {
 		errorHandler->error(node.getBody().getSlice(), "Unreachable code");
 		return;
 	}
-	if (condition.getTypeID() != module->getType("bool").id) {
+	if (condition.getTypeID() != Type::BOOL) {
 		errorHandler->error(condition.getSlice(), "Condition is not of type bool");
 	}
 	BlockExpression &block = node.getBody();
@@ -290,7 +313,7 @@ void SemanticAnalyzer::visit(LetStatement &node) {
 		errorHandler->error(node.getSlice(), "Unreachable code");
 		return;
 	}
-	if (scopeStack.back()->getSymbolType(node.getSymbol().s.contents) != -1) {
+	if (symbols.isDeclaredInInnermostScope(node.getSymbol().id)) {
 		errorHandler->error(node.getSymbol(),
 		      "Redefinition of variable " + std::string(node.getSymbol().s.contents));
 		return;
@@ -300,7 +323,7 @@ void SemanticAnalyzer::visit(LetStatement &node) {
 		errorHandler->error(node.getEqualSign(), "Expected type annotation");
 		return;
 	}
-	int typeID = module->getType(typeAnnotation->s.contents).id;
+	int typeID = module->getType(*typeAnnotation).id;
 	Expression *value = node.getExpression();
 	if (!value) {
 		errorHandler->error(node.getSlice(), "Expression required for let statement");
@@ -311,8 +334,7 @@ void SemanticAnalyzer::visit(LetStatement &node) {
 		errorHandler->error(node.getEqualSign().s, "Unreachable code");
 		return;
 	}
-	scopeStack.back()->pushSymbol(node.getSymbol().s.contents, typeID,
-	      SymbolSource::LetStatement);
+	symbols.declare(node.getSymbol().id, {typeID, SymbolSource::LetStatement});
 	if (typeID != value->getTypeID() && value->getTypeID() != -1) {
 		errorHandler->error(node.getExpression()->getSlice(),
 		      "Type mismatch in let statement");
@@ -331,9 +353,9 @@ void SemanticAnalyzer::visit(Function &node) {
 	Symbol *typeAnnotation = node.getReturnTypeAnnotation();
 	int annotationTypeID = -1;
 	if (typeAnnotation != nullptr) {
-		annotationTypeID = module->getType(typeAnnotation->s.contents).id;
+		annotationTypeID = module->getType(*typeAnnotation).id;
 	} else {
-		annotationTypeID = module->getType("()").id;
+		annotationTypeID = Type::UNIT;
 	}
 	if (!module->isTypeConvertible(blockTypeID, annotationTypeID)) {
 		Expression *finalExpression = node.getBody().getFinalExpression();
@@ -355,48 +377,70 @@ void SemanticAnalyzer::visit(Function &node) {
 
 void SemanticAnalyzer::visit(Module &node) {
 	addDefaultOperators(&node);
-	addRuntimeFunctions(&node, builtinApiJsonFile);
+	addRuntimeFunctions(&node, *builtinApi);
 	node.forEachFunction([this]([[maybe_unused]]
 	                            std::string_view name,
 	                           Function &function, bool /*unused*/) {
 		function.forEachParameter([this, &function](Symbol &parameter, Symbol &type) {
-			int typeID = module->getType(type.s.contents).id;
+			int typeID = module->getType(type).id;
 			if (typeID == -1) {
 				errorHandler->error(type.s, "Unknown type");
 				return;
 			}
-			function.getBody().pushSymbol(parameter.s.contents, typeID,
+			function.getBody().pushSymbol(parameter.id, typeID,
 			      SymbolSource::FunctionParameter);
 		});
 
 		Symbol *type = function.getReturnTypeAnnotation();
 		if (type == nullptr) {
-			function.setTypeID(module->getType("()").id);
+			function.setTypeID(Type::UNIT);
 		} else {
-			function.setTypeID(module->getType(type->s.contents).id);
+			function.setTypeID(module->getType(*type).id);
 		}
 	});
+	std::vector<std::pair<std::string_view, Function *>> bodies;
 	bool hasMain = false;
-	node.forEachFunction(
-	      [this, &hasMain](std::string_view name, Function &function, bool isBuiltin) {
-		      if (isBuiltin) {
-			      return;
-		      }
-		      currentFunction = &function;
-		      function.accept(*this);
-		      if (name == "main") {
-			      hasMain = true;
-			      if (function.getTypeID() != module->getType("()").id) {
-				      errorHandler->error(*function.getReturnTypeAnnotation(),
-				            "main must return unit type");
-			      }
-		      }
-	      });
+	node.forEachFunction([&bodies, &hasMain](std::string_view name, Function &function,
+	                           bool isBuiltin) {
+		if (!isBuiltin) {
+			bodies.emplace_back(name, &function);
+			hasMain = hasMain || name == "main";
+		}
+	});
+	if (threadPool == nullptr) {
+		for (auto &[name, function] : bodies) {
+			analyzeBody(name, *function);
+		}
+	} else {
+		// Bodies only read the Module and the signatures resolved above, so runs of them
+		// are checked at once, each by its own analyzer. Their errors are then appended
+		// in source order, just as they would have been reported one body at a time
+		std::vector<ErrorHandler> runErrors(threadPool->countRuns(bodies.size()));
+		auto check = [this, &bodies, &runErrors](size_t run, size_t begin, size_t end) {
+			SemanticAnalyzer analyzer(module, &runErrors[run]);
+			for (size_t i = begin; i < end; i++) {
+				analyzer.analyzeBody(bodies[i].first, *bodies[i].second);
+			}
+		};
+		threadPool->forEachRun(bodies.size(), check);
+		for (ErrorHandler &errors : runErrors) {
+			errorHandler->append(errors);
+		}
+	}
 	if (!hasMain) {
 		errorHandler->error(module->getSource(), "No main function");
 	}
 }
 
+void SemanticAnalyzer::analyzeBody(std::string_view name, Function &function) {
+	currentFunction = &function;
+	function.accept(*this);
+	if (name == "main" && function.getTypeID() != Type::UNIT) {
+		errorHandler->error(*function.getReturnTypeAnnotation(),
+		      "main must return unit type");
+	}
+}
+
 static void addDefaultOperators(Module *module) {
 	addDefaultIntegerOperators(module);
 	addDefaultBoolOperators(module);
@@ -428,17 +472,17 @@ static void addDefaultIntegerOperators(Module *module) {
 	      Operator::Type::GreaterThan,
 	      Operator::Type::GreaterThanOrEqual,
 	};
-	const std::array<std::string_view, 4> signedIntegerTypes = {
-	      "i8",
-	      "i16",
-	      "i32",
-	      "i64",
+	const std::array<int, 4> signedIntegerTypes = {
+	      Type::I8,
+	      Type::I16,
+	      Type::I32,
+	      Type::I64,
 	};
-	const std::array<std::string_view, 4> unsignedIntegerTypes = {
-	      "u8",
-	      "u16",
-	      "u32",
-	      "u64",
+	const std::array<int, 4> unsignedIntegerTypes = {
+	      Type::U8,
+	      Type::U16,
+	      Type::U32,
+	      Type::U64,
 	};
 
 	addSameSignIntegerArithmeticTypes(module, signedIntegerTypes, binaryIntegerOperators,
@@ -450,75 +494,68 @@ static void addDefaultIntegerOperators(Module *module) {
 }
 
 static void addSameSignIntegerArithmeticTypes(Module *module,
-      const std::span<const std::string_view> types,
+      const std::span<const int> types,
       const std::span<const Operator::Type> binaryOperators,
       const std::span<const Operator::Type> unaryOperators) {
-	static const int unitTypeID = module->getType("()").id;
-	for (auto it = types.begin(); it != types.end(); it++) {
-		int typeID = module->getType(*it).id;
+	for (int typeID : types) {
 		for (const auto &op : unaryOperators) {
 			module->addUnaryOperator(op, typeID, typeID);
 		}
 		for (const auto &op : binaryOperators) {
 			module->addBinaryOperator(op, typeID, typeID, typeID);
 		}
-		module->addBinaryOperator(Operator::Type::Assignment, typeID, typeID, unitTypeID);
+		module->addBinaryOperator(Operator::Type::Assignment, typeID, typeID, Type::UNIT);
 	}
 }
 
 static void addSameSignIntegerComparisonTypes(Module *module,
-      const std::span<const std::string_view> types,
+      const std::span<const int> types,
       const std::span<const Operator::Type> comparisonOperators) {
-	static const int boolTypeID = module->getType("bool").id;
-	for (auto it = types.begin(); it != types.end(); it++) {
-		int typeID = module->getType(*it).id;
+	for (int typeID : types) {
 		for (const auto &op : comparisonOperators) {
-			module->addBinaryOperator(op, typeID, typeID, boolTypeID);
+			module->addBinaryOperator(op, typeID, typeID, Type::BOOL);
 		}
 	}
 }
 
 static void addDefaultBoolOperators(Module *module) {
-	static const int boolTypeID = module->getType("bool").id;
-	module->addUnaryOperator(Operator::Type::LogicalNot, boolTypeID, boolTypeID);
-	module->addBinaryOperator(Operator::Type::LogicalAnd, boolTypeID, boolTypeID,
-	      boolTypeID);
-	module->addBinaryOperator(Operator::Type::LogicalOr, boolTypeID, boolTypeID,
-	      boolTypeID);
-	module->addBinaryOperator(Operator::Type::Equality, boolTypeID, boolTypeID,
-	      boolTypeID);
-	module->addBinaryOperator(Operator::Type::Inequality, boolTypeID, boolTypeID,
-	      boolTypeID);
-	static const int unitTypeID = module->getType("()").id;
-	module->addBinaryOperator(Operator::Type::Assignment, boolTypeID, boolTypeID,
-	      unitTypeID);
+	module->addUnaryOperator(Operator::Type::LogicalNot, Type::BOOL, Type::BOOL);
+	module->addBinaryOperator(Operator::Type::LogicalAnd, Type::BOOL, Type::BOOL,
+	      Type::BOOL);
+	module->addBinaryOperator(Operator::Type::LogicalOr, Type::BOOL, Type::BOOL,
+	      Type::BOOL);
+	module->addBinaryOperator(Operator::Type::Equality, Type::BOOL, Type::BOOL,
+	      Type::BOOL);
+	module->addBinaryOperator(Operator::Type::Inequality, Type::BOOL, Type::BOOL,
+	      Type::BOOL);
+	module->addBinaryOperator(Operator::Type::Assignment, Type::BOOL, Type::BOOL,
+	      Type::UNIT);
 }
 
-static void addRuntimeFunctions(Module *module, std::istream &builtinApiJsonFile) {
-	json data;
-	builtinApiJsonFile >> data;
-
-	for (const auto &[name, function] : data["functions"].items()) {
-		module->ownedStrings.push_back(name);
-		std::string_view functionName = module->ownedStrings.back();
-		std::vector<std::pair<std::unique_ptr<Symbol>, std::unique_ptr<Symbol>>>
-		      parameters;
-		for (auto &parameter : function["parameters"]) {
-			module->ownedStrings.push_back(parameter["name"].get<std::string>());
-			std::string_view name = module->ownedStrings.back();
-			module->ownedStrings.push_back(parameter["type"].get<std::string>());
-			std::string_view type = module->ownedStrings.back();
-			parameters.emplace_back(std::make_unique<Symbol>(Slice(name, "", 0, 0)),
-			      std::make_unique<Symbol>(Slice(type, "", 0, 0)));
-		}
-		module->ownedStrings.emplace_back(function["returnType"].get<std::string>());
-		std::string_view returnType = module->ownedStrings.back();
-		std::unique_ptr<Symbol> returnTypeAnnotation
-		      = std::make_unique<Symbol>(Slice(returnType, "", 0, 0));
-		std::unique_ptr<Function> builtin
-		      = std::make_unique<Function>(std::move(parameters),
-		            std::move(returnTypeAnnotation), std::make_unique<BlockExpression>());
-		module->addFunction(std::make_unique<Symbol>(Slice(functionName, "", 0, 0)),
-		      std::move(builtin), true);
+static void addBuiltinFunction(Module *module, std::string_view name,
+      std::span<const BuiltinParameter> parameters, std::string_view returnType) {
+	Arena &arena = module->getArena();
+	Interner &interner = module->getInterner();
+	// The Interner keeps the text of each name, which Slices then refer to
+	auto makeSymbol = [&arena, &interner](std::string_view text) {
+		SymbolID id = interner.intern(text);
+		return arena.make<Symbol>(Slice(interner.getName(id), SourceManager::NO_FILE),
+		      id);
+	};
+	ArenaVector<std::pair<Symbol *, Symbol *>> parameterSymbols
+	      = arena.makeVector<std::pair<Symbol *, Symbol *>>();
+	for (const BuiltinParameter &parameter : parameters) {
+		parameterSymbols.emplace_back(makeSymbol(parameter.name),
+		      makeSymbol(parameter.type));
+	}
+	Function *builtin = arena.make<Function>(std::move(parameterSymbols),
+	      makeSymbol(returnType), arena.make<BlockExpression>(arena));
+	module->addFunction(*makeSymbol(name), builtin, true);
+}
+
+static void addRuntimeFunctions(Module *module, const BuiltinApi &builtinApi) {
+	for (const BuiltinFunction &function : builtinApi.functions()) {
+		addBuiltinFunction(module, function.name, builtinApi.parameters(function),
+		      function.returnType);
 	}
 }
@@ -2,11 +2,15 @@
 #define SEMANTICANALYZER_H
 
 #include "ast.h"
+#include "builtinapi.h"
 #include "errorhandler.h"
+#include "symboltable.h"
+#include "threadpool.h"
 #include "tokens.h"
 
+#include <cstddef>
 #include <memory>
-#include <vector>
+#include <string_view>
 
 /**
  * @brief Validates whether an AST conforms to Canyon language semantics
@@ -15,13 +19,31 @@
 class SemanticAnalyzer : public ASTVisitor {
 	Module *module;
 	ErrorHandler *errorHandler;
-	std::vector<BlockExpression *> scopeStack;
+	SymbolTable symbols;
 	bool inUnreachableCode = false;
 	Function *currentFunction = nullptr;
-	std::istream &builtinApiJsonFile;
+	// Shared with every other SemanticAnalyzer
+	const BuiltinApi *builtinApi = &BuiltinApi::embedded();
+	// Checks function bodies in parallel if not null
+	ThreadPool *threadPool = nullptr;
+
+	/**
+	 * @brief Checks the body of a Function whose signature has been resolved
+	 */
+	void analyzeBody(std::string_view name, Function &function);
 public:
+	/**
+	 * @brief Prepares to analyze a Module which may call the builtin API embedded at
+	 * build time
+	 */
+	SemanticAnalyzer(Module *module, ErrorHandler *errorHandler,
+	      ThreadPool *threadPool = nullptr);
+	/**
+	 * @brief Prepares to analyze a Module which may call another builtin API instead,
+	 * such as one read from a JSON file for developing the runtime without rebuilding
+	 */
 	SemanticAnalyzer(Module *module, ErrorHandler *errorHandler,
-	      std::istream &builtinApiJsonFile);
+	      const BuiltinApi &builtinApi, ThreadPool *threadPool = nullptr);
 	void analyze();
 	void visit(FunctionCallExpression &node) override;
 	void visit(BinaryExpression &node) override;
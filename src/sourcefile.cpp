@@ -0,0 +1,113 @@
+#include "sourcefile.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::optional<SourceFile> SourceFile::open(const std::filesystem::path &path) {
+	bool standardInput = path == "-";
+	int fd = standardInput ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return std::nullopt;
+	}
+	SourceFile file;
+	struct stat status {};
+	bool loaded = fstat(fd, &status) == 0;
+	if (loaded) {
+		// Pipes and terminals cannot be mapped, so they are read until end of file
+		auto size = static_cast<size_t>(status.st_size);
+		loaded = (S_ISREG(status.st_mode) && file.map(fd, size)) || file.read(fd);
+	}
+	int e = errno;
+	if (!standardInput) {
+		close(fd);
+	}
+	if (!loaded) {
+		errno = e;
+		return std::nullopt;
+	}
+	return file;
+}
+
+bool SourceFile::map(int fd, size_t size) {
+	// An empty mapping is invalid, but there is also nothing to read
+	if (size == 0) {
+		return true;
+	}
+	void *address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (address == MAP_FAILED) {
+		return false;
+	}
+	// The lexer reads the file once from start to end
+	madvise(address, size, MADV_SEQUENTIAL);
+	mapping = static_cast<const char *>(address);
+	mappingSize = size;
+	contents = std::string_view(mapping, mappingSize);
+	return true;
+}
+
+bool SourceFile::read(int fd) {
+	constexpr size_t CHUNK_SIZE = 1 << 16;
+	size_t size = 0;
+	while (true) {
+		buffer.resize(size + CHUNK_SIZE);
+		ssize_t count = ::read(fd, buffer.data() + size, CHUNK_SIZE);
+		if (count < 0 && errno == EINTR) {
+			continue;
+		}
+		if (count < 0) {
+			return false;
+		}
+		if (count == 0) {
+			break;
+		}
+		size += count;
+	}
+	buffer.resize(size);
+	contents = buffer;
+	return true;
+}
+
+SourceFile::SourceFile(SourceFile &&other) noexcept
+    : mapping(std::exchange(other.mapping, nullptr)),
+      mappingSize(std::exchange(other.mappingSize, 0)), buffer(std::move(other.buffer)) {
+	// Short buffers are stored inside the string itself, so they move with it
+	contents = mapping != nullptr ? std::string_view(mapping, mappingSize)
+	                              : std::string_view(buffer);
+	other.contents = std::string_view();
+}
+
+SourceFile &SourceFile::operator=(SourceFile &&other) noexcept {
+	if (this == &other) {
+		return *this;
+	}
+	if (mapping != nullptr) {
+		munmap(const_cast<char *>(mapping), mappingSize);
+	}
+	mapping = std::exchange(other.mapping, nullptr);
+	mappingSize = std::exchange(other.mappingSize, 0);
+	buffer = std::move(other.buffer);
+	contents = mapping != nullptr ? std::string_view(mapping, mappingSize)
+	                              : std::string_view(buffer);
+	other.contents = std::string_view();
+	return *this;
+}
+
+SourceFile::~SourceFile() {
+	if (mapping != nullptr) {
+		munmap(const_cast<char *>(mapping), mappingSize);
+	}
+}
+
+std::string_view SourceFile::getContents() const {
+	return contents;
+}
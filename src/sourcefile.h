@@ -0,0 +1,46 @@
+#ifndef SOURCEFILE_H
+#define SOURCEFILE_H
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Holds the contents of a source code file in memory for as long as any Slice of
+ * it may be used. Regular files are mapped read-only, so that they are never copied and
+ * their pages are shared with any other process reading the same file. Pipes, terminals,
+ * and other files which cannot be mapped are read into a buffer instead
+ *
+ */
+class SourceFile {
+	const char *mapping = nullptr;
+	size_t mappingSize = 0;
+	std::string buffer;
+	std::string_view contents;
+
+	SourceFile() = default;
+	bool map(int fd, size_t size);
+	bool read(int fd);
+public:
+	/**
+	 * @brief Opens and loads a source code file
+	 *
+	 * @param path the name of the file, or "-" for standard input
+	 * @return the loaded file, or std::nullopt if it could not be read, in which case
+	 * errno describes the failure
+	 */
+	static std::optional<SourceFile> open(const std::filesystem::path &path);
+	SourceFile(SourceFile &&other) noexcept;
+	SourceFile &operator=(SourceFile &&other) noexcept;
+	SourceFile(const SourceFile &) = delete;
+	SourceFile &operator=(const SourceFile &) = delete;
+	~SourceFile();
+
+	/**
+	 * @brief Gets the contents of the file, which remain valid until it is destroyed
+	 */
+	std::string_view getContents() const;
+};
+
+#endif
@@ -0,0 +1,109 @@
+#include "sourcemanager.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+SourceManager::File::File(std::filesystem::path path, std::string_view contents,
+      uint32_t tabSize)
+    : path(std::move(path)), contents(contents), tabSize(tabSize) {
+}
+
+SourceManager::SourceManager() {
+	files.emplace_back("", "", 1);
+}
+
+SourceManager &SourceManager::instance() {
+	static SourceManager manager;
+	return manager;
+}
+
+FileID SourceManager::addFile(std::filesystem::path path, std::string_view contents,
+      uint32_t tabSize) {
+	SourceManager &manager = instance();
+	std::lock_guard<std::mutex> lock(manager.mutex);
+	auto id = static_cast<FileID>(manager.files.size());
+	manager.files.emplace_back(std::move(path), contents, tabSize);
+	return id;
+}
+
+const std::filesystem::path &SourceManager::getPath(FileID id) {
+	SourceManager &manager = instance();
+	std::lock_guard<std::mutex> lock(manager.mutex);
+	if (id >= manager.files.size()) {
+		std::cerr << "Unknown FileID " << id << '\n';
+		exit(EXIT_FAILURE);
+	}
+	// Elements of a deque are never moved by emplace_back, so the reference stays valid
+	return manager.files[id].path;
+}
+
+std::pair<size_t, size_t> SourceManager::getLocation(FileID id, const char *position) {
+	SourceManager &manager = instance();
+	std::lock_guard<std::mutex> lock(manager.mutex);
+	if (id >= manager.files.size()) {
+		std::cerr << "Unknown FileID " << id << '\n';
+		exit(EXIT_FAILURE);
+	}
+	File &file = manager.files[id];
+	// Compiler-generated Slices refer to strings outside of any source code file
+	auto address = reinterpret_cast<uintptr_t>(position);
+	auto start = reinterpret_cast<uintptr_t>(file.contents.data());
+	if (id == NO_FILE || address < start || address - start > file.contents.size()) {
+		return {0, 0};
+	}
+	size_t offset = address - start;
+	if (!file.indexed) {
+		indexLines(file);
+	}
+
+	auto line = std::upper_bound(file.lineStarts.begin(), file.lineStarts.end(), offset)
+	            - 1;
+	size_t row = (line - file.lineStarts.begin()) + 1;
+	size_t col = 1;
+	for (size_t i = *line; i < offset; i++) {
+		if (file.contents[i] == '\t') {
+			col = ((col + file.tabSize - 1) / file.tabSize) * file.tabSize + 1;
+		} else {
+			col++;
+		}
+	}
+	return {row, col};
+}
+
+void SourceManager::indexLines(File &file) {
+	constexpr uint64_t ONES = 0x0101010101010101;
+	constexpr uint64_t HIGHS = 0x8080808080808080;
+	std::string_view text = file.contents;
+	file.lineStarts.push_back(0);
+	size_t i = 0;
+	while (i < text.size()) {
+		// Skip a word at a time while none of its bytes is a \n or \r
+		if (i + sizeof(uint64_t) <= text.size()) {
+			uint64_t word = 0;
+			std::memcpy(&word, text.data() + i, sizeof(word));
+			uint64_t lf = word ^ (ONES * '\n');
+			uint64_t cr = word ^ (ONES * '\r');
+			if (((((lf - ONES) & ~lf) | ((cr - ONES) & ~cr)) & HIGHS) == 0) {
+				i += sizeof(word);
+				continue;
+			}
+		}
+		// A \r\n pair ends a single line, as does a \r or \n on its own
+		if (text[i] == '\r' && i + 1 < text.size() && text[i + 1] == '\n') {
+			i++;
+		}
+		if (text[i] == '\n' || text[i] == '\r') {
+			file.lineStarts.push_back(static_cast<uint32_t>(i + 1));
+		}
+		i++;
+	}
+	file.indexed = true;
+}
@@ -0,0 +1,79 @@
+#ifndef SOURCEMANAGER_H
+#define SOURCEMANAGER_H
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Identifies a source code file registered with the SourceManager
+ *
+ */
+using FileID = uint32_t;
+
+/**
+ * @brief Keeps a single copy of the name and contents of every source code file for the
+ * whole process, so that Slices and errors can refer to their file by a small FileID
+ * rather than carrying a copy of its path or their own line and column
+ *
+ */
+class SourceManager {
+	struct File {
+		std::filesystem::path path;
+		std::string_view contents;
+		uint32_t tabSize;
+		// The offset of the first character of each line, built on first use
+		std::vector<uint32_t> lineStarts;
+		bool indexed = false;
+		File(std::filesystem::path path, std::string_view contents, uint32_t tabSize);
+	};
+
+	std::deque<File> files;
+	std::mutex mutex;
+
+	SourceManager();
+	static SourceManager &instance();
+	static void indexLines(File &file);
+public:
+	/**
+	 * @brief The FileID of code that does not come from a source code file, whose path
+	 * is empty
+	 */
+	static constexpr FileID NO_FILE = 0;
+
+	/**
+	 * @brief Registers a source code file
+	 *
+	 * @param path the name of the source code file
+	 * @param contents the source code, which must outlive every Slice of it
+	 * @param tabSize the width of a tab stop, used to calculate columns
+	 * @return the FileID that identifies the file
+	 */
+	static FileID addFile(std::filesystem::path path, std::string_view contents,
+	      uint32_t tabSize);
+	/**
+	 * @brief Gets the name of a registered source code file
+	 *
+	 * @param id the FileID of the file
+	 * @return the path the file was registered with
+	 */
+	static const std::filesystem::path &getPath(FileID id);
+	/**
+	 * @brief Calculates the line and tab-expanded column of a position in a source code
+	 * file. The file's lines are indexed the first time this is called for it
+	 *
+	 * @param id the FileID of the file
+	 * @param position a pointer into the file's contents
+	 * @return the 1-indexed row and column of position, or 0, 0 if position is not in
+	 * the file
+	 */
+	static std::pair<size_t, size_t> getLocation(FileID id, const char *position);
+	SourceManager(const SourceManager &) = delete;
+	SourceManager &operator=(const SourceManager &) = delete;
+};
+
+#endif
@@ -0,0 +1,43 @@
+#include "symboltable.h"
+
+#include "ast.h"
+#include "interner.h"
+
+#include <cstddef>
+#include <cstdint>
+
+void SymbolTable::enterScope() {
+	scopeStarts.push_back(declarations.size());
+}
+
+void SymbolTable::exitScope() {
+	size_t start = scopeStarts.back();
+	scopeStarts.pop_back();
+	while (declarations.size() > start) {
+		const Declaration &declaration = declarations.back();
+		innermost[declaration.symbol] = declaration.shadowed;
+		declarations.pop_back();
+	}
+}
+
+void SymbolTable::declare(SymbolID symbol, const Binding &binding) {
+	if (symbol >= innermost.size()) {
+		innermost.resize(symbol + 1, NO_DECLARATION);
+	}
+	declarations.push_back({symbol, binding, innermost[symbol]});
+	innermost[symbol] = static_cast<uint32_t>(declarations.size() - 1);
+}
+
+const Binding *SymbolTable::lookup(SymbolID symbol) const {
+	if (symbol >= innermost.size() || innermost[symbol] == NO_DECLARATION) {
+		return nullptr;
+	}
+	return &declarations[innermost[symbol]].binding;
+}
+
+bool SymbolTable::isDeclaredInInnermostScope(SymbolID symbol) const {
+	if (symbol >= innermost.size() || innermost[symbol] == NO_DECLARATION) {
+		return false;
+	}
+	return innermost[symbol] >= scopeStarts.back();
+}
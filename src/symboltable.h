@@ -0,0 +1,63 @@
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+#include "ast.h"
+#include "interner.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Tracks which declaration each name refers to while walking nested scopes. Every
+ * name in scope has a chain of its declarations, innermost first, so resolving a name is
+ * a single lookup however deeply scopes nest. Declarations are kept in the order they
+ * were made, which doubles as the log of what to undo when a scope is exited
+ *
+ */
+class SymbolTable {
+	static constexpr uint32_t NO_DECLARATION = UINT32_MAX;
+
+	struct Declaration {
+		SymbolID symbol;
+		Binding binding;
+		// The declaration of the same name which this one shadows
+		uint32_t shadowed;
+	};
+
+	// Indexed by SymbolID, the innermost declaration of each name
+	std::vector<uint32_t> innermost;
+	std::vector<Declaration> declarations;
+	// The number of declarations which were made before each open scope
+	std::vector<size_t> scopeStarts;
+public:
+	/**
+	 * @brief Opens a new innermost scope
+	 */
+	void enterScope();
+	/**
+	 * @brief Closes the innermost scope, so that the names declared in it refer to
+	 * whatever they did before it was opened
+	 */
+	void exitScope();
+	/**
+	 * @brief Declares a name in the innermost scope, shadowing any outer declaration
+	 *
+	 * @param symbol the name being declared
+	 * @param binding what the name refers to until the scope is exited
+	 */
+	void declare(SymbolID symbol, const Binding &binding);
+	/**
+	 * @brief Finds the innermost declaration of a name
+	 *
+	 * @param symbol the name to resolve
+	 * @return what the name refers to, or nullptr if it is not in scope
+	 */
+	const Binding *lookup(SymbolID symbol) const;
+	/**
+	 * @brief Checks whether a name has been declared in the innermost scope
+	 */
+	bool isDeclaredInInnermostScope(SymbolID symbol) const;
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief The progress of one call to forEach, which is shared with the workers helping
+ * with it. A worker may only get to it after every item has been taken, so it outlives
+ * the call
+ */
+struct Batch {
+	const std::function<void(size_t)> *task;
+	size_t count;
+	std::atomic<size_t> next = 0;
+	std::atomic<size_t> finished = 0;
+	std::mutex mutex;
+	std::condition_variable done;
+
+	Batch(const std::function<void(size_t)> *task, size_t count)
+	    : task(task), count(count) {
+	}
+
+	/**
+	 * @brief Runs items until none are left to take
+	 */
+	void run() {
+		for (size_t i = next++; i < count; i = next++) {
+			(*task)(i);
+			if (++finished == count) {
+				std::lock_guard lock(mutex);
+				done.notify_all();
+			}
+		}
+	}
+};
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads) {
+	if (threads == 0) {
+		threads = std::max(std::thread::hardware_concurrency(), 1U);
+	}
+	for (size_t i = 1; i < threads; i++) {
+		workers.emplace_back([this]() {
+			work();
+		});
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard lock(mutex);
+		stopping = true;
+	}
+	available.notify_all();
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::work() {
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock lock(mutex);
+			available.wait(lock, [this]() {
+				return stopping || !jobs.empty();
+			});
+			if (jobs.empty()) {
+				return;
+			}
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		job();
+	}
+}
+
+void ThreadPool::forEach(size_t count, const std::function<void(size_t)> &task) {
+	if (count == 0) {
+		return;
+	}
+	auto batch = std::make_shared<Batch>(&task, count);
+	size_t helpers = std::min(workers.size(), count - 1);
+	if (helpers > 0) {
+		{
+			std::lock_guard lock(mutex);
+			for (size_t i = 0; i < helpers; i++) {
+				jobs.emplace_back([batch]() {
+					batch->run();
+				});
+			}
+		}
+		available.notify_all();
+	}
+	batch->run();
+	std::unique_lock lock(batch->mutex);
+	batch->done.wait(lock, [&batch]() {
+		return batch->finished == batch->count;
+	});
+}
+
+size_t ThreadPool::countRuns(size_t count) const {
+	return std::min(count, size() * RUNS_PER_THREAD);
+}
+
+void ThreadPool::forEachRun(size_t count,
+      const std::function<void(size_t run, size_t begin, size_t end)> &task) {
+	size_t runs = countRuns(count);
+	forEach(runs, [count, runs, &task](size_t run) {
+		task(run, run * count / runs, (run + 1) * count / runs);
+	});
+}
+
+size_t ThreadPool::size() const {
+	return workers.size() + 1;
+}
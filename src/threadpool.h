@@ -0,0 +1,70 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed set of worker threads which share the items of a batch of work with the
+ * thread that submitted it. The submitting thread works through the batch too and only
+ * waits for items that other threads have already started, so a batch submitted from
+ * inside another batch always finishes, even when every worker is busy
+ *
+ */
+class ThreadPool {
+	// Items differ in size, so each thread is given several runs of them to balance
+	static constexpr size_t RUNS_PER_THREAD = 4;
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable available;
+	std::deque<std::function<void()>> jobs;
+	bool stopping = false;
+
+	void work();
+public:
+	/**
+	 * @brief Starts the workers
+	 *
+	 * @param threads how many threads work on each batch, including the one submitting
+	 * it, or 0 for as many as the hardware runs at once
+	 */
+	explicit ThreadPool(size_t threads = 0);
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+	/**
+	 * @brief Waits for the workers to finish what they have started, then stops them
+	 */
+	~ThreadPool();
+
+	/**
+	 * @brief Runs a task once for each index in [0, count), on as many threads as are
+	 * free, and returns once every one has finished. Tasks must not depend on the order
+	 * in which they run
+	 */
+	void forEach(size_t count, const std::function<void(size_t)> &task);
+	/**
+	 * @brief Gets how many runs forEachRun splits a number of items into: several for
+	 * each thread, but never more than there are items
+	 */
+	size_t countRuns(size_t count) const;
+	/**
+	 * @brief Splits the indexes in [0, count) into countRuns(count) contiguous runs of
+	 * nearly equal length, and runs a task once for each run as forEach does
+	 *
+	 * @param task given the index of the run and the range [begin, end) of items in it
+	 */
+	void forEachRun(size_t count,
+	      const std::function<void(size_t run, size_t begin, size_t end)> &task);
+	/**
+	 * @brief Gets how many threads work on each batch, including the one submitting it
+	 */
+	size_t size() const;
+};
+
+#endif
@@ -0,0 +1,222 @@
+#include "tokenbuffer.h"
+
+#include "arena.h"
+#include "interner.h"
+#include "sourcemanager.h"
+#include "tokens.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+TokenBuffer::TokenBuffer(std::string_view program, FileID source)
+    : program(program), source(source), interner(std::make_shared<Interner>()) {
+}
+
+void TokenBuffer::reserve(size_t capacity) {
+	kinds.reserve(capacity);
+	subtypes.reserve(capacity);
+	offsets.reserve(capacity);
+	lengths.reserve(capacity);
+	values.reserve(capacity);
+}
+
+void TokenBuffer::push(TokenKind kind, uint8_t subtype, size_t offset, size_t length,
+      uint64_t value) {
+	kinds.push_back(kind);
+	subtypes.push_back(subtype);
+	offsets.push_back(static_cast<uint32_t>(offset));
+	lengths.push_back(static_cast<uint32_t>(length));
+	values.push_back(value);
+}
+
+void TokenBuffer::replaceLast(TokenKind kind, uint8_t subtype, size_t end) {
+	kinds.back() = kind;
+	subtypes.back() = subtype;
+	lengths.back() = static_cast<uint32_t>(end - offsets.back());
+}
+
+void TokenBuffer::append(const TokenBuffer &other) {
+	std::vector<SymbolID> ids(other.interner->size());
+	for (SymbolID id = 0; id < ids.size(); id++) {
+		ids[id] = interner->intern(other.interner->getName(id));
+	}
+	const size_t start = size();
+	kinds.insert(kinds.end(), other.kinds.begin(), other.kinds.end());
+	subtypes.insert(subtypes.end(), other.subtypes.begin(), other.subtypes.end());
+	offsets.insert(offsets.end(), other.offsets.begin(), other.offsets.end());
+	lengths.insert(lengths.end(), other.lengths.begin(), other.lengths.end());
+	values.insert(values.end(), other.values.begin(), other.values.end());
+	for (size_t i = start; i < size(); i++) {
+		if (kinds[i] == TokenKind::Symbol) {
+			values[i] = ids[values[i]];
+		}
+	}
+}
+
+size_t TokenBuffer::size() const {
+	return kinds.size();
+}
+
+TokenKind TokenBuffer::kind(size_t index) const {
+	return kinds[index];
+}
+
+uint8_t TokenBuffer::subtype(size_t index) const {
+	return subtypes[index];
+}
+
+uint64_t TokenBuffer::value(size_t index) const {
+	return values[index];
+}
+
+std::string_view TokenBuffer::contents(size_t index) const {
+	return program.substr(offsets[index], lengths[index]);
+}
+
+Slice TokenBuffer::slice(size_t index) const {
+	return Slice(contents(index), source);
+}
+
+FileID TokenBuffer::getSource() const {
+	return source;
+}
+
+std::string_view TokenBuffer::getProgram() const {
+	return program;
+}
+
+const std::shared_ptr<Interner> &TokenBuffer::getInterner() const {
+	return interner;
+}
+
+std::unique_ptr<Token> TokenBuffer::createToken(size_t index) const {
+	switch (kinds[index]) {
+		case TokenKind::Keyword:
+			return std::make_unique<Keyword>(slice(index),
+			      static_cast<Keyword::Type>(subtypes[index]));
+		case TokenKind::Punctuation:
+			return std::make_unique<Punctuation>(slice(index),
+			      static_cast<Punctuation::Type>(subtypes[index]));
+		case TokenKind::Operator:
+			return std::make_unique<Operator>(slice(index),
+			      static_cast<Operator::Type>(subtypes[index]));
+		case TokenKind::SymbolOrLiteral:
+			return std::make_unique<SymbolOrLiteral>(slice(index));
+		case TokenKind::Symbol:
+			return std::make_unique<Symbol>(slice(index),
+			      static_cast<SymbolID>(values[index]));
+		case TokenKind::IntegerLiteral:
+			return std::make_unique<IntegerLiteral>(slice(index),
+			      static_cast<IntegerLiteral::Type>(subtypes[index]), values[index]);
+		case TokenKind::BoolLiteral:
+			return std::make_unique<BoolLiteral>(slice(index), values[index] != 0);
+		case TokenKind::CharacterLiteral:
+			return std::make_unique<CharacterLiteral>(slice(index),
+			      static_cast<char>(values[index]));
+		case TokenKind::Whitespace:
+			return std::make_unique<Whitespace>(slice(index));
+		case TokenKind::EndOfFile:
+			return std::make_unique<EndOfFile>(slice(index));
+		default:
+			std::cerr << "Unknown token kind\n";
+			exit(EXIT_FAILURE);
+	}
+}
+
+size_t TokenBuffer::memoryUsage() const {
+	return kinds.capacity() * sizeof(TokenKind) + subtypes.capacity() * sizeof(uint8_t)
+	       + offsets.capacity() * sizeof(uint32_t) + lengths.capacity() * sizeof(uint32_t)
+	       + values.capacity() * sizeof(uint64_t);
+}
+
+TokenCursor::TokenCursor(const TokenBuffer &tokens) : tokens(&tokens) {
+}
+
+TokenKind TokenCursor::kind() const {
+	return tokens->kind(index);
+}
+
+bool TokenCursor::isKeyword(Keyword::Type type) const {
+	return tokens->kind(index) == TokenKind::Keyword
+	       && static_cast<Keyword::Type>(tokens->subtype(index)) == type;
+}
+
+bool TokenCursor::isPunctuation(Punctuation::Type type) const {
+	return tokens->kind(index) == TokenKind::Punctuation
+	       && static_cast<Punctuation::Type>(tokens->subtype(index)) == type;
+}
+
+bool TokenCursor::isOperator(Operator::Type type) const {
+	return tokens->kind(index) == TokenKind::Operator
+	       && static_cast<Operator::Type>(tokens->subtype(index)) == type;
+}
+
+Operator::Type TokenCursor::getOperatorType() const {
+	return static_cast<Operator::Type>(tokens->subtype(index));
+}
+
+bool TokenCursor::isAtEnd() const {
+	return tokens->kind(index) == TokenKind::EndOfFile;
+}
+
+Slice TokenCursor::slice() const {
+	return tokens->slice(index);
+}
+
+Keyword TokenCursor::keyword() const {
+	return Keyword(tokens->slice(index),
+	      static_cast<Keyword::Type>(tokens->subtype(index)));
+}
+
+Punctuation TokenCursor::punctuation() const {
+	return Punctuation(tokens->slice(index),
+	      static_cast<Punctuation::Type>(tokens->subtype(index)));
+}
+
+Operator *TokenCursor::createOperator(Arena &arena) const {
+	return arena.make<Operator>(tokens->slice(index),
+	      static_cast<Operator::Type>(tokens->subtype(index)));
+}
+
+Symbol *TokenCursor::createSymbol(Arena &arena) const {
+	return arena.make<Symbol>(tokens->slice(index),
+	      static_cast<SymbolID>(tokens->value(index)));
+}
+
+IntegerLiteral *TokenCursor::createIntegerLiteral(Arena &arena) const {
+	return arena.make<IntegerLiteral>(tokens->slice(index),
+	      static_cast<IntegerLiteral::Type>(tokens->subtype(index)),
+	      tokens->value(index));
+}
+
+BoolLiteral *TokenCursor::createBoolLiteral(Arena &arena) const {
+	return arena.make<BoolLiteral>(tokens->slice(index), tokens->value(index) != 0);
+}
+
+CharacterLiteral *TokenCursor::createCharacterLiteral(Arena &arena) const {
+	return arena.make<CharacterLiteral>(tokens->slice(index),
+	      static_cast<char>(tokens->value(index)));
+}
+
+void TokenCursor::advance() {
+	// The final EndOfFile is never stepped past
+	if (index + 1 < tokens->size()) {
+		index++;
+	}
+}
+
+void TokenCursor::skipToEnd() {
+	index = tokens->size() - 1;
+}
+
+size_t TokenCursor::getIndex() const {
+	return index;
+}
+
+void TokenCursor::moveTo(size_t index) {
+	this->index = index;
+}
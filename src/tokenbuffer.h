@@ -0,0 +1,134 @@
+#ifndef TOKENBUFFER_H
+#define TOKENBUFFER_H
+
+#include "arena.h"
+#include "interner.h"
+#include "sourcemanager.h"
+#include "tokens.h"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Stores lexed Tokens compactly as a struct of arrays rather than as individual
+ * heap objects. Each Token is identified by its index, and its text is a range of the
+ * source code rather than a copy of it
+ *
+ */
+class TokenBuffer {
+	std::string_view program;
+	FileID source;
+	std::vector<TokenKind> kinds;
+	// The Keyword, Punctuation, Operator, or IntegerLiteral Type, where applicable
+	std::vector<uint8_t> subtypes;
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> lengths;
+	// The value of an IntegerLiteral, BoolLiteral, or CharacterLiteral, or the SymbolID
+	// of a Symbol
+	std::vector<uint64_t> values;
+	// Assigns the SymbolIDs, and is handed on to the Module parsed from the buffer
+	std::shared_ptr<Interner> interner;
+public:
+	/**
+	 * @brief Construct a new, empty TokenBuffer for Canyon source code
+	 *
+	 * @param program the source code the Tokens are taken from
+	 * @param source the source code file
+	 */
+	TokenBuffer(std::string_view program, FileID source);
+	void reserve(size_t capacity);
+	/**
+	 * @brief Appends a Token to the end of the buffer
+	 *
+	 * @param kind the kind of Token
+	 * @param subtype the Type of the Token, if its kind has one, otherwise 0
+	 * @param offset where in the source code the Token begins
+	 * @param length how many characters of source code the Token spans
+	 * @param value the value of the Token if it is a literal, its SymbolID if it is a
+	 * Symbol, otherwise 0
+	 */
+	void push(TokenKind kind, uint8_t subtype, size_t offset, size_t length,
+	      uint64_t value);
+	/**
+	 * @brief Changes the kind and subtype of the last Token and extends it to end at a
+	 * later point in the source code
+	 *
+	 * @param kind the new kind of Token
+	 * @param subtype the new Type of the Token
+	 * @param end the offset just past the last character of the Token
+	 */
+	void replaceLast(TokenKind kind, uint8_t subtype, size_t end);
+	/**
+	 * @brief Appends every Token of another buffer over the same source code. Its
+	 * identifiers are interned here in the order they were assigned SymbolIDs there,
+	 * so appending the buffers of consecutive parts of the source code assigns the same
+	 * SymbolIDs as lexing it in one buffer
+	 */
+	void append(const TokenBuffer &other);
+	size_t size() const;
+	TokenKind kind(size_t index) const;
+	uint8_t subtype(size_t index) const;
+	uint64_t value(size_t index) const;
+	std::string_view contents(size_t index) const;
+	Slice slice(size_t index) const;
+	FileID getSource() const;
+	std::string_view getProgram() const;
+	const std::shared_ptr<Interner> &getInterner() const;
+	/**
+	 * @brief Creates a standalone Token object equivalent to the Token at index
+	 */
+	std::unique_ptr<Token> createToken(size_t index) const;
+	/**
+	 * @brief Calculates the memory used by the Tokens in the buffer
+	 *
+	 * @return the number of bytes allocated by the buffer's arrays
+	 */
+	size_t memoryUsage() const;
+};
+
+/**
+ * @brief A lightweight position within a TokenBuffer, used to step through its Tokens
+ *
+ */
+class TokenCursor {
+	const TokenBuffer *tokens;
+	size_t index = 0;
+public:
+	explicit TokenCursor(const TokenBuffer &tokens);
+	TokenKind kind() const;
+	bool isKeyword(Keyword::Type type) const;
+	bool isPunctuation(Punctuation::Type type) const;
+	bool isOperator(Operator::Type type) const;
+	/**
+	 * @brief Gets the Type of the current Token, which must be an Operator
+	 */
+	Operator::Type getOperatorType() const;
+	bool isAtEnd() const;
+	Slice slice() const;
+	Keyword keyword() const;
+	Punctuation punctuation() const;
+	// Each of these copies the current Token, which must be of the matching kind, into an
+	// Arena
+	Operator *createOperator(Arena &arena) const;
+	Symbol *createSymbol(Arena &arena) const;
+	IntegerLiteral *createIntegerLiteral(Arena &arena) const;
+	BoolLiteral *createBoolLiteral(Arena &arena) const;
+	CharacterLiteral *createCharacterLiteral(Arena &arena) const;
+	void advance();
+	/**
+	 * @brief Moves to the final EndOfFile Token
+	 */
+	void skipToEnd();
+	/**
+	 * @brief Gets the index of the current Token in the TokenBuffer
+	 */
+	size_t getIndex() const;
+	/**
+	 * @brief Moves to the Token at an index in the TokenBuffer
+	 */
+	void moveTo(size_t index);
+};
+
+#endif
@@ -1,13 +1,13 @@
 #include "tokens.h"
 
+#include "sourcemanager.h"
+
 #include <cstdlib>
-#include <filesystem>
 #include <iostream>
 #include <string_view>
 
-Slice::Slice(std::string_view contents, std::filesystem::path source, size_t row,
-      size_t col)
-    : contents(contents), source(std::move(source)), row(row), col(col) {
+Slice::Slice(std::string_view contents, FileID source)
+    : contents(contents), source(source) {
 }
 
 Slice Slice::merge(const Slice &start, const Slice &end) {
@@ -18,7 +18,15 @@ Slice Slice::merge(const Slice &start, const Slice &end) {
 	return Slice(
 	      std::string_view(start.contents.data(),
 	            (end.contents.data() - start.contents.data()) + end.contents.size()),
-	      start.source, start.row, start.col);
+	      start.source);
+}
+
+size_t Slice::row() const {
+	return SourceManager::getLocation(source, contents.data()).first;
+}
+
+size_t Slice::col() const {
+	return SourceManager::getLocation(source, contents.data()).second;
 }
 
 std::ostream &operator<<(std::ostream &os, const Slice &slice) {
@@ -26,10 +34,10 @@ std::ostream &operator<<(std::ostream &os, const Slice &slice) {
 	return os;
 }
 
-Token::Token(const Slice &s) : s(s) {
+Token::Token(const Slice &s, TokenKind kind) : s(s), kind(kind) {
 }
 
-Keyword::Keyword(const Slice &s, Type type) : Token(s), type(type) {
+Keyword::Keyword(const Slice &s, Type type) : Token(s, TokenKind::Keyword), type(type) {
 }
 
 void Keyword::print(std::ostream &os) const {
@@ -62,7 +70,8 @@ void Keyword::print(std::ostream &os) const {
 	}
 }
 
-Punctuation::Punctuation(const Slice &s, Type type) : Token(s), type(type) {
+Punctuation::Punctuation(const Slice &s, Type type)
+    : Token(s, TokenKind::Punctuation), type(type) {
 }
 
 void Punctuation::print(std::ostream &os) const {
@@ -154,124 +163,120 @@ void Punctuation::print(std::ostream &os) const {
 	}
 }
 
-Operator::Operator(const Token &t, Type type) : Token(t.s), type(type) {
+Operator::Operator(const Slice &s, Type type)
+    : Token(s, TokenKind::Operator), type(type) {
+}
+
+Operator::Operator(const Token &t, Type type)
+    : Token(t.s, TokenKind::Operator), type(type) {
 }
 
 void Operator::print(std::ostream &os) const {
+	os << typeToStringView(type);
+}
+
+std::string_view Operator::typeToStringView(Type type) {
 	switch (type) {
 		case Type::Assignment: {
-			os << '=';
-			break;
+			return "=";
 		}
 		case Type::Equality: {
-			os << "==";
-			break;
+			return "==";
 		}
 		case Type::Inequality: {
-			os << "!=";
-			break;
+			return "!=";
 		}
 		case Type::LessThan: {
-			os << '<';
-			break;
+			return "<";
 		}
 		case Type::LessThanOrEqual: {
-			os << "<=";
-			break;
+			return "<=";
 		}
 		case Type::GreaterThan: {
-			os << '>';
-			break;
+			return ">";
 		}
 		case Type::GreaterThanOrEqual: {
-			os << ">=";
-			break;
+			return ">=";
 		}
 		case Type::Addition: {
-			os << '+';
-			break;
+			return "+";
 		}
 		case Type::Subtraction: {
-			os << '-';
-			break;
+			return "-";
 		}
 		case Type::Multiplication: {
-			os << '*';
-			break;
+			return "*";
 		}
 		case Type::Division: {
-			os << '/';
-			break;
+			return "/";
 		}
 		case Type::Modulus: {
-			os << '%';
-			break;
+			return "%";
 		}
 		case Type::Scope: {
-			os << "::";
-			break;
+			return "::";
 		}
 		case Type::LogicalNot: {
-			os << '!';
-			break;
+			return "!";
 		}
 		case Type::LogicalAnd: {
-			os << "&&";
-			break;
+			return "&&";
 		}
 		case Type::LogicalOr: {
-			os << "||";
-			break;
+			return "||";
 		}
 		case Type::BitwiseNot: {
-			os << '~';
-			break;
+			return "~";
 		}
 		case Type::BitwiseAnd: {
-			os << '&';
-			break;
+			return "&";
 		}
 		case Type::BitwiseOr: {
-			os << '|';
-			break;
+			return "|";
 		}
 		case Type::BitwiseXor: {
-			os << '^';
-			break;
+			return "^";
 		}
 		case Type::BitwiseShiftLeft: {
-			os << "<<";
-			break;
+			return "<<";
 		}
 		case Type::BitwiseShiftRight: {
-			os << ">>";
-			break;
+			return ">>";
+		}
+		default: {
+			std::cerr << "Unknown operator";
+			exit(EXIT_FAILURE);
 		}
 	}
 }
 
-SymbolOrLiteral::SymbolOrLiteral(const Slice &s) : Token(s) {
+SymbolOrLiteral::SymbolOrLiteral(const Slice &s) : Token(s, TokenKind::SymbolOrLiteral) {
 }
 
 void SymbolOrLiteral::print(std::ostream &os) const {
 	os << s;
 }
 
-Symbol::Symbol(const Slice &s) : Token(s) {
+Symbol::Symbol(const Slice &s, SymbolID id) : Token(s, TokenKind::Symbol), id(id) {
 }
 
-Symbol::Symbol(const SymbolOrLiteral *const s) : Token(s->s) {
+Symbol::Symbol(const SymbolOrLiteral *const s, SymbolID id)
+    : Token(s->s, TokenKind::Symbol), id(id) {
 }
 
-Symbol::Symbol(const Symbol &s) : Token(s.s) {
+Symbol::Symbol(const Symbol &s) : Token(s.s, TokenKind::Symbol), id(s.id) {
 }
 
 void Symbol::print(std::ostream &os) const {
 	os << s;
 }
 
+IntegerLiteral::IntegerLiteral(const Slice &s, Type type, uint64_t value)
+    : Token(s, TokenKind::IntegerLiteral), type(type), value(value) {
+}
+
 IntegerLiteral::IntegerLiteral(const Token &t, Type type, uint64_t value)
-    : Token(t.s), type(type), value(value) {
+    : Token(t.s, TokenKind::IntegerLiteral), type(type), value(value) {
 }
 
 void IntegerLiteral::print(std::ostream &os) const {
@@ -315,7 +320,12 @@ bool operator==(const IntegerLiteral &lhs, const IntegerLiteral &rhs) {
 	return (lhs.type == rhs.type) && (lhs.value == rhs.value);
 }
 
-BoolLiteral::BoolLiteral(const Token &t, bool value) : Token(t.s), value(value) {
+BoolLiteral::BoolLiteral(const Slice &s, bool value)
+    : Token(s, TokenKind::BoolLiteral), value(value) {
+}
+
+BoolLiteral::BoolLiteral(const Token &t, bool value)
+    : Token(t.s, TokenKind::BoolLiteral), value(value) {
 }
 
 void BoolLiteral::print(std::ostream &os) const {
@@ -326,8 +336,12 @@ bool operator==(const BoolLiteral &lhs, const BoolLiteral &rhs) {
 	return lhs.value == rhs.value;
 }
 
+CharacterLiteral::CharacterLiteral(const Slice &s, char value)
+    : Token(s, TokenKind::CharacterLiteral), value(value) {
+}
+
 CharacterLiteral::CharacterLiteral(const Token &t, char value)
-    : Token(t.s), value(value) {
+    : Token(t.s, TokenKind::CharacterLiteral), value(value) {
 }
 
 void CharacterLiteral::print(std::ostream &os) const {
@@ -338,14 +352,14 @@ bool operator==(const CharacterLiteral &lhs, const CharacterLiteral &rhs) {
 	return lhs.value == rhs.value;
 }
 
-Whitespace::Whitespace(const Slice &s) : Token(s) {
+Whitespace::Whitespace(const Slice &s) : Token(s, TokenKind::Whitespace) {
 }
 
 void Whitespace::print(std::ostream &os) const {
 	os << " ";
 }
 
-EndOfFile::EndOfFile(const Slice &s) : Token(s) {
+EndOfFile::EndOfFile(const Slice &s) : Token(s, TokenKind::EndOfFile) {
 }
 
 void EndOfFile::print(std::ostream &os) const {
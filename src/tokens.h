@@ -1,8 +1,11 @@
 #ifndef TOKENS_H
 #define TOKENS_H
 
+#include "interner.h"
+#include "sourcemanager.h"
+
+#include <cstddef>
 #include <cstdint>
-#include <filesystem>
 #include <iostream>
 #include <string_view>
 
@@ -11,11 +14,8 @@
 
 struct Slice {
 	std::string_view contents;
-	std::filesystem::path source;
-	size_t row;
-	size_t col;
-	Slice(std::string_view contents, std::filesystem::path source, size_t row,
-	      size_t col);
+	FileID source;
+	Slice(std::string_view contents, FileID source);
 	Slice(const Slice &s) = default;
 	~Slice() = default;
 	/**
@@ -29,17 +29,50 @@ struct Slice {
 	 * end of `end`
 	 */
 	static Slice merge(const Slice &start, const Slice &end);
+	/**
+	 * @brief Calculates the line the Slice begins on. This is looked up from the source
+	 * code file, so it is best reserved for reporting errors
+	 *
+	 * @return the 1-indexed line, or 0 if the Slice is not part of a source code file
+	 */
+	size_t row() const;
+	/**
+	 * @brief Calculates the tab-expanded column the Slice begins at. This is looked up
+	 * from the source code file, so it is best reserved for reporting errors
+	 *
+	 * @return the 1-indexed column, or 0 if the Slice is not part of a source code file
+	 */
+	size_t col() const;
 };
 
 std::ostream &operator<<(std::ostream &os, const Slice &slice);
 
+/**
+ * @brief Identifies each kind of Token, matching the Token subclasses below
+ *
+ */
+enum class TokenKind : uint8_t {
+	Keyword,
+	Punctuation,
+	Operator,
+	SymbolOrLiteral,
+	Symbol,
+	IntegerLiteral,
+	BoolLiteral,
+	CharacterLiteral,
+	Whitespace,
+	EndOfFile,
+};
+
 struct Token {
 	Slice s;
+	// The subclass this Token is an instance of, which isa<>, cast<> and dyn_cast<> check
+	TokenKind kind;
 
 	virtual void print(std::ostream &os) const = 0;
 	virtual ~Token() = default;
 protected:
-	Token(const Slice &s);
+	Token(const Slice &s, TokenKind kind);
 };
 
 struct Keyword : public Token {
@@ -56,6 +89,10 @@ struct Keyword : public Token {
 	Keyword(const Slice &s, Type type);
 	virtual void print(std::ostream &os) const;
 	virtual ~Keyword() = default;
+
+	static bool classof(const Token *token) {
+		return token->kind == TokenKind::Keyword;
+	}
 };
 
 struct Punctuation : public Token {
@@ -86,6 +123,10 @@ struct Punctuation : public Token {
 	Punctuation(const Slice &s, Type type);
 	virtual void print(std::ostream &os) const;
 	virtual ~Punctuation() = default;
+
+	static bool classof(const Token *token) {
+		return token->kind == TokenKind::Punctuation;
+	}
 };
 
 struct Operator : public Token {
@@ -113,10 +154,18 @@ struct Operator : public Token {
 		BitwiseShiftLeft,
 		BitwiseShiftRight,
 	};
+	// The number of Types, for tables indexed by them
+	static constexpr size_t TYPE_COUNT = static_cast<size_t>(Type::BitwiseShiftRight) + 1;
 	Type type;
+	Operator(const Slice &s, Type type);
 	explicit Operator(const Token &t, Type type);
 	virtual void print(std::ostream &os) const;
+	static std::string_view typeToStringView(Type type);
 	virtual ~Operator() = default;
+
+	static bool classof(const Token *token) {
+		return token->kind == TokenKind::Operator;
+	}
 };
 
 struct SymbolOrLiteral : public Token {
@@ -124,14 +173,24 @@ struct SymbolOrLiteral : public Token {
 	explicit SymbolOrLiteral(const SymbolOrLiteral &s) = default;
 	virtual void print(std::ostream &os) const;
 	virtual ~SymbolOrLiteral() = default;
+
+	static bool classof(const Token *token) {
+		return token->kind == TokenKind::SymbolOrLiteral;
+	}
 };
 
 struct Symbol : public Token {
-	explicit Symbol(const Slice &s);
-	explicit Symbol(const SymbolOrLiteral *const s);
+	// Identifies the text of the Symbol within the Interner of its TokenBuffer and Module
+	SymbolID id;
+	Symbol(const Slice &s, SymbolID id);
+	Symbol(const SymbolOrLiteral *const s, SymbolID id);
 	explicit Symbol(const Symbol &s);
 	virtual void print(std::ostream &os) const;
 	virtual ~Symbol() = default;
+
+	static bool classof(const Token *token) {
+		return token->kind == TokenKind::Symbol;
+	}
 };
 
 struct IntegerLiteral : public Token {
@@ -147,28 +206,43 @@ struct IntegerLiteral : public Token {
 	};
 	Type type;
 	uint64_t value;
+	IntegerLiteral(const Slice &s, Type type, uint64_t value);
 	explicit IntegerLiteral(const Token &t, Type type, uint64_t value);
 	virtual void print(std::ostream &os) const;
 	static std::string_view typeToStringView(Type type);
 	virtual ~IntegerLiteral() = default;
+
+	static bool classof(const Token *token) {
+		return token->kind == TokenKind::IntegerLiteral;
+	}
 };
 
 bool operator==(const IntegerLiteral &lhs, const IntegerLiteral &rhs);
 
 struct BoolLiteral : public Token {
 	bool value;
+	BoolLiteral(const Slice &s, bool value);
 	explicit BoolLiteral(const Token &t, bool value);
 	virtual void print(std::ostream &os) const;
 	virtual ~BoolLiteral() = default;
+
+	static bool classof(const Token *token) {
+		return token->kind == TokenKind::BoolLiteral;
+	}
 };
 
 bool operator==(const BoolLiteral &lhs, const BoolLiteral &rhs);
 
 struct CharacterLiteral : public Token {
 	char value;
+	CharacterLiteral(const Slice &s, char value);
 	explicit CharacterLiteral(const Token &t, char value);
 	virtual void print(std::ostream &os) const;
 	virtual ~CharacterLiteral() = default;
+
+	static bool classof(const Token *token) {
+		return token->kind == TokenKind::CharacterLiteral;
+	}
 };
 
 bool operator==(const CharacterLiteral &lhs, const CharacterLiteral &rhs);
@@ -177,12 +251,20 @@ struct Whitespace : public Token {
 	explicit Whitespace(const Slice &s);
 	virtual void print(std::ostream &os) const;
 	virtual ~Whitespace() = default;
+
+	static bool classof(const Token *token) {
+		return token->kind == TokenKind::Whitespace;
+	}
 };
 
 struct EndOfFile : public Token {
 	EndOfFile(const Slice &s);
 	virtual void print(std::ostream &os) const;
 	virtual ~EndOfFile() = default;
+
+	static bool classof(const Token *token) {
+		return token->kind == TokenKind::EndOfFile;
+	}
 };
 
 #endif
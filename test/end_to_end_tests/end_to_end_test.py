@@ -8,6 +8,7 @@ import pytest
 
 # Should be in test/ when you run pytest or use --rootdir=test
 canyon_compiler = os.path.join(os.getcwd(), "../build/canyon")
+builtin_api = os.path.join(os.getcwd(), "../resources/builtin_api.json")
 os.chdir("end_to_end_tests")
 tests = os.path.join(os.getcwd(), "tests")
 
@@ -134,3 +135,152 @@ def test_failure(test_name: str, monkeypatch: pytest.MonkeyPatch, tmp_path: path
         with open(os.path.join(source, "failure/stderr.diff"), "w") as fail_err:
             fail_err.write("\n".join(diff))
         raise
+
+
+def test_multiple_files(tmp_path: pathlib.Path):
+    sources: list[str] = []
+    for outcome in ["success", "canyon_failure"]:
+        for test_name in sorted(discover_tests(os.path.join(tests, outcome))):
+            sources.append(os.path.join(tests, outcome, test_name, "main.canyon"))
+
+    # Each file compiled on its own is what compiling them together must match
+    expected_stderr = ""
+    for i, source in enumerate(sources):
+        process = canyon(source, str(tmp_path / f"alone{i}.c"), None,
+                         subprocess.PIPE, subprocess.PIPE)
+        _, err = process.communicate()
+        expected_stderr += err.decode()
+
+    args: list[str] = []
+    for i, source in enumerate(sources):
+        args += [source, str(tmp_path / f"together{i}.c")]
+    with open(tmp_path / "response", "w") as response:
+        response.write("\n".join(args[2:]))
+    process = subprocess.Popen([canyon_compiler, "-j", "4", args[0], args[1],
+                                "@" + str(tmp_path / "response")],
+                               stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    out, err = process.communicate()
+    assert process.wait() != 0
+    assert out.decode() == ""
+    assert err.decode() == expected_stderr
+
+    for i in range(len(sources)):
+        alone = tmp_path / f"alone{i}.c"
+        together = tmp_path / f"together{i}.c"
+        assert alone.exists() == together.exists()
+        if alone.exists():
+            assert alone.read_bytes() == together.read_bytes()
+
+
+def test_response_file_quoting(tmp_path: pathlib.Path):
+    source = sorted(discover_tests(os.path.join(tests, "success")))[0]
+    source = os.path.join(tests, "success", source, "main.canyon")
+    process = canyon(source, str(tmp_path / "expected.c"), None,
+                     subprocess.PIPE, subprocess.PIPE)
+    process.communicate()
+    assert process.wait() == 0
+
+    # Paths with spaces, quoted in each way a response file allows
+    spaced = tmp_path / "with space"
+    spaced.mkdir()
+    (spaced / "main.canyon").write_bytes(pathlib.Path(source).read_bytes())
+    with open(tmp_path / "response", "w") as response:
+        response.write(f'"{spaced / "main.canyon"}" \'{spaced / "single.c"}\'\n')
+        response.write(str(spaced / "main.canyon").replace(" ", "\\ ") + " ")
+        response.write(str(spaced / "escaped.c").replace(" ", "\\ ") + "\n")
+    process = subprocess.Popen([canyon_compiler, "@" + str(tmp_path / "response")],
+                               stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    out, err = process.communicate()
+    assert process.wait() == 0
+    assert out.decode() == ""
+    assert err.decode() == ""
+    expected = (tmp_path / "expected.c").read_bytes()
+    assert (spaced / "single.c").read_bytes() == expected
+    assert (spaced / "escaped.c").read_bytes() == expected
+
+
+def test_unknown_option(tmp_path: pathlib.Path):
+    process = subprocess.Popen([canyon_compiler, "--foo", "main.canyon",
+                                str(tmp_path / "main.c")],
+                               stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    out, err = process.communicate()
+    assert process.wait() != 0
+    assert out.decode() == ""
+    assert err.decode().startswith("Unknown option --foo. Usage: ")
+    assert not (tmp_path / "main.c").exists()
+
+
+@pytest.mark.parametrize("test_name",
+                         sorted(discover_tests(os.path.join(tests, "success")))[:3])
+def test_standard_input(test_name: str, tmp_path: pathlib.Path):
+    source = os.path.join(tests, "success", test_name, "main.canyon")
+    process = canyon(source, str(tmp_path / "expected.c"), None,
+                     subprocess.PIPE, subprocess.PIPE)
+    process.communicate()
+    assert process.wait() == 0
+
+    # A pipe cannot be mapped, so the source code is read from it instead
+    process = canyon("-", str(tmp_path / "main.c"), subprocess.PIPE,
+                     subprocess.PIPE, subprocess.PIPE)
+    out, err = process.communicate(pathlib.Path(source).read_bytes())
+    assert process.wait() == 0
+    assert out.decode() == ""
+    assert err.decode() == ""
+    assert (tmp_path / "main.c").read_bytes() == (tmp_path / "expected.c").read_bytes()
+
+
+def test_empty_source(tmp_path: pathlib.Path):
+    empty = tmp_path / "empty.canyon"
+    empty.write_bytes(b"")
+    process = canyon(str(empty), str(tmp_path / "main.c"), None,
+                     subprocess.PIPE, subprocess.PIPE)
+    out, err = process.communicate()
+    assert process.wait() != 0
+    assert out.decode() == ""
+    assert err.decode() == f"Error at {empty}: No main function\n"
+
+    process = canyon("-", str(tmp_path / "main.c"), subprocess.PIPE,
+                     subprocess.PIPE, subprocess.PIPE)
+    out, err = process.communicate(b"")
+    assert process.wait() != 0
+    assert out.decode() == ""
+    assert err.decode() == "Error at -: No main function\n"
+
+
+def test_builtin_api_override(tmp_path: pathlib.Path):
+    sources = [os.path.join(tests, "success", test_name, "main.canyon")
+               for test_name in sorted(discover_tests(os.path.join(tests, "success")))]
+    # The JSON the embedded table is generated from must give the same builtins
+    for name, options in [("embedded", []), ("read", ["--builtin-api", builtin_api])]:
+        args = [canyon_compiler] + options
+        for i, source in enumerate(sources):
+            args += [source, str(tmp_path / f"{name}{i}.c")]
+        process = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        out, err = process.communicate()
+        assert process.wait() == 0
+        assert out.decode() == ""
+        assert err.decode() == ""
+    for i in range(len(sources)):
+        assert (tmp_path / f"embedded{i}.c").read_bytes() \
+            == (tmp_path / f"read{i}.c").read_bytes()
+
+
+@pytest.mark.parametrize("contents", [
+    "not json",
+    '{"functions": {"printI32": {"parameters": []}}}',
+    '{"functions": {"printI32": {"parameters": [{"name": "value"}], "returnType": "()"}}}',
+])
+def test_builtin_api_malformed(contents: str, tmp_path: pathlib.Path):
+    api = tmp_path / "api.json"
+    api.write_text(contents)
+    source = sorted(discover_tests(os.path.join(tests, "success")))[0]
+    source = os.path.join(tests, "success", source, "main.canyon")
+    process = subprocess.Popen([canyon_compiler, "--builtin-api", str(api), source,
+                                str(tmp_path / "main.c")],
+                               stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    out, err = process.communicate()
+    assert process.wait() != 0
+    assert out.decode() == ""
+    assert err.decode().startswith(f'Failed to read builtin API file "{api}": ')
+    assert err.decode().count("\n") == 1
+    assert not (tmp_path / "main.c").exists()
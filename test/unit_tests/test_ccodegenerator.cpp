@@ -0,0 +1,57 @@
+#ifndef DEBUG_TEST_MODE
+#	error "DEBUG_TEST_MODE not defined"
+#endif
+
+#include "ast.h"
+#include "ccodegenerator.h"
+#include "lexer.h"
+#include "outputfile.h"
+#include "parser.h"
+#include "semanticanalyzer.h"
+#include "test_utilities.h"
+#include "threadpool.h"
+#include "tokenbuffer.h"
+
+#include "gtest/gtest.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+
+/**
+ * @brief Compiles a program to C in memory, optionally on a ThreadPool
+ */
+static std::string generate(const std::string &program, ThreadPool *threadPool) {
+	NoErrorHandler errors;
+	TokenBuffer tokens = Lexer(program, "", &errors).lex();
+	std::unique_ptr<Module> mod = Parser(std::move(tokens), &errors).parse();
+	SemanticAnalyzer(mod.get(), &errors).analyze();
+	OutputFile out = OutputFile::inMemory();
+	CCodeGenerator(mod.get(), &out, threadPool).generate();
+	return std::string(out.getContents());
+}
+
+/**
+ * @brief Ensure that generating function definitions in parallel writes exactly the same
+ * C as generating them in sequence, with more functions than there are runs of them
+ *
+ */
+TEST(testCCodeGenerator, testParallelGeneration) {
+	std::string program = "fun main() {\n\tprintI32(f0(1));\n}\n";
+	for (size_t i = 0; i < 200; i++) {
+		const std::string n = std::to_string(i);
+		const std::string next = std::to_string(i + 1);
+		program += "fun f" + n + "(a: i32): i32 {\n";
+		program += "\tlet x: i32 = a * " + n + " + 1;\n";
+		program += "\twhile x > 100 { x = x / 2; };\n";
+		program += "\tif a > 1000 { a } else { f" + next + "(a + x) }\n}\n";
+	}
+	program += "fun f200(a: i32): i32 {\n\ta\n}\n";
+	std::string expected = generate(program, nullptr);
+	EXPECT_NE(expected.find("f200"), std::string::npos);
+	for (size_t threads : {2, 4}) {
+		ThreadPool threadPool(threads);
+		EXPECT_EQ(generate(program, &threadPool), expected);
+	}
+}
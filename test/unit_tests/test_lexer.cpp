@@ -2,21 +2,30 @@
 #	error "DEBUG_TEST_MODE not defined"
 #endif
 
+#include "casting.h"
+#include "charclass.h"
 #include "errorhandler.h"
+#include "interner.h"
+#include "lexemes.h"
 #include "lexer.h"
+#include "sourcemanager.h"
 #include "test_utilities.h"
+#include "threadpool.h"
+#include "tokenbuffer.h"
 #include "tokens.h"
 
 #include "gtest/gtest.h"
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <filesystem>
 #include <memory>
 #include <optional>
 #include <queue>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -132,9 +141,9 @@ TEST(testLexer, testConstructor) {
  */
 TEST_F(TestLexer, testEmpty) {
 	l = Lexer("", "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[0].get()));
+	EXPECT_TRUE(isa<EndOfFile>(tokens[0].get()));
 }
 
 /**
@@ -145,18 +154,18 @@ TEST_F(TestLexer, testWhitespace) {
 	for (const auto c : whitespaces) {
 		const std::string program = std::string(1, c);
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 1);
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[0].get()));
+		EXPECT_TRUE(isa<EndOfFile>(tokens[0].get()));
 	}
 
 	// Test 2: Double whitespace characters
 	for (const auto c : whitespaces) {
 		const std::string program = std::string(1, c) + std::string(1, c);
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 1);
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[0].get()));
+		EXPECT_TRUE(isa<EndOfFile>(tokens[0].get()));
 	}
 
 	// Test 3: Mixed whitespace characters
@@ -164,9 +173,9 @@ TEST_F(TestLexer, testWhitespace) {
 		for (const auto c2 : whitespaces) {
 			const std::string program = std::string(1, c1) + std::string(1, c2);
 			l = Lexer(program, "", &e);
-			tokens = l.lex();
+			tokens = toTokens(l.lex());
 			EXPECT_EQ(tokens.size(), 1);
-			EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[0].get()));
+			EXPECT_TRUE(isa<EndOfFile>(tokens[0].get()));
 		}
 	}
 
@@ -176,9 +185,9 @@ TEST_F(TestLexer, testWhitespace) {
 		const std::string permutation
 		      = std::string(whitespaces2.begin(), whitespaces2.end());
 		l = Lexer(permutation, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 1);
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[0].get()));
+		EXPECT_TRUE(isa<EndOfFile>(tokens[0].get()));
 	} while (std::next_permutation(whitespaces2.begin(), whitespaces2.end()));
 }
 
@@ -202,15 +211,15 @@ TEST_F(TestLexer, testSinglePunctuation) {
 		const Punctuation::Type punctuation = pair.second;
 		const std::string program = std::string(1, c);
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 2);
 		std::optional<Operator::Type> op = getOperator(std::string(1, c));
 		if (op.has_value()) {
-			EXPECT_EQ(dynamic_cast<Operator *>(tokens[0].get())->type, op.value());
-			EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+			EXPECT_EQ(cast<Operator>(tokens[0].get())->type, op.value());
+			EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 		} else {
-			EXPECT_EQ(dynamic_cast<Punctuation *>(tokens[0].get())->type, punctuation);
-			EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+			EXPECT_EQ(cast<Punctuation>(tokens[0].get())->type, punctuation);
+			EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 		}
 	}
 }
@@ -233,31 +242,27 @@ TEST_F(TestLexer, testTwoPunctuation) {
 			}
 			const std::string combo = std::string(1, c1) + std::string(1, c2);
 			l = Lexer(combo, "", &e);
-			tokens = l.lex();
+			tokens = toTokens(l.lex());
 			const std::optional<Operator::Type> op = getOperator(combo);
 			if (op.has_value()) {
 				EXPECT_EQ(tokens.size(), 2);
-				EXPECT_EQ(dynamic_cast<Operator *>(tokens[0].get())->type, op.value());
-				EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+				EXPECT_EQ(cast<Operator>(tokens[0].get())->type, op.value());
+				EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 			} else {
 				EXPECT_EQ(tokens.size(), 3);
 				const std::optional<Operator::Type> op1 = getOperator(std::string(1, c1));
 				if (op1.has_value()) {
-					EXPECT_EQ(dynamic_cast<Operator *>(tokens[0].get())->type,
-					      op1.value());
+					EXPECT_EQ(cast<Operator>(tokens[0].get())->type, op1.value());
 				} else {
-					EXPECT_EQ(dynamic_cast<Punctuation *>(tokens[0].get())->type,
-					      punctuation1);
+					EXPECT_EQ(cast<Punctuation>(tokens[0].get())->type, punctuation1);
 				}
 				const std::optional<Operator::Type> op2 = getOperator(std::string(1, c2));
 				if (op2.has_value()) {
-					EXPECT_EQ(dynamic_cast<Operator *>(tokens[1].get())->type,
-					      op2.value());
+					EXPECT_EQ(cast<Operator>(tokens[1].get())->type, op2.value());
 				} else {
-					EXPECT_EQ(dynamic_cast<Punctuation *>(tokens[1].get())->type,
-					      punctuation2);
+					EXPECT_EQ(cast<Punctuation>(tokens[1].get())->type, punctuation2);
 				}
-				EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+				EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 			}
 		}
 	}
@@ -288,30 +293,27 @@ TEST_F(TestLexer, testThreePunctuation) {
 				const std::string combo
 				      = std::string(1, c1) + std::string(1, c2) + std::string(1, c3);
 				l = Lexer(combo, "", &e);
-				tokens = l.lex();
+				tokens = toTokens(l.lex());
 				const std::optional<Operator::Type> op = getOperator(combo);
 				if (op.has_value()) {
 					EXPECT_EQ(tokens.size(), 2);
-					EXPECT_EQ(dynamic_cast<Operator *>(tokens[0].get())->type,
-					      op.value());
-					EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+					EXPECT_EQ(cast<Operator>(tokens[0].get())->type, op.value());
+					EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 				} else {
 					const std::optional<Operator::Type> op1
 					      = getOperator(std::string(1, c1) + std::string(1, c2));
 					if (op1.has_value()) {
 						EXPECT_EQ(tokens.size(), 3);
-						EXPECT_EQ(dynamic_cast<Operator *>(tokens[0].get())->type,
-						      op1.value());
+						EXPECT_EQ(cast<Operator>(tokens[0].get())->type, op1.value());
 						const std::optional<Operator::Type> op2
 						      = getOperator(std::string(1, c3));
 						if (op2.has_value()) {
-							EXPECT_EQ(dynamic_cast<Operator *>(tokens[1].get())->type,
-							      op2.value());
+							EXPECT_EQ(cast<Operator>(tokens[1].get())->type, op2.value());
 						} else {
-							EXPECT_EQ(dynamic_cast<Punctuation *>(tokens[1].get())->type,
+							EXPECT_EQ(cast<Punctuation>(tokens[1].get())->type,
 							      punctuation3);
 						}
-						EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+						EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 					} else {
 						const std::optional<Operator::Type> op2
 						      = getOperator(std::string(1, c2) + std::string(1, c3));
@@ -320,49 +322,48 @@ TEST_F(TestLexer, testThreePunctuation) {
 							const std::optional<Operator::Type> op1
 							      = getOperator(std::string(1, c1));
 							if (op1.has_value()) {
-								EXPECT_EQ(dynamic_cast<Operator *>(tokens[0].get())->type,
+								EXPECT_EQ(cast<Operator>(tokens[0].get())->type,
 								      op1.value());
 							} else {
 								EXPECT_EQ(
-								      dynamic_cast<Punctuation *>(tokens[0].get())->type,
+								      cast<Punctuation>(tokens[0].get())->type,
 								      punctuation1);
 							}
-							EXPECT_EQ(dynamic_cast<Operator *>(tokens[1].get())->type,
-							      op2.value());
-							EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+							EXPECT_EQ(cast<Operator>(tokens[1].get())->type, op2.value());
+							EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 						} else {
 							EXPECT_EQ(tokens.size(), 4);
 							const std::optional<Operator::Type> op1
 							      = getOperator(std::string(1, c1));
 							if (op1.has_value()) {
-								EXPECT_EQ(dynamic_cast<Operator *>(tokens[0].get())->type,
+								EXPECT_EQ(cast<Operator>(tokens[0].get())->type,
 								      op1.value());
 							} else {
 								EXPECT_EQ(
-								      dynamic_cast<Punctuation *>(tokens[0].get())->type,
+								      cast<Punctuation>(tokens[0].get())->type,
 								      punctuation1);
 							}
 							const std::optional<Operator::Type> op2
 							      = getOperator(std::string(1, c2));
 							if (op2.has_value()) {
-								EXPECT_EQ(dynamic_cast<Operator *>(tokens[1].get())->type,
+								EXPECT_EQ(cast<Operator>(tokens[1].get())->type,
 								      op2.value());
 							} else {
 								EXPECT_EQ(
-								      dynamic_cast<Punctuation *>(tokens[1].get())->type,
+								      cast<Punctuation>(tokens[1].get())->type,
 								      punctuation2);
 							}
 							const std::optional<Operator::Type> op3
 							      = getOperator(std::string(1, c3));
 							if (op3.has_value()) {
-								EXPECT_EQ(dynamic_cast<Operator *>(tokens[2].get())->type,
+								EXPECT_EQ(cast<Operator>(tokens[2].get())->type,
 								      op3.value());
 							} else {
 								EXPECT_EQ(
-								      dynamic_cast<Punctuation *>(tokens[2].get())->type,
+								      cast<Punctuation>(tokens[2].get())->type,
 								      punctuation3);
 							}
-							EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[3].get()));
+							EXPECT_TRUE(isa<EndOfFile>(tokens[3].get()));
 						}
 					}
 				}
@@ -382,40 +383,37 @@ TEST_F(TestLexer, testPunctuationWhitespace) {
 		for (const auto ws : whitespaces) {
 			std::string program = std::string(1, c) + std::string(1, ws);
 			l = Lexer(program, "", &e);
-			tokens = l.lex();
+			tokens = toTokens(l.lex());
 			EXPECT_EQ(tokens.size(), 2);
 			const std::optional<Operator::Type> op1 = getOperator(std::string(1, c));
 			if (op1.has_value()) {
-				EXPECT_EQ(dynamic_cast<Operator *>(tokens[0].get())->type, op1.value());
+				EXPECT_EQ(cast<Operator>(tokens[0].get())->type, op1.value());
 			} else {
-				EXPECT_EQ(dynamic_cast<Punctuation *>(tokens[0].get())->type,
-				      punctuation);
+				EXPECT_EQ(cast<Punctuation>(tokens[0].get())->type, punctuation);
 			}
-			EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+			EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 			program = std::string(1, ws) + std::string(1, c);
 			l = Lexer(program, "", &e);
-			tokens = l.lex();
+			tokens = toTokens(l.lex());
 			EXPECT_EQ(tokens.size(), 2);
 			const std::optional<Operator::Type> op2 = getOperator(std::string(1, c));
 			if (op2.has_value()) {
-				EXPECT_EQ(dynamic_cast<Operator *>(tokens[0].get())->type, op2.value());
+				EXPECT_EQ(cast<Operator>(tokens[0].get())->type, op2.value());
 			} else {
-				EXPECT_EQ(dynamic_cast<Punctuation *>(tokens[0].get())->type,
-				      punctuation);
+				EXPECT_EQ(cast<Punctuation>(tokens[0].get())->type, punctuation);
 			}
-			EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+			EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 			program = std::string(1, ws) + std::string(1, c) + std::string(1, ws);
 			l = Lexer(program, "", &e);
-			tokens = l.lex();
+			tokens = toTokens(l.lex());
 			EXPECT_EQ(tokens.size(), 2);
 			const std::optional<Operator::Type> op3 = getOperator(std::string(1, c));
 			if (op3.has_value()) {
-				EXPECT_EQ(dynamic_cast<Operator *>(tokens[0].get())->type, op3.value());
+				EXPECT_EQ(cast<Operator>(tokens[0].get())->type, op3.value());
 			} else {
-				EXPECT_EQ(dynamic_cast<Punctuation *>(tokens[0].get())->type,
-				      punctuation);
+				EXPECT_EQ(cast<Punctuation>(tokens[0].get())->type, punctuation);
 			}
-			EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+			EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 		}
 	}
 }
@@ -432,23 +430,23 @@ TEST_F(TestLexer, testMulticharOperators) {
 			continue;
 		}
 		l = Lexer(op, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 2);
-		EXPECT_EQ(dynamic_cast<Operator *>(tokens[0].get())->type, pair.second);
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+		EXPECT_EQ(cast<Operator>(tokens[0].get())->type, pair.second);
+		EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 		for (const auto ws : whitespaces) {
 			std::string program = op.substr(0, 1);
 			for (size_t i = 1; i < op.size(); i++) {
 				program += ws + op.substr(i, 1);
 			}
 			l = Lexer(program, "", &e);
-			tokens = l.lex();
+			tokens = toTokens(l.lex());
 			EXPECT_EQ(tokens.size(), op.size() + 1);
 			for (size_t i = 0; i < op.size(); i++) {
-				EXPECT_TRUE(dynamic_cast<Punctuation *>(tokens[i].get())
-				            || dynamic_cast<Operator *>(tokens[i].get()));
+				EXPECT_TRUE(isa<Punctuation>(tokens[i].get())
+				            || isa<Operator>(tokens[i].get()));
 			}
-			EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[op.size()].get()));
+			EXPECT_TRUE(isa<EndOfFile>(tokens[op.size()].get()));
 		}
 	}
 }
@@ -461,47 +459,47 @@ TEST_P(TestLexerKeywords, testKeywords) {
 	for (size_t i = 0; i < keyword_str.size() - 1; i++) {
 		const std::string program = keyword_str.substr(0, i + 1);
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 2);
-		EXPECT_FALSE(dynamic_cast<Keyword *>(tokens[0].get()));
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+		EXPECT_FALSE(dyn_cast<Keyword>(tokens[0].get()));
+		EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	}
 
 	// Test 2: actual keyword
 	l = Lexer(keyword_str, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(dynamic_cast<Keyword *>(tokens[0].get())->type, keyword_type);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(cast<Keyword>(tokens[0].get())->type, keyword_type);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 
 	// Test 3: alphanumeric suffixes
 	for (const auto &suffix : {"x", "0"}) {
 		const std::string program = keyword_str + suffix;
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 2);
-		EXPECT_FALSE(dynamic_cast<Keyword *>(tokens[0].get()));
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+		EXPECT_FALSE(dyn_cast<Keyword>(tokens[0].get()));
+		EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	}
 
 	// Test 4: whitespace suffixes
 	for (const auto suffix : whitespaces) {
 		const std::string program = keyword_str + suffix;
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 2);
-		EXPECT_EQ(dynamic_cast<Keyword *>(tokens[0].get())->type, keyword_type);
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+		EXPECT_EQ(cast<Keyword>(tokens[0].get())->type, keyword_type);
+		EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	}
 
 	// Test 5: whitespace prefixes
 	for (const auto prefix : whitespaces) {
 		const std::string program = prefix + keyword_str;
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 2);
-		EXPECT_EQ(dynamic_cast<Keyword *>(tokens[0].get())->type, keyword_type);
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+		EXPECT_EQ(cast<Keyword>(tokens[0].get())->type, keyword_type);
+		EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	}
 
 	// Test 6: punctuation suffixes
@@ -509,24 +507,22 @@ TEST_P(TestLexerKeywords, testKeywords) {
 		const char c = suffix.first;
 		const std::string program = keyword_str + c;
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 3);
-		EXPECT_EQ(dynamic_cast<Keyword *>(tokens[0].get())->type, keyword_type);
-		EXPECT_TRUE(dynamic_cast<Punctuation *>(tokens[1].get())
-		            || dynamic_cast<Operator *>(tokens[1].get()));
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+		EXPECT_EQ(cast<Keyword>(tokens[0].get())->type, keyword_type);
+		EXPECT_TRUE(isa<Punctuation>(tokens[1].get()) || isa<Operator>(tokens[1].get()));
+		EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	}
 
 	// Test 7: punctuation prefixes
 	for (const auto &prefix : punctuations) {
 		const std::string program = prefix.first + keyword_str;
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 3);
-		EXPECT_TRUE(dynamic_cast<Punctuation *>(tokens[0].get())
-		            || dynamic_cast<Operator *>(tokens[0].get()));
-		EXPECT_EQ(dynamic_cast<Keyword *>(tokens[1].get())->type, keyword_type);
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+		EXPECT_TRUE(isa<Punctuation>(tokens[0].get()) || isa<Operator>(tokens[0].get()));
+		EXPECT_EQ(cast<Keyword>(tokens[1].get())->type, keyword_type);
+		EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	}
 }
 
@@ -540,53 +536,51 @@ TEST_P(TestLexerSymbols, testSymbols) {
 	const std::string symbol = GetParam();
 	// Test 1: Single symbol
 	l = Lexer(symbol, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(dynamic_cast<Symbol *>(tokens[0].get())->s.contents, symbol);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(cast<Symbol>(tokens[0].get())->s.contents, symbol);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 
 	// Test 2: whitespace suffixes
 	for (const auto suffix : whitespaces) {
 		const std::string program = symbol + suffix;
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 2);
-		EXPECT_EQ(dynamic_cast<Symbol *>(tokens[0].get())->s.contents, symbol);
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+		EXPECT_EQ(cast<Symbol>(tokens[0].get())->s.contents, symbol);
+		EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	}
 
 	// Test 3: whitespace prefixes
 	for (const auto prefix : whitespaces) {
 		const std::string program = prefix + symbol;
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 2);
-		EXPECT_EQ(dynamic_cast<Symbol *>(tokens[0].get())->s.contents, symbol);
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+		EXPECT_EQ(cast<Symbol>(tokens[0].get())->s.contents, symbol);
+		EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	}
 
 	// Test 4: punctuation suffixes
 	for (const auto &suffix : punctuations) {
 		const std::string program = symbol + suffix.first;
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 3);
-		EXPECT_EQ(dynamic_cast<Symbol *>(tokens[0].get())->s.contents, symbol);
-		EXPECT_TRUE(dynamic_cast<Punctuation *>(tokens[1].get())
-		            || dynamic_cast<Operator *>(tokens[1].get()));
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+		EXPECT_EQ(cast<Symbol>(tokens[0].get())->s.contents, symbol);
+		EXPECT_TRUE(isa<Punctuation>(tokens[1].get()) || isa<Operator>(tokens[1].get()));
+		EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	}
 
 	// Test 5: punctuation prefixes
 	for (const auto &prefix : punctuations) {
 		const std::string program = prefix.first + symbol;
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 3);
-		EXPECT_TRUE(dynamic_cast<Punctuation *>(tokens[0].get())
-		            || dynamic_cast<Operator *>(tokens[0].get()));
-		EXPECT_EQ(dynamic_cast<Symbol *>(tokens[1].get())->s.contents, symbol);
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+		EXPECT_TRUE(isa<Punctuation>(tokens[0].get()) || isa<Operator>(tokens[0].get()));
+		EXPECT_EQ(cast<Symbol>(tokens[1].get())->s.contents, symbol);
+		EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	}
 }
 
@@ -599,59 +593,58 @@ TEST_P(TestLexerLiterals, testLiterals) {
 	const std::string literal_str = GetParam().first;
 	const IntegerLiteral expected = GetParam().second;
 	l = Lexer(literal_str, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(*dynamic_cast<IntegerLiteral *>(tokens[0].get()), expected);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(*cast<IntegerLiteral>(tokens[0].get()), expected);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 
 	// Test 2: whitespace suffixes
 	for (const auto suffix : whitespaces) {
 		const std::string program = literal_str + suffix;
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 2);
-		EXPECT_EQ(*dynamic_cast<IntegerLiteral *>(tokens[0].get()), expected);
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+		EXPECT_EQ(*cast<IntegerLiteral>(tokens[0].get()), expected);
+		EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	}
 
 	// Test 3: whitespace prefixes
 	for (const auto prefix : whitespaces) {
 		const std::string program = prefix + literal_str;
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 2);
-		EXPECT_EQ(*dynamic_cast<IntegerLiteral *>(tokens[0].get()), expected);
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+		EXPECT_EQ(*cast<IntegerLiteral>(tokens[0].get()), expected);
+		EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	}
 
 	// Test 4: punctuation suffixes
 	for (const auto &suffix : punctuations) {
 		const std::string program = literal_str + suffix.first;
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 3);
-		EXPECT_EQ(*dynamic_cast<IntegerLiteral *>(tokens[0].get()), expected);
-		EXPECT_TRUE(dynamic_cast<Punctuation *>(tokens[1].get())
-		            || dynamic_cast<Operator *>(tokens[1].get()));
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+		EXPECT_EQ(*cast<IntegerLiteral>(tokens[0].get()), expected);
+		EXPECT_TRUE(isa<Punctuation>(tokens[1].get()) || isa<Operator>(tokens[1].get()));
+		EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	}
 
 	// Test 5: punctuation prefixes
 	for (const auto &prefix : punctuations) {
 		const std::string program = prefix.first + literal_str;
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 3);
-		EXPECT_TRUE(dynamic_cast<Punctuation *>(tokens[0].get())
-		            || dynamic_cast<Operator *>(tokens[0].get()));
-		EXPECT_EQ(*dynamic_cast<IntegerLiteral *>(tokens[1].get()), expected);
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+		EXPECT_TRUE(isa<Punctuation>(tokens[0].get()) || isa<Operator>(tokens[0].get()));
+		EXPECT_EQ(*cast<IntegerLiteral>(tokens[1].get()), expected);
+		EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	}
 }
 
 class DummyToken : public Token {
 public:
-	DummyToken() noexcept : Token(Slice("", "", 0, 0)) {
+	DummyToken() noexcept
+	    : Token(Slice("", SourceManager::NO_FILE), TokenKind::SymbolOrLiteral) {
 	}
 
 	void print([[maybe_unused]] std::ostream &os) const override {
@@ -923,9 +916,9 @@ TEST_P(TestLexerInvalidLiterals, testLiteralErrors) {
 	const std::string literal_str = GetParam().first;
 	const auto &expect = GetParam().second;
 	l = Lexer(literal_str, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	std::queue<std::tuple<std::filesystem::path, size_t, size_t, std::string>> expected;
 	expected.push(expect);
 	e.checkErrors(expected);
@@ -1018,511 +1011,763 @@ INSTANTIATE_TEST_SUITE_P(testInvalidBinaryLiterals, TestLexerInvalidLiterals,
 TEST_F(TestLexer, testNewlines) {
 	std::string program = "x";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	program = "x\n";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	program = "x\n\n";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 
 	program = "\nx";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 2);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 2);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	program = "\n\nx";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 3);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 3);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 
 	program = "x\ny";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 3);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 2);
-	EXPECT_EQ(tokens[1]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 2);
+	EXPECT_EQ(tokens[1]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	program = "x\n\ny";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 3);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 3);
-	EXPECT_EQ(tokens[1]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 3);
+	EXPECT_EQ(tokens[1]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	program = "x\ny\nz";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 4);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 2);
-	EXPECT_EQ(tokens[1]->s.col, 1);
-	EXPECT_EQ(tokens[2]->s.row, 3);
-	EXPECT_EQ(tokens[2]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[3].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 2);
+	EXPECT_EQ(tokens[1]->s.col(), 1);
+	EXPECT_EQ(tokens[2]->s.row(), 3);
+	EXPECT_EQ(tokens[2]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[3].get()));
 
 	program = "\nx\ny";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 3);
-	EXPECT_EQ(tokens[0]->s.row, 2);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 3);
-	EXPECT_EQ(tokens[1]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 2);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 3);
+	EXPECT_EQ(tokens[1]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 }
 
 TEST_F(TestLexer, testCarriageReturns) {
 	std::string program = "x";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	program = "x\r";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	program = "x\r\r";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 
 	program = "\rx";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 2);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 2);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	program = "\r\rx";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 3);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 3);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 
 	program = "x\ry";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 3);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 2);
-	EXPECT_EQ(tokens[1]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 2);
+	EXPECT_EQ(tokens[1]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	program = "x\r\ry";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 3);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 3);
-	EXPECT_EQ(tokens[1]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 3);
+	EXPECT_EQ(tokens[1]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	program = "x\ry\rz";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 4);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 2);
-	EXPECT_EQ(tokens[1]->s.col, 1);
-	EXPECT_EQ(tokens[2]->s.row, 3);
-	EXPECT_EQ(tokens[2]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[3].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 2);
+	EXPECT_EQ(tokens[1]->s.col(), 1);
+	EXPECT_EQ(tokens[2]->s.row(), 3);
+	EXPECT_EQ(tokens[2]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[3].get()));
 
 	program = "\rx\ry";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 3);
-	EXPECT_EQ(tokens[0]->s.row, 2);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 3);
-	EXPECT_EQ(tokens[1]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 2);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 3);
+	EXPECT_EQ(tokens[1]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 }
 
 TEST_F(TestLexer, testWindowsLineEndings) {
 	std::string program = "x";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	program = "x\r\n";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	program = "x\r\n\r\n";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 
 	program = "\r\nx";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 2);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 2);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	program = "\r\n\r\nx";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 3);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 3);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 
 	program = "x\r\ny";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 3);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 2);
-	EXPECT_EQ(tokens[1]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 2);
+	EXPECT_EQ(tokens[1]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	program = "x\r\n\r\ny";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 3);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 3);
-	EXPECT_EQ(tokens[1]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 3);
+	EXPECT_EQ(tokens[1]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	program = "x\r\ny\r\nz";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 4);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 2);
-	EXPECT_EQ(tokens[1]->s.col, 1);
-	EXPECT_EQ(tokens[2]->s.row, 3);
-	EXPECT_EQ(tokens[2]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[3].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 2);
+	EXPECT_EQ(tokens[1]->s.col(), 1);
+	EXPECT_EQ(tokens[2]->s.row(), 3);
+	EXPECT_EQ(tokens[2]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[3].get()));
 
 	program = "\r\nx\r\ny";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 3);
-	EXPECT_EQ(tokens[0]->s.row, 2);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 3);
-	EXPECT_EQ(tokens[1]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 2);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 3);
+	EXPECT_EQ(tokens[1]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 }
 
 TEST_F(TestLexer, testColumnNumbering) {
 	std::string program = "x";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	program = " x";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 2);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 2);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	program = "  x";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 3);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 3);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	program = "   x";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 4);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 4);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 
 	program = "\nx";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 2);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 2);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	program = "\n x";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 2);
-	EXPECT_EQ(tokens[0]->s.col, 2);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 2);
+	EXPECT_EQ(tokens[0]->s.col(), 2);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	program = "\n  x";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 2);
-	EXPECT_EQ(tokens[0]->s.col, 3);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 2);
+	EXPECT_EQ(tokens[0]->s.col(), 3);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	program = "\n   x";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.row, 2);
-	EXPECT_EQ(tokens[0]->s.col, 4);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 2);
+	EXPECT_EQ(tokens[0]->s.col(), 4);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 
 	program = "x\ny";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 3);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 2);
-	EXPECT_EQ(tokens[1]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 2);
+	EXPECT_EQ(tokens[1]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	program = " x\ny";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 3);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 2);
-	EXPECT_EQ(tokens[1]->s.row, 2);
-	EXPECT_EQ(tokens[1]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 2);
+	EXPECT_EQ(tokens[1]->s.row(), 2);
+	EXPECT_EQ(tokens[1]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	program = "x\n y";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 3);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 2);
-	EXPECT_EQ(tokens[1]->s.col, 2);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 2);
+	EXPECT_EQ(tokens[1]->s.col(), 2);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	program = " x\n y";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 3);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 2);
-	EXPECT_EQ(tokens[1]->s.row, 2);
-	EXPECT_EQ(tokens[1]->s.col, 2);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 2);
+	EXPECT_EQ(tokens[1]->s.row(), 2);
+	EXPECT_EQ(tokens[1]->s.col(), 2);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	program = "x \ny";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 3);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 2);
-	EXPECT_EQ(tokens[1]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[2].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 2);
+	EXPECT_EQ(tokens[1]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
 	program = "x\n y\nz";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 4);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 2);
-	EXPECT_EQ(tokens[1]->s.col, 2);
-	EXPECT_EQ(tokens[2]->s.row, 3);
-	EXPECT_EQ(tokens[2]->s.col, 1);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[3].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 2);
+	EXPECT_EQ(tokens[1]->s.col(), 2);
+	EXPECT_EQ(tokens[2]->s.row(), 3);
+	EXPECT_EQ(tokens[2]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[3].get()));
 
 	program = "123 567 90";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 4);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 1);
-	EXPECT_EQ(tokens[1]->s.col, 5);
-	EXPECT_EQ(tokens[2]->s.row, 1);
-	EXPECT_EQ(tokens[2]->s.col, 9);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[3].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 1);
+	EXPECT_EQ(tokens[1]->s.col(), 5);
+	EXPECT_EQ(tokens[2]->s.row(), 1);
+	EXPECT_EQ(tokens[2]->s.col(), 9);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[3].get()));
 	program = "12  56  90";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 4);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 1);
-	EXPECT_EQ(tokens[1]->s.col, 5);
-	EXPECT_EQ(tokens[2]->s.row, 1);
-	EXPECT_EQ(tokens[2]->s.col, 9);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[3].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 1);
+	EXPECT_EQ(tokens[1]->s.col(), 5);
+	EXPECT_EQ(tokens[2]->s.row(), 1);
+	EXPECT_EQ(tokens[2]->s.col(), 9);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[3].get()));
 	program = "1    6  9";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 4);
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
-	EXPECT_EQ(tokens[1]->s.row, 1);
-	EXPECT_EQ(tokens[1]->s.col, 6);
-	EXPECT_EQ(tokens[2]->s.row, 1);
-	EXPECT_EQ(tokens[2]->s.col, 9);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[3].get()));
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_EQ(tokens[1]->s.row(), 1);
+	EXPECT_EQ(tokens[1]->s.col(), 6);
+	EXPECT_EQ(tokens[2]->s.row(), 1);
+	EXPECT_EQ(tokens[2]->s.col(), 9);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[3].get()));
 
 	program = "1;2,3-4*5!6&7||8::9";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 18);
 	// 1
-	EXPECT_EQ(tokens[0]->s.row, 1);
-	EXPECT_EQ(tokens[0]->s.col, 1);
+	EXPECT_EQ(tokens[0]->s.row(), 1);
+	EXPECT_EQ(tokens[0]->s.col(), 1);
 	// ;
-	EXPECT_EQ(tokens[1]->s.row, 1);
-	EXPECT_EQ(tokens[1]->s.col, 2);
+	EXPECT_EQ(tokens[1]->s.row(), 1);
+	EXPECT_EQ(tokens[1]->s.col(), 2);
 	// 2
-	EXPECT_EQ(tokens[2]->s.row, 1);
-	EXPECT_EQ(tokens[2]->s.col, 3);
+	EXPECT_EQ(tokens[2]->s.row(), 1);
+	EXPECT_EQ(tokens[2]->s.col(), 3);
 	// ,
-	EXPECT_EQ(tokens[3]->s.row, 1);
-	EXPECT_EQ(tokens[3]->s.col, 4);
+	EXPECT_EQ(tokens[3]->s.row(), 1);
+	EXPECT_EQ(tokens[3]->s.col(), 4);
 	// 3
-	EXPECT_EQ(tokens[4]->s.row, 1);
-	EXPECT_EQ(tokens[4]->s.col, 5);
+	EXPECT_EQ(tokens[4]->s.row(), 1);
+	EXPECT_EQ(tokens[4]->s.col(), 5);
 	// -
-	EXPECT_EQ(tokens[5]->s.row, 1);
-	EXPECT_EQ(tokens[5]->s.col, 6);
+	EXPECT_EQ(tokens[5]->s.row(), 1);
+	EXPECT_EQ(tokens[5]->s.col(), 6);
 	// 4
-	EXPECT_EQ(tokens[6]->s.row, 1);
-	EXPECT_EQ(tokens[6]->s.col, 7);
+	EXPECT_EQ(tokens[6]->s.row(), 1);
+	EXPECT_EQ(tokens[6]->s.col(), 7);
 	// *
-	EXPECT_EQ(tokens[7]->s.row, 1);
-	EXPECT_EQ(tokens[7]->s.col, 8);
+	EXPECT_EQ(tokens[7]->s.row(), 1);
+	EXPECT_EQ(tokens[7]->s.col(), 8);
 	// 5
-	EXPECT_EQ(tokens[8]->s.row, 1);
-	EXPECT_EQ(tokens[8]->s.col, 9);
+	EXPECT_EQ(tokens[8]->s.row(), 1);
+	EXPECT_EQ(tokens[8]->s.col(), 9);
 	// !
-	EXPECT_EQ(tokens[9]->s.row, 1);
-	EXPECT_EQ(tokens[9]->s.col, 10);
+	EXPECT_EQ(tokens[9]->s.row(), 1);
+	EXPECT_EQ(tokens[9]->s.col(), 10);
 	// 6
-	EXPECT_EQ(tokens[10]->s.row, 1);
-	EXPECT_EQ(tokens[10]->s.col, 11);
+	EXPECT_EQ(tokens[10]->s.row(), 1);
+	EXPECT_EQ(tokens[10]->s.col(), 11);
 	// &
-	EXPECT_EQ(tokens[11]->s.row, 1);
-	EXPECT_EQ(tokens[11]->s.col, 12);
+	EXPECT_EQ(tokens[11]->s.row(), 1);
+	EXPECT_EQ(tokens[11]->s.col(), 12);
 	// 7
-	EXPECT_EQ(tokens[12]->s.row, 1);
-	EXPECT_EQ(tokens[12]->s.col, 13);
+	EXPECT_EQ(tokens[12]->s.row(), 1);
+	EXPECT_EQ(tokens[12]->s.col(), 13);
 	// ||
-	EXPECT_EQ(tokens[13]->s.row, 1);
-	EXPECT_EQ(tokens[13]->s.col, 14);
+	EXPECT_EQ(tokens[13]->s.row(), 1);
+	EXPECT_EQ(tokens[13]->s.col(), 14);
 	// 8
-	EXPECT_EQ(tokens[14]->s.row, 1);
-	EXPECT_EQ(tokens[14]->s.col, 16);
+	EXPECT_EQ(tokens[14]->s.row(), 1);
+	EXPECT_EQ(tokens[14]->s.col(), 16);
 	// ::
-	EXPECT_EQ(tokens[15]->s.row, 1);
-	EXPECT_EQ(tokens[15]->s.col, 17);
+	EXPECT_EQ(tokens[15]->s.row(), 1);
+	EXPECT_EQ(tokens[15]->s.col(), 17);
 	// 9
-	EXPECT_EQ(tokens[16]->s.row, 1);
-	EXPECT_EQ(tokens[16]->s.col, 19);
+	EXPECT_EQ(tokens[16]->s.row(), 1);
+	EXPECT_EQ(tokens[16]->s.col(), 19);
 }
 
 TEST_F(TestLexer, testTabSizeConfiguration) {
 	// Default tab width (4)
 	const std::string program = "\tx";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(tokens[0]->s.col, 5);
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(tokens[0]->s.col(), 5);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 
 	// Customizable tab width
 	for (uint32_t tabSize = 1; tabSize <= 10; tabSize++) {
 		std::string program = "\tx";
 		for (uint32_t i = 0; i < tabSize; i++) {
 			l = Lexer(program, "", &e, tabSize);
-			tokens = l.lex();
+			tokens = toTokens(l.lex());
 			EXPECT_EQ(tokens.size(), 2);
-			EXPECT_EQ(tokens[0]->s.col, tabSize + 1);
-			EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+			EXPECT_EQ(tokens[0]->s.col(), tabSize + 1);
+			EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 			program = " " + program;
 		}
 		l = Lexer(program, "", &e, tabSize);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 2);
-		EXPECT_EQ(tokens[0]->s.col, 2 * tabSize + 1);
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+		EXPECT_EQ(tokens[0]->s.col(), 2 * tabSize + 1);
+		EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 	}
 }
 
 TEST_F(TestLexer, testTrueLiteral) {
 	std::string program = "true";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(*dynamic_cast<BoolLiteral *>(tokens[0].get()), BoolLiteral(dummy, true));
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(*cast<BoolLiteral>(tokens[0].get()), BoolLiteral(dummy, true));
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 }
 
 TEST_F(TestLexer, testFalseLiteral) {
 	std::string program = "false";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(*dynamic_cast<BoolLiteral *>(tokens[0].get()), BoolLiteral(dummy, false));
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(*cast<BoolLiteral>(tokens[0].get()), BoolLiteral(dummy, false));
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 }
 
 TEST_F(TestLexer, testCharacterLiteral) {
 	std::string program = "'a'";
 	l = Lexer(program, "", &e);
-	tokens = l.lex();
+	tokens = toTokens(l.lex());
 	EXPECT_EQ(tokens.size(), 2);
-	EXPECT_EQ(*dynamic_cast<CharacterLiteral *>(tokens[0].get()),
-	      CharacterLiteral(dummy, 'a'));
-	EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+	EXPECT_EQ(*cast<CharacterLiteral>(tokens[0].get()), CharacterLiteral(dummy, 'a'));
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
 }
 
 TEST_F(TestLexer, testCharacterLiteralEscapeSequences) {
 	for (const auto &escape : escapeSequences) {
 		std::string program = std::string("'") + escape.first + "'";
 		l = Lexer(program, "", &e);
-		tokens = l.lex();
+		tokens = toTokens(l.lex());
 		EXPECT_EQ(tokens.size(), 2);
-		EXPECT_EQ(*dynamic_cast<CharacterLiteral *>(tokens[0].get()),
+		EXPECT_EQ(*cast<CharacterLiteral>(tokens[0].get()),
 		      CharacterLiteral(dummy, escape.second));
-		EXPECT_TRUE(dynamic_cast<EndOfFile *>(tokens[1].get()));
+		EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
+	}
+}
+
+/**
+ * @brief Ensure that punctuation separated only by a block comment still combines into a
+ * single Operator, while a line comment (which ends in a newline) keeps them apart
+ *
+ */
+TEST_F(TestLexer, testCommentBetweenPunctuation) {
+	std::string program = "=/* comment */=";
+	l = Lexer(program, "", &e);
+	tokens = toTokens(l.lex());
+	EXPECT_EQ(tokens.size(), 2);
+	EXPECT_EQ(cast<Operator>(tokens[0].get())->type, Operator::Type::Equality);
+	EXPECT_EQ(tokens[0]->s.contents, "=/* comment */=");
+	EXPECT_EQ(tokens[0]->s.col(), 1);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
+
+	program = "=// comment\n=";
+	l = Lexer(program, "", &e);
+	tokens = toTokens(l.lex());
+	EXPECT_EQ(tokens.size(), 3);
+	EXPECT_EQ(cast<Operator>(tokens[0].get())->type, Operator::Type::Assignment);
+	EXPECT_EQ(cast<Operator>(tokens[1].get())->type, Operator::Type::Assignment);
+	EXPECT_TRUE(isa<EndOfFile>(tokens[2].get()));
+}
+
+/**
+ * @brief Ensure that an unterminated character literal is reported before any invalid
+ * literals that precede it
+ *
+ */
+TEST_F(TestLexerError, testUnterminatedLiteralErrorOrder) {
+	const std::string program = "0xg 'a";
+	l = Lexer(program, "", &e);
+	tokens = toTokens(l.lex());
+	EXPECT_EQ(tokens.size(), 2);
+	EXPECT_TRUE(isa<SymbolOrLiteral>(tokens[0].get()));
+	EXPECT_TRUE(isa<EndOfFile>(tokens[1].get()));
+	std::queue<std::tuple<std::filesystem::path, size_t, size_t, std::string>> expected;
+	expected.emplace("", 1, 5, "Unterminated character literal");
+	expected.emplace("", 1, 1, "Invalid integer literal");
+	e.checkErrors(expected);
+}
+
+/**
+ * @brief Ensure that the TokenBuffer records each Token's kind, type, value, and range of
+ * source code
+ *
+ */
+TEST_F(TestLexer, testTokenBuffer) {
+	const std::string program = "let x: u8 = 0x1Fu8 >= 'a';";
+	l = Lexer(program, "", &e);
+	TokenBuffer buffer = l.lex();
+	EXPECT_EQ(buffer.size(), 10);
+	EXPECT_EQ(buffer.kind(0), TokenKind::Keyword);
+	EXPECT_EQ(buffer.subtype(0), static_cast<uint8_t>(Keyword::Type::LET));
+	EXPECT_EQ(buffer.contents(0), "let");
+	EXPECT_EQ(buffer.kind(1), TokenKind::Symbol);
+	EXPECT_EQ(buffer.contents(1), "x");
+	EXPECT_EQ(buffer.kind(2), TokenKind::Punctuation);
+	EXPECT_EQ(buffer.subtype(2), static_cast<uint8_t>(Punctuation::Type::Colon));
+	EXPECT_EQ(buffer.kind(3), TokenKind::Symbol);
+	EXPECT_EQ(buffer.contents(3), "u8");
+	EXPECT_EQ(buffer.kind(4), TokenKind::Operator);
+	EXPECT_EQ(buffer.subtype(4), static_cast<uint8_t>(Operator::Type::Assignment));
+	EXPECT_EQ(buffer.kind(5), TokenKind::IntegerLiteral);
+	EXPECT_EQ(buffer.subtype(5), static_cast<uint8_t>(IntegerLiteral::Type::U8));
+	EXPECT_EQ(buffer.value(5), 0x1F);
+	EXPECT_EQ(buffer.contents(5), "0x1Fu8");
+	EXPECT_EQ(buffer.kind(6), TokenKind::Operator);
+	EXPECT_EQ(buffer.subtype(6),
+	      static_cast<uint8_t>(Operator::Type::GreaterThanOrEqual));
+	EXPECT_EQ(buffer.contents(6), ">=");
+	EXPECT_EQ(buffer.kind(7), TokenKind::CharacterLiteral);
+	EXPECT_EQ(buffer.value(7), 'a');
+	EXPECT_EQ(buffer.contents(7), "'a'");
+	EXPECT_EQ(buffer.kind(8), TokenKind::Punctuation);
+	EXPECT_EQ(buffer.subtype(8), static_cast<uint8_t>(Punctuation::Type::Semicolon));
+	EXPECT_EQ(buffer.kind(9), TokenKind::EndOfFile);
+	EXPECT_EQ(buffer.slice(9).col(), program.size() + 1);
+}
+
+/**
+ * @brief Ensure that every occurrence of an identifier is interned as the same SymbolID,
+ * and that distinct identifiers are given distinct, dense SymbolIDs
+ *
+ */
+TEST_F(TestLexer, testSymbolsInterned) {
+	const std::string program = "a b a c b a";
+	l = Lexer(program, "", &e);
+	TokenBuffer buffer = l.lex();
+	ASSERT_EQ(buffer.size(), 7);
+	const Interner &interner = *buffer.getInterner();
+	EXPECT_EQ(interner.size(), 3);
+	EXPECT_EQ(buffer.value(0), buffer.value(2));
+	EXPECT_EQ(buffer.value(0), buffer.value(5));
+	EXPECT_EQ(buffer.value(1), buffer.value(4));
+	EXPECT_NE(buffer.value(0), buffer.value(1));
+	EXPECT_NE(buffer.value(0), buffer.value(3));
+	EXPECT_NE(buffer.value(1), buffer.value(3));
+	for (size_t i = 0; i < 6; i++) {
+		SymbolID id = static_cast<SymbolID>(buffer.value(i));
+		EXPECT_LT(id, interner.size());
+		EXPECT_EQ(interner.getName(id), buffer.contents(i));
+	}
+	std::vector<std::unique_ptr<Token>> tokens = toTokens(buffer);
+	EXPECT_EQ(cast<Symbol>(tokens[3].get())->id, interner.find("c"));
+	EXPECT_EQ(interner.find("d"), Interner::NO_SYMBOL);
+}
+
+/**
+ * @brief Ensure that Tokens refer to their source code file by FileID, and that errors
+ * report the file's name
+ *
+ */
+TEST_F(TestLexerError, testSourceFile) {
+	const std::string program = "'a";
+	l = Lexer(program, "dir/file.canyon", &e);
+	TokenBuffer buffer = l.lex();
+	FileID source = buffer.getSource();
+	EXPECT_NE(source, SourceManager::NO_FILE);
+	EXPECT_EQ(buffer.slice(0).source, source);
+	EXPECT_EQ(SourceManager::getPath(source), "dir/file.canyon");
+	std::queue<std::tuple<std::filesystem::path, size_t, size_t, std::string>> expected;
+	expected.emplace("dir/file.canyon", 1, 1, "Unterminated character literal");
+	e.checkErrors(expected);
+}
+
+/**
+ * @brief Ensure that every character classification kernel supported by this CPU lexes
+ * runs of whitespace, identifiers, and comments longer than a vector identically
+ *
+ */
+TEST_F(TestLexer, testCharacterClassKernels) {
+	const std::string program
+	      = "fun abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_x()"
+	        "                                        \t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\n"
+	        "// a line comment which is longer than thirty-two characters\n"
+	        "/* a block comment * which / is * longer than thirty-two characters **/"
+	        "0x0123456789ABCDEFu64 == '\\n'\r\n\v\f  \xc3\xa9x_1;";
+	CharClass::Kernel original = CharClass::getKernel();
+	ASSERT_TRUE(CharClass::setKernel(CharClass::Kernel::Scalar));
+	l = Lexer(program, "", &e);
+	std::vector<std::unique_ptr<Token>> expected = toTokens(l.lex());
+	for (CharClass::Kernel kernel : {CharClass::Kernel::SSE2, CharClass::Kernel::AVX2}) {
+		if (!CharClass::setKernel(kernel)) {
+			continue;
+		}
+		l = Lexer(program, "", &e);
+		tokens = toTokens(l.lex());
+		ASSERT_EQ(tokens.size(), expected.size());
+		for (size_t i = 0; i < tokens.size(); i++) {
+			EXPECT_EQ(tokens[i]->kind, expected[i]->kind);
+			EXPECT_EQ(tokens[i]->s.contents, expected[i]->s.contents);
+			EXPECT_EQ(tokens[i]->s.row(), expected[i]->s.row());
+			EXPECT_EQ(tokens[i]->s.col(), expected[i]->s.col());
+		}
+	}
+	CharClass::setKernel(original);
+	EXPECT_EQ(expected.size(), 13);
+}
+
+/**
+ * @brief Ensure that two TokenBuffers over the same source code hold the same Tokens,
+ * with the same SymbolIDs
+ */
+static void expectSameTokens(const TokenBuffer &actual, const TokenBuffer &expected) {
+	ASSERT_EQ(actual.size(), expected.size());
+	for (size_t i = 0; i < actual.size(); i++) {
+		EXPECT_EQ(actual.kind(i), expected.kind(i));
+		EXPECT_EQ(actual.subtype(i), expected.subtype(i));
+		EXPECT_EQ(actual.value(i), expected.value(i));
+		EXPECT_EQ(actual.contents(i).data(), expected.contents(i).data());
+		EXPECT_EQ(actual.contents(i).size(), expected.contents(i).size());
+	}
+	const Interner &actualNames = *actual.getInterner();
+	const Interner &expectedNames = *expected.getInterner();
+	ASSERT_EQ(actualNames.size(), expectedNames.size());
+	for (SymbolID id = 0; id < actualNames.size(); id++) {
+		EXPECT_EQ(actualNames.getName(id), expectedNames.getName(id));
+	}
+}
+
+/**
+ * @brief Ensure that lexing a large program on several threads gives the same Tokens and
+ * SymbolIDs as lexing it in sequence, even where a fun keyword begins a line inside a
+ * comment
+ *
+ */
+TEST_F(TestLexer, testParallelLexing) {
+	std::string program;
+	for (size_t i = 0; program.size() < 1024 * 1024; i++) {
+		const std::string n = std::to_string(i);
+		program += "// Function number " + n + "\n";
+		program += "fun f" + n + "(a: i32): i32 {\n";
+		program += "\tlet c: char = '\\'';\n";
+		program += "\t/* commented out\nfun g" + n + "(): i32 {\n} */\n";
+		program += "\tlet d: char = '/';\n";
+		program += "\ta + " + n + " /*/ star-slash */ - 1 // fun\n";
+		program += "}\n";
+	}
+	l = Lexer(program, "", &e);
+	TokenBuffer expected = l.lex();
+	for (size_t threads : {2, 3, 8}) {
+		ThreadPool threadPool(threads);
+		l = Lexer(program, "", &e, Lexer::DEFAULT_TAB_SIZE, &threadPool);
+		expectSameTokens(l.lex(), expected);
+	}
+}
+
+/**
+ * @brief Ensure that lexing a large program on several threads reports an unterminated
+ * block comment before the invalid literals that precede it, in order, and does not
+ * split the program inside a character literal
+ *
+ */
+TEST_F(TestLexerError, testParallelLexingErrors) {
+	constexpr size_t FUNCTIONS = 8192;
+	std::string program;
+	std::queue<std::tuple<std::filesystem::path, size_t, size_t, std::string>> expected;
+	expected.emplace("", FUNCTIONS * 5 + 1, 1, "Unterminated block comment");
+	for (size_t i = 0; i < FUNCTIONS; i++) {
+		program += "fun f" + std::to_string(i) + "() {\n";
+		program += "\tlet x: i32 = 0xg;\n";
+		program += "\tlet c: char = 'a\nfun b';\n";
+		program += "}\n";
+		expected.emplace("", i * 5 + 2, 18, "Invalid integer literal");
+		expected.emplace("", i * 5 + 3, 19, "Invalid character literal");
+	}
+	program += "/* unterminated\nfun g() {}\n";
+
+	ErrorHandler sequentialErrors;
+	TokenBuffer sequential = Lexer(program, "", &sequentialErrors).lex();
+	ThreadPool threadPool(4);
+	l = Lexer(program, "", &e, Lexer::DEFAULT_TAB_SIZE, &threadPool);
+	expectSameTokens(l.lex(), sequential);
+	e.checkErrors(expected);
+}
+
+TEST(testLexer, testLexemeTable) {
+	for (std::string_view spelling : {"return", "true", "(", "^", "==", "::", "||"}) {
+		const Lexeme *lexeme = LexemeTable::find(spelling);
+		ASSERT_NE(lexeme, nullptr);
+		EXPECT_EQ(lexeme->spelling, spelling);
+	}
+	EXPECT_EQ(LexemeTable::find("=")->kind, TokenKind::Operator);
+	EXPECT_EQ(LexemeTable::find(";")->kind, TokenKind::Punctuation);
+	EXPECT_EQ(LexemeTable::find("while")->kind, TokenKind::Keyword);
+	EXPECT_EQ(LexemeTable::find("false")->value, 0);
+	// Near misses, some of which hash to the same slot as a lexeme
+	for (std::string_view word : {"", "rn", "raturn", "tree", "=!=", "=:", "|&|", "_"}) {
+		EXPECT_EQ(LexemeTable::find(word), nullptr);
 	}
 }
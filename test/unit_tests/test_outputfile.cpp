@@ -0,0 +1,200 @@
+#ifndef DEBUG_TEST_MODE
+#	error "DEBUG_TEST_MODE not defined"
+#endif
+
+#include "outputfile.h"
+
+#include "gtest/gtest.h"
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <pthread.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+/**
+ * @brief A file in the temporary directory which is removed when the test ends
+ */
+class TemporaryFile {
+	std::filesystem::path path;
+public:
+	explicit TemporaryFile(const std::string &name)
+	    : path(std::filesystem::temp_directory_path()
+	           / ("canyon_" + std::to_string(getpid()) + "_" + name)) {
+	}
+	TemporaryFile(const TemporaryFile &) = delete;
+	TemporaryFile &operator=(const TemporaryFile &) = delete;
+	~TemporaryFile() {
+		std::filesystem::remove(path);
+	}
+
+	const std::filesystem::path &getPath() const {
+		return path;
+	}
+
+	std::string read() const {
+		std::ifstream file(path, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(file),
+		      std::istreambuf_iterator<char>());
+	}
+};
+
+/**
+ * @brief Makes text of a given length which differs from byte to byte, so that anything
+ * written out of place or twice shows up
+ */
+static std::string pattern(size_t length, char first) {
+	std::string text(length, '\0');
+	for (size_t i = 0; i < length; i++) {
+		text[i] = static_cast<char>(first + i % 26);
+	}
+	return text;
+}
+
+/**
+ * @brief Ensure that fragments just under, at, and over the size of the buffer are
+ * written in order, whether they are copied into the buffer or written from where they
+ * are together with what was buffered before them
+ *
+ */
+TEST(testOutputFile, testFragmentSizes) {
+	for (size_t size : {OutputFile::BUFFER_SIZE - 1, OutputFile::BUFFER_SIZE,
+	           OutputFile::BUFFER_SIZE + 1}) {
+		TemporaryFile file("fragments.c");
+		std::optional<OutputFile> out = OutputFile::open(file.getPath());
+		ASSERT_TRUE(out.has_value());
+		std::string expected = "head";
+		*out << "head";
+		for (char first : {'a', 'A', 'a'}) {
+			std::string fragment = pattern(size, first);
+			*out << fragment << ';';
+			expected += fragment + ';';
+		}
+		EXPECT_EQ(out->size(), expected.size());
+		ASSERT_TRUE(out->close());
+		EXPECT_EQ(file.read(), expected);
+	}
+}
+
+/**
+ * @brief Ensure that indentation deeper than the table of tabs is written in full, and
+ * that integers are written in decimal up to the largest uint64_t
+ *
+ */
+TEST(testOutputFile, testIndentAndIntegers) {
+	TemporaryFile file("indent.c");
+	std::optional<OutputFile> out = OutputFile::open(file.getPath());
+	ASSERT_TRUE(out.has_value());
+	out->indent(40);
+	*out << uint64_t{0} << ' ' << std::numeric_limits<uint64_t>::max() << '\n';
+	out->indent(0);
+	out->indent(-3);
+	out->indent(1);
+	*out << uint64_t{42};
+	ASSERT_TRUE(out->close());
+	EXPECT_EQ(file.read(), std::string(40, '\t') + "0 18446744073709551615\n\t42");
+}
+
+/**
+ * @brief Ensure that an OutputFile kept in memory grows to hold everything written to
+ * it, one character at a time and in fragments larger than its buffer
+ *
+ */
+TEST(testOutputFile, testInMemoryGrowth) {
+	OutputFile out = OutputFile::inMemory();
+	std::string expected;
+	for (size_t i = 0; i < OutputFile::INITIAL_MEMORY_SIZE + 1; i++) {
+		out << static_cast<char>('a' + i % 26);
+		expected += static_cast<char>('a' + i % 26);
+	}
+	std::string fragment = pattern(OutputFile::INITIAL_MEMORY_SIZE * 5, 'A');
+	out << fragment;
+	expected += fragment;
+	out.indent(20);
+	expected += std::string(20, '\t');
+	EXPECT_EQ(out.getContents(), expected);
+	EXPECT_EQ(out.size(), expected.size());
+	EXPECT_TRUE(out.close());
+}
+
+/**
+ * @brief Ensure that a write which only partly succeeds keeps what was written, and that
+ * the failure of the rest is reported by close through errno. Limiting the size of files
+ * the process may write makes the kernel write up to the limit and then fail
+ *
+ */
+TEST(testOutputFile, testWriteErrorReported) {
+	constexpr size_t LIMIT = 1000;
+	rlimit original{};
+	ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &original), 0);
+	rlimit limited = original;
+	limited.rlim_cur = LIMIT;
+	auto previousHandler = std::signal(SIGXFSZ, SIG_IGN);
+	ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &limited), 0);
+
+	TemporaryFile file("limited.c");
+	std::optional<OutputFile> out = OutputFile::open(file.getPath());
+	ASSERT_TRUE(out.has_value());
+	std::string text = pattern(OutputFile::BUFFER_SIZE + 1, 'a');
+	*out << "head" << text << "tail";
+	bool closed = out->close();
+	int error = errno;
+
+	setrlimit(RLIMIT_FSIZE, &original);
+	std::signal(SIGXFSZ, previousHandler);
+	EXPECT_FALSE(closed);
+	EXPECT_EQ(error, EFBIG);
+	EXPECT_EQ(file.read(), ("head" + text).substr(0, LIMIT));
+}
+
+/**
+ * @brief Ensure that writes which a signal interrupts partway through are resumed from
+ * where they stopped. The writer fills a pipe that nothing reads yet, is interrupted once
+ * it blocks, and only then is the pipe drained
+ *
+ */
+TEST(testOutputFile, testPartialWritesResumed) {
+	int fds[2];
+	ASSERT_EQ(pipe(fds), 0);
+	struct sigaction interrupt {};
+	interrupt.sa_handler = [](int) {};
+	struct sigaction previousAction {};
+	// Without SA_RESTART, an interrupted write returns how much it wrote
+	ASSERT_EQ(sigaction(SIGUSR1, &interrupt, &previousAction), 0);
+
+	std::string text = pattern(OutputFile::BUFFER_SIZE * 2, 'a');
+	std::string received;
+	pthread_t writer = pthread_self();
+	std::thread reader([&received, writer, fd = fds[0]]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		pthread_kill(writer, SIGUSR1);
+		char chunk[4096];
+		for (ssize_t count; (count = ::read(fd, chunk, sizeof(chunk))) > 0;) {
+			received.append(chunk, count);
+		}
+	});
+	std::optional<OutputFile> out
+	      = OutputFile::open("/dev/fd/" + std::to_string(fds[1]));
+	EXPECT_TRUE(out.has_value());
+	if (out.has_value()) {
+		*out << "head" << text;
+		EXPECT_TRUE(out->close());
+	}
+	::close(fds[1]);
+	reader.join();
+	::close(fds[0]);
+	sigaction(SIGUSR1, &previousAction, nullptr);
+	EXPECT_EQ(received, "head" + text);
+}
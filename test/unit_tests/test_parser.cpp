@@ -3,17 +3,25 @@
 #endif
 
 #include "ast.h"
+#include "casting.h"
+#include "lexer.h"
 #include "parser.h"
+#include "semanticanalyzer.h"
 #include "test_utilities.h"
+#include "threadpool.h"
+#include "tokenbuffer.h"
 #include "tokens.h"
 
 #include "gtest/gtest.h"
 
 #include <array>
+#include <cstddef>
 #include <filesystem>
 #include <initializer_list>
+#include <iostream>
 #include <memory>
 #include <queue>
+#include <sstream>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -22,13 +30,8 @@
 using namespace ::testing;
 
 class TestParser : public testing::Test {
-public:
-	TestParser() : s(Slice("", "", 0, 0)), dummy(s) {
-	}
 protected:
 	NoErrorHandler e;
-	Slice s;
-	Whitespace dummy;
 };
 
 class TestParserAssociativityLeftBinary
@@ -36,21 +39,21 @@ class TestParserAssociativityLeftBinary
       public testing::WithParamInterface<std::array<Operator::Type, 6>> { };
 
 TEST_F(TestParser, testPrecedenceUnaryFunctionCall) {
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::LogicalNot));
-	tokens.push_back(std::make_unique<Symbol>(Slice("x", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.op(Operator::Type::LogicalNot);
+	tokens.symbol("x");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([]([[maybe_unused]]
 	                           std::string_view s,
@@ -58,34 +61,34 @@ TEST_F(TestParser, testPrecedenceUnaryFunctionCall) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *unary = dynamic_cast<UnaryExpression *>(expr);
+		auto *unary = dyn_cast<UnaryExpression>(expr);
 		EXPECT_NE(unary, nullptr);
 		EXPECT_EQ(unary->getOperator().type, Operator::Type::LogicalNot);
-		auto &call = dynamic_cast<FunctionCallExpression &>(unary->getExpression());
-		auto &name = dynamic_cast<SymbolExpression &>(call.getFunction());
+		auto &call = cast<FunctionCallExpression>(unary->getExpression());
+		auto &name = cast<SymbolExpression>(call.getFunction());
 		EXPECT_EQ(name.getSymbol().s.contents, "x");
 	});
 }
 
 TEST_F(TestParser, testPrecedenceFunctionCallMultiplicative) {
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Symbol>(Slice("x", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::Multiplication));
-	tokens.push_back(std::make_unique<Symbol>(Slice("y", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.symbol("x");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.op(Operator::Type::Multiplication);
+	tokens.symbol("y");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([]([[maybe_unused]]
 	                           std::string_view name,
@@ -93,37 +96,37 @@ TEST_F(TestParser, testPrecedenceFunctionCallMultiplicative) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *binary = dynamic_cast<BinaryExpression *>(expr);
+		auto *binary = dyn_cast<BinaryExpression>(expr);
 		EXPECT_NE(binary, nullptr);
 		EXPECT_EQ(binary->getOperator().type, Operator::Type::Multiplication);
-		auto &left = dynamic_cast<FunctionCallExpression &>(binary->getLeft());
-		auto &leftName = dynamic_cast<SymbolExpression &>(left.getFunction());
+		auto &left = cast<FunctionCallExpression>(binary->getLeft());
+		auto &leftName = cast<SymbolExpression>(left.getFunction());
 		EXPECT_EQ(leftName.getSymbol().s.contents, "x");
-		auto &right = dynamic_cast<FunctionCallExpression &>(binary->getRight());
-		auto &rightName = dynamic_cast<SymbolExpression &>(right.getFunction());
+		auto &right = cast<FunctionCallExpression>(binary->getRight());
+		auto &rightName = cast<SymbolExpression>(right.getFunction());
 		EXPECT_EQ(rightName.getSymbol().s.contents, "y");
 	});
 }
 
 TEST_F(TestParser, testPrecedenceMultiplicativeAdditive) {
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Symbol>(Slice("a", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::Multiplication));
-	tokens.push_back(std::make_unique<Symbol>(Slice("b", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::Addition));
-	tokens.push_back(std::make_unique<Symbol>(Slice("c", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::Division));
-	tokens.push_back(std::make_unique<Symbol>(Slice("d", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.symbol("a");
+	tokens.op(Operator::Type::Multiplication);
+	tokens.symbol("b");
+	tokens.op(Operator::Type::Addition);
+	tokens.symbol("c");
+	tokens.op(Operator::Type::Division);
+	tokens.symbol("d");
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([]([[maybe_unused]]
 	                           std::string_view name,
@@ -131,43 +134,43 @@ TEST_F(TestParser, testPrecedenceMultiplicativeAdditive) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *outer = dynamic_cast<BinaryExpression *>(expr);
+		auto *outer = dyn_cast<BinaryExpression>(expr);
 		EXPECT_NE(outer, nullptr);
 		EXPECT_EQ(outer->getOperator().type, Operator::Type::Addition);
-		auto &left = dynamic_cast<BinaryExpression &>(outer->getLeft());
+		auto &left = cast<BinaryExpression>(outer->getLeft());
 		EXPECT_EQ(left.getOperator().type, Operator::Type::Multiplication);
-		auto &leftLeft = dynamic_cast<SymbolExpression &>(left.getLeft());
+		auto &leftLeft = cast<SymbolExpression>(left.getLeft());
 		EXPECT_EQ(leftLeft.getSymbol().s.contents, "a");
-		auto &leftRight = dynamic_cast<SymbolExpression &>(left.getRight());
+		auto &leftRight = cast<SymbolExpression>(left.getRight());
 		EXPECT_EQ(leftRight.getSymbol().s.contents, "b");
-		auto &right = dynamic_cast<BinaryExpression &>(outer->getRight());
+		auto &right = cast<BinaryExpression>(outer->getRight());
 		EXPECT_EQ(right.getOperator().type, Operator::Type::Division);
-		auto &rightLeft = dynamic_cast<SymbolExpression &>(right.getLeft());
+		auto &rightLeft = cast<SymbolExpression>(right.getLeft());
 		EXPECT_EQ(rightLeft.getSymbol().s.contents, "c");
-		auto &rightRight = dynamic_cast<SymbolExpression &>(right.getRight());
+		auto &rightRight = cast<SymbolExpression>(right.getRight());
 		EXPECT_EQ(rightRight.getSymbol().s.contents, "d");
 	});
 }
 
 TEST_F(TestParser, testPrecedenceAdditiveBitshift) {
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Symbol>(Slice("a", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::Addition));
-	tokens.push_back(std::make_unique<Symbol>(Slice("b", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseShiftLeft));
-	tokens.push_back(std::make_unique<Symbol>(Slice("c", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::Subtraction));
-	tokens.push_back(std::make_unique<Symbol>(Slice("d", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.symbol("a");
+	tokens.op(Operator::Type::Addition);
+	tokens.symbol("b");
+	tokens.op(Operator::Type::BitwiseShiftLeft);
+	tokens.symbol("c");
+	tokens.op(Operator::Type::Subtraction);
+	tokens.symbol("d");
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([]([[maybe_unused]]
 	                           std::string_view name,
@@ -175,44 +178,43 @@ TEST_F(TestParser, testPrecedenceAdditiveBitshift) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *outer = dynamic_cast<BinaryExpression *>(expr);
+		auto *outer = dyn_cast<BinaryExpression>(expr);
 		EXPECT_NE(outer, nullptr);
 		EXPECT_EQ(outer->getOperator().type, Operator::Type::BitwiseShiftLeft);
-		auto &left = dynamic_cast<BinaryExpression &>(outer->getLeft());
+		auto &left = cast<BinaryExpression>(outer->getLeft());
 		EXPECT_EQ(left.getOperator().type, Operator::Type::Addition);
-		auto &leftLeft = dynamic_cast<SymbolExpression &>(left.getLeft());
+		auto &leftLeft = cast<SymbolExpression>(left.getLeft());
 		EXPECT_EQ(leftLeft.getSymbol().s.contents, "a");
-		auto &leftRight = dynamic_cast<SymbolExpression &>(left.getRight());
+		auto &leftRight = cast<SymbolExpression>(left.getRight());
 		EXPECT_EQ(leftRight.getSymbol().s.contents, "b");
-		auto &right = dynamic_cast<BinaryExpression &>(outer->getRight());
+		auto &right = cast<BinaryExpression>(outer->getRight());
 		EXPECT_EQ(right.getOperator().type, Operator::Type::Subtraction);
-		auto &rightLeft = dynamic_cast<SymbolExpression &>(right.getLeft());
+		auto &rightLeft = cast<SymbolExpression>(right.getLeft());
 		EXPECT_EQ(rightLeft.getSymbol().s.contents, "c");
-		auto &rightRight = dynamic_cast<SymbolExpression &>(right.getRight());
+		auto &rightRight = cast<SymbolExpression>(right.getRight());
 		EXPECT_EQ(rightRight.getSymbol().s.contents, "d");
 	});
 }
 
 TEST_F(TestParser, testPrecedenceBitshiftBitwiseAnd) {
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Symbol>(Slice("a", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseShiftLeft));
-	tokens.push_back(std::make_unique<Symbol>(Slice("b", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseAnd));
-	tokens.push_back(std::make_unique<Symbol>(Slice("c", "", 0, 0)));
-	tokens.push_back(
-	      std::make_unique<Operator>(dummy, Operator::Type::BitwiseShiftRight));
-	tokens.push_back(std::make_unique<Symbol>(Slice("d", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.symbol("a");
+	tokens.op(Operator::Type::BitwiseShiftLeft);
+	tokens.symbol("b");
+	tokens.op(Operator::Type::BitwiseAnd);
+	tokens.symbol("c");
+	tokens.op(Operator::Type::BitwiseShiftRight);
+	tokens.symbol("d");
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([]([[maybe_unused]]
 	                           std::string_view name,
@@ -220,43 +222,43 @@ TEST_F(TestParser, testPrecedenceBitshiftBitwiseAnd) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *outer = dynamic_cast<BinaryExpression *>(expr);
+		auto *outer = dyn_cast<BinaryExpression>(expr);
 		EXPECT_NE(outer, nullptr);
 		EXPECT_EQ(outer->getOperator().type, Operator::Type::BitwiseAnd);
-		auto &left = dynamic_cast<BinaryExpression &>(outer->getLeft());
+		auto &left = cast<BinaryExpression>(outer->getLeft());
 		EXPECT_EQ(left.getOperator().type, Operator::Type::BitwiseShiftLeft);
-		auto &leftLeft = dynamic_cast<SymbolExpression &>(left.getLeft());
+		auto &leftLeft = cast<SymbolExpression>(left.getLeft());
 		EXPECT_EQ(leftLeft.getSymbol().s.contents, "a");
-		auto &leftRight = dynamic_cast<SymbolExpression &>(left.getRight());
+		auto &leftRight = cast<SymbolExpression>(left.getRight());
 		EXPECT_EQ(leftRight.getSymbol().s.contents, "b");
-		auto &right = dynamic_cast<BinaryExpression &>(outer->getRight());
+		auto &right = cast<BinaryExpression>(outer->getRight());
 		EXPECT_EQ(right.getOperator().type, Operator::Type::BitwiseShiftRight);
-		auto &rightLeft = dynamic_cast<SymbolExpression &>(right.getLeft());
+		auto &rightLeft = cast<SymbolExpression>(right.getLeft());
 		EXPECT_EQ(rightLeft.getSymbol().s.contents, "c");
-		auto &rightRight = dynamic_cast<SymbolExpression &>(right.getRight());
+		auto &rightRight = cast<SymbolExpression>(right.getRight());
 		EXPECT_EQ(rightRight.getSymbol().s.contents, "d");
 	});
 }
 
 TEST_F(TestParser, testPrecedenceBitwiseAndBitwiseXor) {
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Symbol>(Slice("a", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseAnd));
-	tokens.push_back(std::make_unique<Symbol>(Slice("b", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseXor));
-	tokens.push_back(std::make_unique<Symbol>(Slice("c", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseAnd));
-	tokens.push_back(std::make_unique<Symbol>(Slice("d", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.symbol("a");
+	tokens.op(Operator::Type::BitwiseAnd);
+	tokens.symbol("b");
+	tokens.op(Operator::Type::BitwiseXor);
+	tokens.symbol("c");
+	tokens.op(Operator::Type::BitwiseAnd);
+	tokens.symbol("d");
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([]([[maybe_unused]]
 	                           std::string_view name,
@@ -264,43 +266,43 @@ TEST_F(TestParser, testPrecedenceBitwiseAndBitwiseXor) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *outer = dynamic_cast<BinaryExpression *>(expr);
+		auto *outer = dyn_cast<BinaryExpression>(expr);
 		EXPECT_NE(outer, nullptr);
 		EXPECT_EQ(outer->getOperator().type, Operator::Type::BitwiseXor);
-		auto &left = dynamic_cast<BinaryExpression &>(outer->getLeft());
+		auto &left = cast<BinaryExpression>(outer->getLeft());
 		EXPECT_EQ(left.getOperator().type, Operator::Type::BitwiseAnd);
-		auto &leftLeft = dynamic_cast<SymbolExpression &>(left.getLeft());
+		auto &leftLeft = cast<SymbolExpression>(left.getLeft());
 		EXPECT_EQ(leftLeft.getSymbol().s.contents, "a");
-		auto &leftRight = dynamic_cast<SymbolExpression &>(left.getRight());
+		auto &leftRight = cast<SymbolExpression>(left.getRight());
 		EXPECT_EQ(leftRight.getSymbol().s.contents, "b");
-		auto &right = dynamic_cast<BinaryExpression &>(outer->getRight());
+		auto &right = cast<BinaryExpression>(outer->getRight());
 		EXPECT_EQ(right.getOperator().type, Operator::Type::BitwiseAnd);
-		auto &rightLeft = dynamic_cast<SymbolExpression &>(right.getLeft());
+		auto &rightLeft = cast<SymbolExpression>(right.getLeft());
 		EXPECT_EQ(rightLeft.getSymbol().s.contents, "c");
-		auto &rightRight = dynamic_cast<SymbolExpression &>(right.getRight());
+		auto &rightRight = cast<SymbolExpression>(right.getRight());
 		EXPECT_EQ(rightRight.getSymbol().s.contents, "d");
 	});
 }
 
 TEST_F(TestParser, testPrecedenceBitwiseXorBitwiseOr) {
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Symbol>(Slice("a", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseXor));
-	tokens.push_back(std::make_unique<Symbol>(Slice("b", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseOr));
-	tokens.push_back(std::make_unique<Symbol>(Slice("c", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseXor));
-	tokens.push_back(std::make_unique<Symbol>(Slice("d", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.symbol("a");
+	tokens.op(Operator::Type::BitwiseXor);
+	tokens.symbol("b");
+	tokens.op(Operator::Type::BitwiseOr);
+	tokens.symbol("c");
+	tokens.op(Operator::Type::BitwiseXor);
+	tokens.symbol("d");
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([]([[maybe_unused]]
 	                           std::string_view name,
@@ -308,43 +310,43 @@ TEST_F(TestParser, testPrecedenceBitwiseXorBitwiseOr) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *outer = dynamic_cast<BinaryExpression *>(expr);
+		auto *outer = dyn_cast<BinaryExpression>(expr);
 		EXPECT_NE(outer, nullptr);
 		EXPECT_EQ(outer->getOperator().type, Operator::Type::BitwiseOr);
-		auto &left = dynamic_cast<BinaryExpression &>(outer->getLeft());
+		auto &left = cast<BinaryExpression>(outer->getLeft());
 		EXPECT_EQ(left.getOperator().type, Operator::Type::BitwiseXor);
-		auto &leftLeft = dynamic_cast<SymbolExpression &>(left.getLeft());
+		auto &leftLeft = cast<SymbolExpression>(left.getLeft());
 		EXPECT_EQ(leftLeft.getSymbol().s.contents, "a");
-		auto &leftRight = dynamic_cast<SymbolExpression &>(left.getRight());
+		auto &leftRight = cast<SymbolExpression>(left.getRight());
 		EXPECT_EQ(leftRight.getSymbol().s.contents, "b");
-		auto &right = dynamic_cast<BinaryExpression &>(outer->getRight());
+		auto &right = cast<BinaryExpression>(outer->getRight());
 		EXPECT_EQ(right.getOperator().type, Operator::Type::BitwiseXor);
-		auto &rightLeft = dynamic_cast<SymbolExpression &>(right.getLeft());
+		auto &rightLeft = cast<SymbolExpression>(right.getLeft());
 		EXPECT_EQ(rightLeft.getSymbol().s.contents, "c");
-		auto &rightRight = dynamic_cast<SymbolExpression &>(right.getRight());
+		auto &rightRight = cast<SymbolExpression>(right.getRight());
 		EXPECT_EQ(rightRight.getSymbol().s.contents, "d");
 	});
 }
 
 TEST_F(TestParser, testPrecedenceBitwiseOrRelational) {
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Symbol>(Slice("a", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseOr));
-	tokens.push_back(std::make_unique<Symbol>(Slice("b", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::LessThan));
-	tokens.push_back(std::make_unique<Symbol>(Slice("c", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseOr));
-	tokens.push_back(std::make_unique<Symbol>(Slice("d", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.symbol("a");
+	tokens.op(Operator::Type::BitwiseOr);
+	tokens.symbol("b");
+	tokens.op(Operator::Type::LessThan);
+	tokens.symbol("c");
+	tokens.op(Operator::Type::BitwiseOr);
+	tokens.symbol("d");
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([]([[maybe_unused]]
 	                           std::string_view name,
@@ -352,43 +354,43 @@ TEST_F(TestParser, testPrecedenceBitwiseOrRelational) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *outer = dynamic_cast<BinaryExpression *>(expr);
+		auto *outer = dyn_cast<BinaryExpression>(expr);
 		EXPECT_NE(outer, nullptr);
 		EXPECT_EQ(outer->getOperator().type, Operator::Type::LessThan);
-		auto &left = dynamic_cast<BinaryExpression &>(outer->getLeft());
+		auto &left = cast<BinaryExpression>(outer->getLeft());
 		EXPECT_EQ(left.getOperator().type, Operator::Type::BitwiseOr);
-		auto &leftLeft = dynamic_cast<SymbolExpression &>(left.getLeft());
+		auto &leftLeft = cast<SymbolExpression>(left.getLeft());
 		EXPECT_EQ(leftLeft.getSymbol().s.contents, "a");
-		auto &leftRight = dynamic_cast<SymbolExpression &>(left.getRight());
+		auto &leftRight = cast<SymbolExpression>(left.getRight());
 		EXPECT_EQ(leftRight.getSymbol().s.contents, "b");
-		auto &right = dynamic_cast<BinaryExpression &>(outer->getRight());
+		auto &right = cast<BinaryExpression>(outer->getRight());
 		EXPECT_EQ(right.getOperator().type, Operator::Type::BitwiseOr);
-		auto &rightLeft = dynamic_cast<SymbolExpression &>(right.getLeft());
+		auto &rightLeft = cast<SymbolExpression>(right.getLeft());
 		EXPECT_EQ(rightLeft.getSymbol().s.contents, "c");
-		auto &rightRight = dynamic_cast<SymbolExpression &>(right.getRight());
+		auto &rightRight = cast<SymbolExpression>(right.getRight());
 		EXPECT_EQ(rightRight.getSymbol().s.contents, "d");
 	});
 }
 
 TEST_F(TestParser, testPrecedenceRelationalLogicalAnd) {
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Symbol>(Slice("a", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::LessThan));
-	tokens.push_back(std::make_unique<Symbol>(Slice("b", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::LogicalAnd));
-	tokens.push_back(std::make_unique<Symbol>(Slice("c", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::GreaterThan));
-	tokens.push_back(std::make_unique<Symbol>(Slice("d", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.symbol("a");
+	tokens.op(Operator::Type::LessThan);
+	tokens.symbol("b");
+	tokens.op(Operator::Type::LogicalAnd);
+	tokens.symbol("c");
+	tokens.op(Operator::Type::GreaterThan);
+	tokens.symbol("d");
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([]([[maybe_unused]]
 	                           std::string_view name,
@@ -396,43 +398,43 @@ TEST_F(TestParser, testPrecedenceRelationalLogicalAnd) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *outer = dynamic_cast<BinaryExpression *>(expr);
+		auto *outer = dyn_cast<BinaryExpression>(expr);
 		EXPECT_NE(outer, nullptr);
 		EXPECT_EQ(outer->getOperator().type, Operator::Type::LogicalAnd);
-		auto &left = dynamic_cast<BinaryExpression &>(outer->getLeft());
+		auto &left = cast<BinaryExpression>(outer->getLeft());
 		EXPECT_EQ(left.getOperator().type, Operator::Type::LessThan);
-		auto &leftLeft = dynamic_cast<SymbolExpression &>(left.getLeft());
+		auto &leftLeft = cast<SymbolExpression>(left.getLeft());
 		EXPECT_EQ(leftLeft.getSymbol().s.contents, "a");
-		auto &leftRight = dynamic_cast<SymbolExpression &>(left.getRight());
+		auto &leftRight = cast<SymbolExpression>(left.getRight());
 		EXPECT_EQ(leftRight.getSymbol().s.contents, "b");
-		auto &right = dynamic_cast<BinaryExpression &>(outer->getRight());
+		auto &right = cast<BinaryExpression>(outer->getRight());
 		EXPECT_EQ(right.getOperator().type, Operator::Type::GreaterThan);
-		auto &rightLeft = dynamic_cast<SymbolExpression &>(right.getLeft());
+		auto &rightLeft = cast<SymbolExpression>(right.getLeft());
 		EXPECT_EQ(rightLeft.getSymbol().s.contents, "c");
-		auto &rightRight = dynamic_cast<SymbolExpression &>(right.getRight());
+		auto &rightRight = cast<SymbolExpression>(right.getRight());
 		EXPECT_EQ(rightRight.getSymbol().s.contents, "d");
 	});
 }
 
 TEST_F(TestParser, testPrecedenceLogicalAndLogicalOr) {
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Symbol>(Slice("a", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::LogicalAnd));
-	tokens.push_back(std::make_unique<Symbol>(Slice("b", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::LogicalOr));
-	tokens.push_back(std::make_unique<Symbol>(Slice("c", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::LogicalAnd));
-	tokens.push_back(std::make_unique<Symbol>(Slice("d", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.symbol("a");
+	tokens.op(Operator::Type::LogicalAnd);
+	tokens.symbol("b");
+	tokens.op(Operator::Type::LogicalOr);
+	tokens.symbol("c");
+	tokens.op(Operator::Type::LogicalAnd);
+	tokens.symbol("d");
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([]([[maybe_unused]]
 	                           std::string_view name,
@@ -440,43 +442,43 @@ TEST_F(TestParser, testPrecedenceLogicalAndLogicalOr) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *outer = dynamic_cast<BinaryExpression *>(expr);
+		auto *outer = dyn_cast<BinaryExpression>(expr);
 		EXPECT_NE(outer, nullptr);
 		EXPECT_EQ(outer->getOperator().type, Operator::Type::LogicalOr);
-		auto &left = dynamic_cast<BinaryExpression &>(outer->getLeft());
+		auto &left = cast<BinaryExpression>(outer->getLeft());
 		EXPECT_EQ(left.getOperator().type, Operator::Type::LogicalAnd);
-		auto &leftLeft = dynamic_cast<SymbolExpression &>(left.getLeft());
+		auto &leftLeft = cast<SymbolExpression>(left.getLeft());
 		EXPECT_EQ(leftLeft.getSymbol().s.contents, "a");
-		auto &leftRight = dynamic_cast<SymbolExpression &>(left.getRight());
+		auto &leftRight = cast<SymbolExpression>(left.getRight());
 		EXPECT_EQ(leftRight.getSymbol().s.contents, "b");
-		auto &right = dynamic_cast<BinaryExpression &>(outer->getRight());
+		auto &right = cast<BinaryExpression>(outer->getRight());
 		EXPECT_EQ(right.getOperator().type, Operator::Type::LogicalAnd);
-		auto &rightLeft = dynamic_cast<SymbolExpression &>(right.getLeft());
+		auto &rightLeft = cast<SymbolExpression>(right.getLeft());
 		EXPECT_EQ(rightLeft.getSymbol().s.contents, "c");
-		auto &rightRight = dynamic_cast<SymbolExpression &>(right.getRight());
+		auto &rightRight = cast<SymbolExpression>(right.getRight());
 		EXPECT_EQ(rightRight.getSymbol().s.contents, "d");
 	});
 }
 
 TEST_F(TestParser, testPrecedenceLogicalOrAssignment) {
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Symbol>(Slice("a", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::LogicalOr));
-	tokens.push_back(std::make_unique<Symbol>(Slice("b", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::Assignment));
-	tokens.push_back(std::make_unique<Symbol>(Slice("c", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::LogicalOr));
-	tokens.push_back(std::make_unique<Symbol>(Slice("d", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.symbol("a");
+	tokens.op(Operator::Type::LogicalOr);
+	tokens.symbol("b");
+	tokens.op(Operator::Type::Assignment);
+	tokens.symbol("c");
+	tokens.op(Operator::Type::LogicalOr);
+	tokens.symbol("d");
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([]([[maybe_unused]]
 	                           std::string_view name,
@@ -484,40 +486,40 @@ TEST_F(TestParser, testPrecedenceLogicalOrAssignment) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *outer = dynamic_cast<BinaryExpression *>(expr);
+		auto *outer = dyn_cast<BinaryExpression>(expr);
 		EXPECT_NE(outer, nullptr);
 		EXPECT_EQ(outer->getOperator().type, Operator::Type::Assignment);
-		auto &left = dynamic_cast<BinaryExpression &>(outer->getLeft());
+		auto &left = cast<BinaryExpression>(outer->getLeft());
 		EXPECT_EQ(left.getOperator().type, Operator::Type::LogicalOr);
-		auto &leftLeft = dynamic_cast<SymbolExpression &>(left.getLeft());
+		auto &leftLeft = cast<SymbolExpression>(left.getLeft());
 		EXPECT_EQ(leftLeft.getSymbol().s.contents, "a");
-		auto &leftRight = dynamic_cast<SymbolExpression &>(left.getRight());
+		auto &leftRight = cast<SymbolExpression>(left.getRight());
 		EXPECT_EQ(leftRight.getSymbol().s.contents, "b");
-		auto &right = dynamic_cast<BinaryExpression &>(outer->getRight());
+		auto &right = cast<BinaryExpression>(outer->getRight());
 		EXPECT_EQ(right.getOperator().type, Operator::Type::LogicalOr);
-		auto &rightLeft = dynamic_cast<SymbolExpression &>(right.getLeft());
+		auto &rightLeft = cast<SymbolExpression>(right.getLeft());
 		EXPECT_EQ(rightLeft.getSymbol().s.contents, "c");
-		auto &rightRight = dynamic_cast<SymbolExpression &>(right.getRight());
+		auto &rightRight = cast<SymbolExpression>(right.getRight());
 		EXPECT_EQ(rightRight.getSymbol().s.contents, "d");
 	});
 }
 
 TEST_F(TestParser, testPrecedenceAssignmentReturn) {
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::RETURN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("a", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::Assignment));
-	tokens.push_back(std::make_unique<Symbol>(Slice("b", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.keyword(Keyword::Type::RETURN);
+	tokens.symbol("a");
+	tokens.op(Operator::Type::Assignment);
+	tokens.symbol("b");
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([]([[maybe_unused]]
 	                           std::string_view name,
@@ -525,41 +527,41 @@ TEST_F(TestParser, testPrecedenceAssignmentReturn) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *ret = dynamic_cast<ReturnExpression *>(expr);
+		auto *ret = dyn_cast<ReturnExpression>(expr);
 		EXPECT_NE(ret, nullptr);
-		auto *assign = dynamic_cast<BinaryExpression *>(ret->getExpression());
+		auto *assign = dyn_cast<BinaryExpression>(ret->getExpression());
 		EXPECT_NE(assign, nullptr);
 		EXPECT_EQ(assign->getOperator().type, Operator::Type::Assignment);
-		auto &left = dynamic_cast<SymbolExpression &>(assign->getLeft());
+		auto &left = cast<SymbolExpression>(assign->getLeft());
 		EXPECT_EQ(left.getSymbol().s.contents, "a");
-		auto &right = dynamic_cast<SymbolExpression &>(assign->getRight());
+		auto &right = cast<SymbolExpression>(assign->getRight());
 		EXPECT_EQ(right.getSymbol().s.contents, "b");
 	});
 }
 
 TEST_F(TestParser, testPrecedenceParenthesizedAdditionMultiplication) {
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Symbol>(Slice("a", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::Addition));
-	tokens.push_back(std::make_unique<Symbol>(Slice("b", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::Multiplication));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Symbol>(Slice("c", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::Addition));
-	tokens.push_back(std::make_unique<Symbol>(Slice("d", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.symbol("a");
+	tokens.op(Operator::Type::Addition);
+	tokens.symbol("b");
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.op(Operator::Type::Multiplication);
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.symbol("c");
+	tokens.op(Operator::Type::Addition);
+	tokens.symbol("d");
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([]([[maybe_unused]]
 	                           std::string_view name,
@@ -567,49 +569,49 @@ TEST_F(TestParser, testPrecedenceParenthesizedAdditionMultiplication) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *outer = dynamic_cast<BinaryExpression *>(expr);
+		auto *outer = dyn_cast<BinaryExpression>(expr);
 		EXPECT_NE(outer, nullptr);
 		EXPECT_EQ(outer->getOperator().type, Operator::Type::Multiplication);
-		auto &left = dynamic_cast<ParenthesizedExpression &>(outer->getLeft());
-		auto &leftContents = dynamic_cast<BinaryExpression &>(left.getExpression());
+		auto &left = cast<ParenthesizedExpression>(outer->getLeft());
+		auto &leftContents = cast<BinaryExpression>(left.getExpression());
 		EXPECT_EQ(leftContents.getOperator().type, Operator::Type::Addition);
-		auto &leftLeft = dynamic_cast<SymbolExpression &>(leftContents.getLeft());
+		auto &leftLeft = cast<SymbolExpression>(leftContents.getLeft());
 		EXPECT_EQ(leftLeft.getSymbol().s.contents, "a");
-		auto &leftRight = dynamic_cast<SymbolExpression &>(leftContents.getRight());
+		auto &leftRight = cast<SymbolExpression>(leftContents.getRight());
 		EXPECT_EQ(leftRight.getSymbol().s.contents, "b");
-		auto &right = dynamic_cast<ParenthesizedExpression &>(outer->getRight());
-		auto &rightContents = dynamic_cast<BinaryExpression &>(right.getExpression());
+		auto &right = cast<ParenthesizedExpression>(outer->getRight());
+		auto &rightContents = cast<BinaryExpression>(right.getExpression());
 		EXPECT_EQ(rightContents.getOperator().type, Operator::Type::Addition);
-		auto &rightLeft = dynamic_cast<SymbolExpression &>(rightContents.getLeft());
+		auto &rightLeft = cast<SymbolExpression>(rightContents.getLeft());
 		EXPECT_EQ(rightLeft.getSymbol().s.contents, "c");
-		auto &rightRight = dynamic_cast<SymbolExpression &>(rightContents.getRight());
+		auto &rightRight = cast<SymbolExpression>(rightContents.getRight());
 		EXPECT_EQ(rightRight.getSymbol().s.contents, "d");
 	});
 }
 
 TEST_F(TestParser, testPrecedenceParenthesizedBitwiseOrAndBitshift) {
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Symbol>(Slice("a", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseOr));
-	tokens.push_back(std::make_unique<Symbol>(Slice("b", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseShiftLeft));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Symbol>(Slice("c", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseAnd));
-	tokens.push_back(std::make_unique<Symbol>(Slice("d", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.symbol("a");
+	tokens.op(Operator::Type::BitwiseOr);
+	tokens.symbol("b");
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.op(Operator::Type::BitwiseShiftLeft);
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.symbol("c");
+	tokens.op(Operator::Type::BitwiseAnd);
+	tokens.symbol("d");
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([]([[maybe_unused]]
 	                           std::string_view name,
@@ -617,52 +619,52 @@ TEST_F(TestParser, testPrecedenceParenthesizedBitwiseOrAndBitshift) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *outer = dynamic_cast<BinaryExpression *>(expr);
+		auto *outer = dyn_cast<BinaryExpression>(expr);
 		EXPECT_NE(outer, nullptr);
 		EXPECT_EQ(outer->getOperator().type, Operator::Type::BitwiseShiftLeft);
-		auto &left = dynamic_cast<ParenthesizedExpression &>(outer->getLeft());
-		auto &leftContents = dynamic_cast<BinaryExpression &>(left.getExpression());
+		auto &left = cast<ParenthesizedExpression>(outer->getLeft());
+		auto &leftContents = cast<BinaryExpression>(left.getExpression());
 		EXPECT_EQ(leftContents.getOperator().type, Operator::Type::BitwiseOr);
-		auto &leftLeft = dynamic_cast<SymbolExpression &>(leftContents.getLeft());
+		auto &leftLeft = cast<SymbolExpression>(leftContents.getLeft());
 		EXPECT_EQ(leftLeft.getSymbol().s.contents, "a");
-		auto &leftRight = dynamic_cast<SymbolExpression &>(leftContents.getRight());
+		auto &leftRight = cast<SymbolExpression>(leftContents.getRight());
 		EXPECT_EQ(leftRight.getSymbol().s.contents, "b");
-		auto &right = dynamic_cast<ParenthesizedExpression &>(outer->getRight());
-		auto &rightContents = dynamic_cast<BinaryExpression &>(right.getExpression());
+		auto &right = cast<ParenthesizedExpression>(outer->getRight());
+		auto &rightContents = cast<BinaryExpression>(right.getExpression());
 		EXPECT_EQ(rightContents.getOperator().type, Operator::Type::BitwiseAnd);
-		auto &rightLeft = dynamic_cast<SymbolExpression &>(rightContents.getLeft());
+		auto &rightLeft = cast<SymbolExpression>(rightContents.getLeft());
 		EXPECT_EQ(rightLeft.getSymbol().s.contents, "c");
-		auto &rightRight = dynamic_cast<SymbolExpression &>(rightContents.getRight());
+		auto &rightRight = cast<SymbolExpression>(rightContents.getRight());
 		EXPECT_EQ(rightRight.getSymbol().s.contents, "d");
 	});
 }
 
 TEST_P(TestParserAssociativityLeftBinary, testAssociativityLeftBinary) {
 	std::array<Operator::Type, 6> operators = GetParam();
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Symbol>(Slice("a", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, operators[0]));
-	tokens.push_back(std::make_unique<Symbol>(Slice("b", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, operators[1]));
-	tokens.push_back(std::make_unique<Symbol>(Slice("c", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, operators[2]));
-	tokens.push_back(std::make_unique<Symbol>(Slice("d", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, operators[3]));
-	tokens.push_back(std::make_unique<Symbol>(Slice("e", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, operators[4]));
-	tokens.push_back(std::make_unique<Symbol>(Slice("f", "", 0, 0)));
-	tokens.push_back(std::make_unique<Operator>(dummy, operators[5]));
-	tokens.push_back(std::make_unique<Symbol>(Slice("g", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.symbol("a");
+	tokens.op(operators[0]);
+	tokens.symbol("b");
+	tokens.op(operators[1]);
+	tokens.symbol("c");
+	tokens.op(operators[2]);
+	tokens.symbol("d");
+	tokens.op(operators[3]);
+	tokens.symbol("e");
+	tokens.op(operators[4]);
+	tokens.symbol("f");
+	tokens.op(operators[5]);
+	tokens.symbol("g");
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([&operators]([[maybe_unused]]
 	                                  std::string_view name,
@@ -670,37 +672,34 @@ TEST_P(TestParserAssociativityLeftBinary, testAssociativityLeftBinary) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *outer = dynamic_cast<BinaryExpression *>(expr);
+		auto *outer = dyn_cast<BinaryExpression>(expr);
 		EXPECT_NE(outer, nullptr);
 		EXPECT_EQ(outer->getOperator().type, operators[5]);
-		auto &left = dynamic_cast<BinaryExpression &>(outer->getLeft());
+		auto &left = cast<BinaryExpression>(outer->getLeft());
 		EXPECT_EQ(left.getOperator().type, operators[4]);
-		auto &leftLeft = dynamic_cast<BinaryExpression &>(left.getLeft());
+		auto &leftLeft = cast<BinaryExpression>(left.getLeft());
 		EXPECT_EQ(leftLeft.getOperator().type, operators[3]);
-		auto &leftLeftLeft = dynamic_cast<BinaryExpression &>(leftLeft.getLeft());
+		auto &leftLeftLeft = cast<BinaryExpression>(leftLeft.getLeft());
 		EXPECT_EQ(leftLeftLeft.getOperator().type, operators[2]);
-		auto &leftLeftLeftLeft = dynamic_cast<BinaryExpression &>(leftLeftLeft.getLeft());
+		auto &leftLeftLeftLeft = cast<BinaryExpression>(leftLeftLeft.getLeft());
 		EXPECT_EQ(leftLeftLeftLeft.getOperator().type, operators[1]);
-		auto &leftLeftLeftLeftLeft
-		      = dynamic_cast<BinaryExpression &>(leftLeftLeftLeft.getLeft());
+		auto &leftLeftLeftLeftLeft = cast<BinaryExpression>(leftLeftLeftLeft.getLeft());
 		EXPECT_EQ(leftLeftLeftLeftLeft.getOperator().type, operators[0]);
 		auto &leftLeftLeftLeftLeftLeft
-		      = dynamic_cast<SymbolExpression &>(leftLeftLeftLeftLeft.getLeft());
+		      = cast<SymbolExpression>(leftLeftLeftLeftLeft.getLeft());
 		EXPECT_EQ(leftLeftLeftLeftLeftLeft.getSymbol().s.contents, "a");
 		auto &leftLeftLeftLeftLeftRight
-		      = dynamic_cast<SymbolExpression &>(leftLeftLeftLeftLeft.getRight());
+		      = cast<SymbolExpression>(leftLeftLeftLeftLeft.getRight());
 		EXPECT_EQ(leftLeftLeftLeftLeftRight.getSymbol().s.contents, "b");
-		auto &leftLeftLeftLeftRight
-		      = dynamic_cast<SymbolExpression &>(leftLeftLeftLeft.getRight());
+		auto &leftLeftLeftLeftRight = cast<SymbolExpression>(leftLeftLeftLeft.getRight());
 		EXPECT_EQ(leftLeftLeftLeftRight.getSymbol().s.contents, "c");
-		auto &leftLeftLeftRight
-		      = dynamic_cast<SymbolExpression &>(leftLeftLeft.getRight());
+		auto &leftLeftLeftRight = cast<SymbolExpression>(leftLeftLeft.getRight());
 		EXPECT_EQ(leftLeftLeftRight.getSymbol().s.contents, "d");
-		auto &leftLeftRight = dynamic_cast<SymbolExpression &>(leftLeft.getRight());
+		auto &leftLeftRight = cast<SymbolExpression>(leftLeft.getRight());
 		EXPECT_EQ(leftLeftRight.getSymbol().s.contents, "e");
-		auto &leftRight = dynamic_cast<SymbolExpression &>(left.getRight());
+		auto &leftRight = cast<SymbolExpression>(left.getRight());
 		EXPECT_EQ(leftRight.getSymbol().s.contents, "f");
-		auto &right = dynamic_cast<SymbolExpression &>(outer->getRight());
+		auto &right = cast<SymbolExpression>(outer->getRight());
 		EXPECT_EQ(right.getSymbol().s.contents, "g");
 	});
 }
@@ -724,27 +723,27 @@ INSTANTIATE_TEST_SUITE_P(testAssociativityLeftBinary, TestParserAssociativityLef
                   Operator::Type::LessThanOrEqual}));
 
 TEST_F(TestParser, testAssociativityRightUnary) {
-	std::vector<std::unique_ptr<Token>> tokens;
-	tokens.push_back(std::make_unique<Keyword>(s, Keyword::Type::FUN));
-	tokens.push_back(std::make_unique<Symbol>(Slice("foo", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseParen));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::Colon));
-	tokens.push_back(std::make_unique<Symbol>(Slice("i32", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::OpenBrace));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::Subtraction));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::LogicalNot));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseNot));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::Addition));
-
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::LogicalNot));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::BitwiseNot));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::Addition));
-	tokens.push_back(std::make_unique<Operator>(dummy, Operator::Type::Subtraction));
-	tokens.push_back(std::make_unique<Symbol>(Slice("a", "", 0, 0)));
-	tokens.push_back(std::make_unique<Punctuation>(s, Punctuation::Type::CloseBrace));
-	tokens.push_back(std::make_unique<EndOfFile>(s));
-	Parser p = Parser("", std::move(tokens), &e);
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.op(Operator::Type::Subtraction);
+	tokens.op(Operator::Type::LogicalNot);
+	tokens.op(Operator::Type::BitwiseNot);
+	tokens.op(Operator::Type::Addition);
+
+	tokens.op(Operator::Type::LogicalNot);
+	tokens.op(Operator::Type::BitwiseNot);
+	tokens.op(Operator::Type::Addition);
+	tokens.op(Operator::Type::Subtraction);
+	tokens.symbol("a");
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
 	std::unique_ptr<Module> mod = p.parse();
 	mod->forEachFunction([]([[maybe_unused]]
 	                           std::string_view name,
@@ -752,33 +751,343 @@ TEST_F(TestParser, testAssociativityRightUnary) {
 		BlockExpression &body = f.getBody();
 		Expression *expr = body.getFinalExpression();
 		EXPECT_NE(expr, nullptr);
-		auto *outer = dynamic_cast<UnaryExpression *>(expr);
+		auto *outer = dyn_cast<UnaryExpression>(expr);
 		EXPECT_NE(outer, nullptr);
 		EXPECT_EQ(outer->getOperator().type, Operator::Type::Subtraction);
-		auto &inner = dynamic_cast<UnaryExpression &>(outer->getExpression());
+		auto &inner = cast<UnaryExpression>(outer->getExpression());
 		EXPECT_EQ(inner.getOperator().type, Operator::Type::LogicalNot);
-		auto &innerInner = dynamic_cast<UnaryExpression &>(inner.getExpression());
+		auto &innerInner = cast<UnaryExpression>(inner.getExpression());
 		EXPECT_EQ(innerInner.getOperator().type, Operator::Type::BitwiseNot);
-		auto &innerInnerInner
-		      = dynamic_cast<UnaryExpression &>(innerInner.getExpression());
+		auto &innerInnerInner = cast<UnaryExpression>(innerInner.getExpression());
 		EXPECT_EQ(innerInnerInner.getOperator().type, Operator::Type::Addition);
 		auto &innerInnerInnerInner
-		      = dynamic_cast<UnaryExpression &>(innerInnerInner.getExpression());
+		      = cast<UnaryExpression>(innerInnerInner.getExpression());
 		EXPECT_EQ(innerInnerInnerInner.getOperator().type, Operator::Type::LogicalNot);
 		auto &innerInnerInnerInnerInner
-		      = dynamic_cast<UnaryExpression &>(innerInnerInnerInner.getExpression());
+		      = cast<UnaryExpression>(innerInnerInnerInner.getExpression());
 		EXPECT_EQ(innerInnerInnerInnerInner.getOperator().type,
 		      Operator::Type::BitwiseNot);
-		auto &innerInnerInnerInnerInnerInner = dynamic_cast<UnaryExpression &>(
+		auto &innerInnerInnerInnerInnerInner = cast<UnaryExpression>(
 		      innerInnerInnerInnerInner.getExpression());
 		EXPECT_EQ(innerInnerInnerInnerInnerInner.getOperator().type,
 		      Operator::Type::Addition);
-		auto &innerInnerInnerInnerInnerInnerInner = dynamic_cast<UnaryExpression &>(
+		auto &innerInnerInnerInnerInnerInnerInner = cast<UnaryExpression>(
 		      innerInnerInnerInnerInnerInner.getExpression());
 		EXPECT_EQ(innerInnerInnerInnerInnerInnerInner.getOperator().type,
 		      Operator::Type::Subtraction);
-		auto &symbol = dynamic_cast<SymbolExpression &>(
+		auto &symbol = cast<SymbolExpression>(
 		      innerInnerInnerInnerInnerInnerInner.getExpression());
 		EXPECT_EQ(symbol.getSymbol().s.contents, "a");
 	});
 }
+
+TEST_F(TestParser, testAssociativityRightAssignment) {
+	TokenBufferBuilder tokens;
+	tokens.keyword(Keyword::Type::FUN);
+	tokens.symbol("foo");
+	tokens.punctuation(Punctuation::Type::OpenParen);
+	tokens.punctuation(Punctuation::Type::CloseParen);
+	tokens.punctuation(Punctuation::Type::Colon);
+	tokens.symbol("i32");
+	tokens.punctuation(Punctuation::Type::OpenBrace);
+	tokens.symbol("a");
+	tokens.op(Operator::Type::Assignment);
+	tokens.symbol("b");
+	tokens.op(Operator::Type::Assignment);
+	tokens.symbol("c");
+	tokens.punctuation(Punctuation::Type::CloseBrace);
+	tokens.endOfFile();
+	Parser p = Parser(tokens.build(), &e);
+	std::unique_ptr<Module> mod = p.parse();
+	mod->forEachFunction([]([[maybe_unused]]
+	                           std::string_view name,
+	                           Function &f, bool) {
+		BlockExpression &body = f.getBody();
+		Expression *expr = body.getFinalExpression();
+		EXPECT_NE(expr, nullptr);
+		auto *outer = dyn_cast<BinaryExpression>(expr);
+		EXPECT_NE(outer, nullptr);
+		EXPECT_EQ(outer->getOperator().type, Operator::Type::Assignment);
+		auto &left = cast<SymbolExpression>(outer->getLeft());
+		EXPECT_EQ(left.getSymbol().s.contents, "a");
+		auto &right = cast<BinaryExpression>(outer->getRight());
+		EXPECT_EQ(right.getOperator().type, Operator::Type::Assignment);
+		auto &rightLeft = cast<SymbolExpression>(right.getLeft());
+		EXPECT_EQ(rightLeft.getSymbol().s.contents, "b");
+		auto &rightRight = cast<SymbolExpression>(right.getRight());
+		EXPECT_EQ(rightRight.getSymbol().s.contents, "c");
+	});
+}
+
+/**
+ * @brief Ensure that constructs may nest right up to the limit
+ *
+ */
+TEST_F(TestParser, testNestingAtLimit) {
+	// The function body and the innermost operand are a level each, and each parenthesis
+	// adds one more
+	const size_t parentheses = Parser::MAX_NESTING_DEPTH - 2;
+	const std::string program = "fun foo(): i32 {\n" + std::string(parentheses, '(') + "1"
+	                            + std::string(parentheses, ')') + "\n}\n";
+	Parser p = Parser(Lexer(program, "", &e).lex(), &e);
+	std::unique_ptr<Module> mod = p.parse();
+	mod->forEachFunction([]([[maybe_unused]]
+	                           std::string_view name,
+	                           Function &f, bool) {
+		Expression *expr = f.getBody().getFinalExpression();
+		EXPECT_NE(expr, nullptr);
+		EXPECT_TRUE(isa<ParenthesizedExpression>(expr));
+	});
+}
+
+/**
+ * @brief Ensure that nesting beyond the limit is reported once, at the construct which
+ * exceeds it, rather than exhausting the stack or cascading into further errors
+ *
+ */
+TEST_F(TestParser, testNestingTooDeep) {
+	HasErrorHandler errors;
+	const size_t parentheses = Parser::MAX_NESTING_DEPTH * 4;
+	const std::string program = "fun foo(): i32 {\n" + std::string(parentheses, '(') + "1"
+	                            + std::string(parentheses, ')') + "\n}\n";
+	Parser p = Parser(Lexer(program, "", &errors).lex(), &errors);
+	std::unique_ptr<Module> mod = p.parse();
+	std::queue<std::tuple<std::filesystem::path, size_t, size_t, std::string>> expected;
+	expected.emplace("", 2, Parser::MAX_NESTING_DEPTH, "Expression is nested too deeply");
+	errors.checkErrors(expected);
+}
+
+/**
+ * @brief Ensure that a chain of left-associative operators is not limited by nesting,
+ * since it is parsed in a loop
+ *
+ */
+TEST_F(TestParser, testLongLeftAssociativeChain) {
+	const size_t operators = Parser::MAX_NESTING_DEPTH * 16;
+	std::string program = "fun foo(): i32 {\n1";
+	for (size_t i = 0; i < operators; i++) {
+		program += " + 1";
+	}
+	program += "\n}\n";
+	Parser p = Parser(Lexer(program, "", &e).lex(), &e);
+	std::unique_ptr<Module> mod = p.parse();
+	mod->forEachFunction([operators]([[maybe_unused]]
+	                                    std::string_view name,
+	                                    Function &f, bool) {
+		auto *chain = dyn_cast<BinaryExpression>(f.getBody().getFinalExpression());
+		EXPECT_NE(chain, nullptr);
+		std::vector<BinaryExpression *> links = chain->getLeftChain();
+		EXPECT_EQ(links.size(), operators);
+		EXPECT_TRUE(isa<IntegerLiteralExpression>(links.back()->getLeft()));
+	});
+}
+
+/**
+ * @brief Ensure that a Module starts with the builtin Types at their constant IDs, and
+ * that convertibility and common ancestors follow the parents of Types
+ *
+ */
+TEST_F(TestParser, testTypeHierarchy) {
+	std::unique_ptr<Module> mod = Parser(Lexer("", "", &e).lex(), &e).parse();
+	EXPECT_EQ(mod->getType("()").id, Type::UNIT);
+	EXPECT_EQ(mod->getType("!").id, Type::NEVER);
+	EXPECT_EQ(mod->getType("i8").id, Type::I8);
+	EXPECT_EQ(mod->getType("u64").id, Type::U64);
+	EXPECT_EQ(mod->getType("bool").id, Type::BOOL);
+	EXPECT_EQ(mod->getType("char").id, Type::CHAR);
+	EXPECT_EQ(mod->getType("missing").id, -1);
+
+	mod->insertType("Animal");
+	int animal = mod->getType("Animal").id;
+	mod->insertType("Dog", animal);
+	int dog = mod->getType("Dog").id;
+	mod->insertType("Puppy", dog);
+	int puppy = mod->getType("Puppy").id;
+	mod->insertType("Cat", animal);
+	int cat = mod->getType("Cat").id;
+	EXPECT_EQ(mod->getType(puppy).parentID, dog);
+
+	EXPECT_TRUE(mod->isTypeConvertible(puppy, animal));
+	EXPECT_TRUE(mod->isTypeConvertible(dog, dog));
+	EXPECT_TRUE(mod->isTypeConvertible(Type::NEVER, cat));
+	EXPECT_FALSE(mod->isTypeConvertible(animal, dog));
+	EXPECT_FALSE(mod->isTypeConvertible(cat, Type::NEVER));
+	EXPECT_FALSE(mod->isTypeConvertible(Type::I32, Type::I64));
+	EXPECT_FALSE(mod->isTypeConvertible(Type::I32, -1));
+
+	EXPECT_EQ(mod->getCommonTypeAncestor(puppy, cat).id, animal);
+	EXPECT_EQ(mod->getCommonTypeAncestor(dog, puppy).id, dog);
+	EXPECT_EQ(mod->getCommonTypeAncestor(Type::NEVER, puppy).id, puppy);
+	EXPECT_EQ(mod->getCommonTypeAncestor(cat, Type::BOOL).id, -1);
+	EXPECT_EQ(mod->getCommonTypeAncestor(Type::BOOL, Type::BOOL).id, Type::BOOL);
+}
+
+/**
+ * @brief Ensure that operators are looked up by their exact operand Types, including
+ * those added after a newer Type widens the table
+ *
+ */
+TEST_F(TestParser, testOperatorTable) {
+	std::unique_ptr<Module> mod = Parser(Lexer("", "", &e).lex(), &e).parse();
+	mod->addBinaryOperator(Operator::Type::Addition, Type::I32, Type::I32, Type::I32);
+	mod->addBinaryOperator(Operator::Type::LessThan, Type::I32, Type::I32, Type::BOOL);
+	mod->addUnaryOperator(Operator::Type::LogicalNot, Type::BOOL, Type::BOOL);
+	mod->insertType("Vector");
+	int vector = mod->getType("Vector").id;
+	EXPECT_EQ(mod->getBinaryOperator(Operator::Type::Addition, vector, vector), -1);
+	mod->addBinaryOperator(Operator::Type::Addition, vector, vector, vector);
+	mod->addUnaryOperator(Operator::Type::Subtraction, vector, vector);
+
+	EXPECT_EQ(mod->getBinaryOperator(Operator::Type::Addition, Type::I32, Type::I32),
+	      Type::I32);
+	EXPECT_EQ(mod->getBinaryOperator(Operator::Type::LessThan, Type::I32, Type::I32),
+	      Type::BOOL);
+	EXPECT_EQ(mod->getBinaryOperator(Operator::Type::Addition, vector, vector), vector);
+	EXPECT_EQ(mod->getBinaryOperator(Operator::Type::Addition, Type::I32, vector), -1);
+	EXPECT_EQ(mod->getBinaryOperator(Operator::Type::Addition, Type::I64, Type::I64), -1);
+	EXPECT_EQ(mod->getBinaryOperator(Operator::Type::Addition, -1, Type::I32), -1);
+	EXPECT_EQ(mod->getUnaryOperator(Operator::Type::LogicalNot, Type::BOOL), Type::BOOL);
+	EXPECT_EQ(mod->getUnaryOperator(Operator::Type::Subtraction, vector), vector);
+	EXPECT_EQ(mod->getUnaryOperator(Operator::Type::Subtraction, Type::I32), -1);
+	EXPECT_EQ(mod->getUnaryOperator(Operator::Type::LogicalNot, -1), -1);
+}
+
+TEST_F(TestParser, testFunctionOrderAndPositions) {
+	const char *source = "fun zeta() {}\n\nfun alpha(a: i32) {\n}\nfun mid(): i8 { 1 }\n";
+	TokenBuffer tokens = Lexer(source, "", &e).lex();
+	std::unique_ptr<Module> mod = Parser(std::move(tokens), &e).parse();
+	std::vector<std::tuple<std::string, size_t, std::string>> functions;
+	mod->forEachFunction(
+	      [&functions](std::string_view name, Function &function, bool /*unused*/) {
+		      functions.emplace_back(std::string(name), function.getSlice().row(),
+		            std::string(function.getSlice().contents));
+	      });
+
+	std::vector<std::tuple<std::string, size_t, std::string>> expected = {
+	      {"zeta", 1, "fun zeta() {}"},
+	      {"alpha", 3, "fun alpha(a: i32) {\n}"},
+	      {"mid", 5, "fun mid(): i8 { 1 }"},
+	};
+	EXPECT_EQ(functions, expected);
+}
+
+/**
+ * @brief Parses a program, optionally on a ThreadPool, and describes the result: each
+ * function's position and printed AST, followed by every error reported
+ */
+static std::vector<std::string> describeParse(const std::string &program,
+      ThreadPool *threadPool) {
+	RecordingErrorHandler errors;
+	TokenBuffer tokens = Lexer(program, "", &errors).lex();
+	std::unique_ptr<Module> mod = Parser(std::move(tokens), &errors, threadPool).parse();
+	std::vector<std::string> description;
+	ASTPrinter printer;
+	mod->forEachFunction([&](std::string_view name, Function &function, bool) {
+		// The ASTPrinter writes to std::cerr
+		std::stringstream printed;
+		std::streambuf *original = std::cerr.rdbuf(printed.rdbuf());
+		function.getBody().accept(printer);
+		std::cerr.rdbuf(original);
+		description.push_back(std::string(name) + " at "
+		                      + std::to_string(function.getSlice().row()) + ": "
+		                      + printed.str());
+	});
+	for (std::string &error : errors.takeErrors()) {
+		description.push_back(std::move(error));
+	}
+	return description;
+}
+
+/**
+ * @brief Ensure that parsing top-level functions in parallel gives the same AST as
+ * parsing them in sequence
+ *
+ */
+TEST_F(TestParser, testParallelParsing) {
+	std::string program;
+	for (size_t i = 0; i < 500; i++) {
+		const std::string n = std::to_string(i);
+		program += "fun f" + n + "(a: i32, b: i32): i32 {\n";
+		program += "\tlet x: i32 = a * " + n + " + (b - 1) % 7;\n";
+		program += "\tlet z: i32 = if a > b { { let w: i32 = -x; w } } else { +x };\n";
+		program += "\twhile false { x = x + 1; };\n";
+		program += "\tz / 2\n}\n";
+	}
+	std::vector<std::string> expected = describeParse(program, nullptr);
+	EXPECT_EQ(expected.size(), 500);
+	for (size_t threads : {2, 4}) {
+		ThreadPool threadPool(threads);
+		EXPECT_EQ(describeParse(program, &threadPool), expected);
+	}
+}
+
+/**
+ * @brief Ensure that parsing top-level functions in parallel reports the same errors and
+ * recovers from them the same way as parsing them in sequence, including where braces do
+ * not match and where nesting too deeply abandons the rest of the program
+ *
+ */
+TEST_F(TestParser, testParallelParsingErrors) {
+	std::vector<std::string> malformed = {
+	      "fun bad( { }\n",
+	      "fun bad(): i32 { let x = ; 2 }\n",
+	      "} }\n",
+	      "fun bad(): i32 1;\n",
+	      "fun bad(): i32 { { 1 }\n",
+	      "fun bad(): i32 { 1 } }\n",
+	      "let x: i32 = 1;\n",
+	};
+	std::string program;
+	for (size_t i = 0; i < 200; i++) {
+		const std::string n = std::to_string(i);
+		program += "fun f" + n + "(): i32 { " + n + " }\n";
+		if (i % 3 == 0) {
+			program += malformed[i / 3 % malformed.size()];
+		}
+	}
+	std::string nested = program;
+	nested += "fun deep(): i32 {\n" + std::string(Parser::MAX_NESTING_DEPTH, '(') + "1"
+	          + std::string(Parser::MAX_NESTING_DEPTH, ')') + "\n}\n";
+	nested += program;
+	for (const std::string &source : {program, nested}) {
+		std::vector<std::string> expected = describeParse(source, nullptr);
+		for (size_t threads : {2, 4}) {
+			ThreadPool threadPool(threads);
+			EXPECT_EQ(describeParse(source, &threadPool), expected);
+		}
+	}
+}
+
+/**
+ * @brief Analyzes a program, optionally on a ThreadPool, and lists every error reported
+ */
+static std::vector<std::string> analyzeErrors(const std::string &program,
+      ThreadPool *threadPool) {
+	RecordingErrorHandler errors;
+	TokenBuffer tokens = Lexer(program, "", &errors).lex();
+	std::unique_ptr<Module> mod = Parser(std::move(tokens), &errors).parse();
+	EXPECT_TRUE(errors.takeErrors().empty());
+	SemanticAnalyzer(mod.get(), &errors, threadPool).analyze();
+	return errors.takeErrors();
+}
+
+/**
+ * @brief Ensure that analyzing function bodies in parallel reports the same errors in
+ * the same order as analyzing them in sequence, with errors in more functions than
+ * there are runs of them
+ *
+ */
+TEST_F(TestParser, testParallelAnalysisErrors) {
+	std::string program = "fun main() {\n\tlet m: i32 = true;\n}\n";
+	for (size_t i = 0; i < 200; i++) {
+		const std::string n = std::to_string(i);
+		program += "fun f" + n + "(a: i32): i32 {\n";
+		program += "\tlet x: bool = a + " + n + ";\n";
+		program += "\tmissing" + n + "(a);\n";
+		program += "\tx\n}\n";
+	}
+	std::vector<std::string> expected = analyzeErrors(program, nullptr);
+	EXPECT_GE(expected.size(), 600);
+	ThreadPool threadPool(4);
+	EXPECT_EQ(analyzeErrors(program, &threadPool), expected);
+}
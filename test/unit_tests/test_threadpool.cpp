@@ -0,0 +1,95 @@
+#ifndef DEBUG_TEST_MODE
+#	error "DEBUG_TEST_MODE not defined"
+#endif
+
+#include "threadpool.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Ensure that an empty batch runs nothing and returns at once
+ *
+ */
+TEST(testThreadPool, testForEachNothing) {
+	ThreadPool threadPool(4);
+	std::atomic<size_t> calls = 0;
+	threadPool.forEach(0, [&calls](size_t) {
+		calls++;
+	});
+	EXPECT_EQ(calls, 0);
+}
+
+/**
+ * @brief Ensure that a batch with many more items than threads runs each item exactly
+ * once
+ *
+ */
+TEST(testThreadPool, testForEachMoreItemsThanThreads) {
+	ThreadPool threadPool(4);
+	EXPECT_EQ(threadPool.size(), 4);
+	std::vector<std::atomic<size_t>> calls(1000);
+	threadPool.forEach(calls.size(), [&calls](size_t i) {
+		calls[i]++;
+	});
+	for (const std::atomic<size_t> &count : calls) {
+		EXPECT_EQ(count, 1);
+	}
+}
+
+/**
+ * @brief Ensure that batches submitted from inside every item of another batch finish,
+ * even though each one is submitted while every thread of the pool is busy
+ *
+ */
+TEST(testThreadPool, testNestedForEach) {
+	ThreadPool threadPool(2);
+	constexpr size_t OUTER = 8;
+	constexpr size_t INNER = 100;
+	std::vector<std::atomic<size_t>> calls(OUTER * INNER);
+	threadPool.forEach(OUTER, [&threadPool, &calls](size_t outer) {
+		threadPool.forEach(INNER, [&calls, outer](size_t inner) {
+			calls[outer * INNER + inner]++;
+		});
+	});
+	for (const std::atomic<size_t> &count : calls) {
+		EXPECT_EQ(count, 1);
+	}
+}
+
+/**
+ * @brief Ensure that runs cover every item exactly once, in contiguous ranges which are
+ * numbered in order, and that there are never more runs than items
+ *
+ */
+TEST(testThreadPool, testForEachRun) {
+	ThreadPool threadPool(3);
+	for (size_t count : {0, 1, 5, 12, 1001}) {
+		size_t runs = threadPool.countRuns(count);
+		EXPECT_LE(runs, count);
+		std::vector<std::pair<size_t, size_t>> ranges(runs);
+		std::vector<std::atomic<size_t>> calls(count);
+		threadPool.forEachRun(count, [&ranges, &calls](size_t run, size_t begin,
+		                                   size_t end) {
+			ranges[run] = {begin, end};
+			for (size_t i = begin; i < end; i++) {
+				calls[i]++;
+			}
+		});
+		size_t next = 0;
+		for (const auto &[begin, end] : ranges) {
+			EXPECT_EQ(begin, next);
+			EXPECT_LT(begin, end);
+			next = end;
+		}
+		EXPECT_EQ(next, count);
+		for (const std::atomic<size_t> &items : calls) {
+			EXPECT_EQ(items, 1);
+		}
+	}
+}
@@ -1,15 +1,24 @@
 #ifndef TEST_UTILITIES_H
 #define TEST_UTILITIES_H
 
+#include "casting.h"
 #include "errorhandler.h"
+#include "sourcemanager.h"
+#include "tokenbuffer.h"
+#include "tokens.h"
 
 #include "gtest/gtest.h"
 
+#include <cstdint>
 #include <filesystem>
 #include <iostream>
+#include <memory>
 #include <queue>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <tuple>
+#include <vector>
 
 class NoErrorHandler : public ErrorHandler {
 public:
@@ -52,10 +61,10 @@ public:
 		for (; !errors.empty(); errors.pop(), expected.pop()) {
 			const auto &actual = errors.front();
 			const auto &expect = expected.front();
-			EXPECT_EQ(actual->source, std::get<0>(expect));
-			EXPECT_EQ(dynamic_cast<ErrorWithLocation *>(actual.get())->row,
+			EXPECT_EQ(SourceManager::getPath(actual->source), std::get<0>(expect));
+			EXPECT_EQ(cast<ErrorWithLocation>(actual.get())->slice.row(),
 			      std::get<1>(expect));
-			EXPECT_EQ(dynamic_cast<ErrorWithLocation *>(actual.get())->col,
+			EXPECT_EQ(cast<ErrorWithLocation>(actual.get())->slice.col(),
 			      std::get<2>(expect));
 			EXPECT_EQ(actual->message, std::get<3>(expect));
 		}
@@ -67,4 +76,85 @@ public:
 	}
 };
 
+/**
+ * @brief Keeps the errors reported to it, so that the errors of two runs can be compared
+ */
+class RecordingErrorHandler : public ErrorHandler {
+public:
+	std::vector<std::string> takeErrors() {
+		std::vector<std::string> messages;
+		for (; !errors.empty(); errors.pop()) {
+			messages.push_back(errors.front()->toString());
+		}
+		return messages;
+	}
+};
+
+/**
+ * @brief Converts every Token in a TokenBuffer into a standalone Token object
+ */
+inline std::vector<std::unique_ptr<Token>> toTokens(const TokenBuffer &buffer) {
+	std::vector<std::unique_ptr<Token>> tokens;
+	for (size_t i = 0; i < buffer.size(); i++) {
+		tokens.push_back(buffer.createToken(i));
+	}
+	return tokens;
+}
+
+/**
+ * @brief Builds a TokenBuffer one Token at a time, along with source code that spells
+ * out each Token. The source code is owned by the builder, so it must outlive anything
+ * built from the TokenBuffer
+ */
+class TokenBufferBuilder {
+	std::string program;
+	std::vector<std::tuple<TokenKind, uint8_t, size_t, size_t>> tokens;
+
+	void push(TokenKind kind, uint8_t subtype, std::string_view text) {
+		tokens.emplace_back(kind, subtype, program.size(), text.size());
+		program += text;
+		program += ' ';
+	}
+public:
+	void keyword(Keyword::Type type) {
+		std::stringstream stream;
+		Keyword(Slice("", SourceManager::NO_FILE), type).print(stream);
+		std::string text = stream.str();
+		push(TokenKind::Keyword, static_cast<uint8_t>(type),
+		      text.substr(text.find(' ') + 1));
+	}
+
+	void punctuation(Punctuation::Type type) {
+		std::stringstream stream;
+		Punctuation(Slice("", SourceManager::NO_FILE), type).print(stream);
+		push(TokenKind::Punctuation, static_cast<uint8_t>(type), stream.str());
+	}
+
+	void op(Operator::Type type) {
+		push(TokenKind::Operator, static_cast<uint8_t>(type),
+		      Operator::typeToStringView(type));
+	}
+
+	void symbol(std::string_view name) {
+		push(TokenKind::Symbol, 0, name);
+	}
+
+	void endOfFile() {
+		push(TokenKind::EndOfFile, 0, "");
+	}
+
+	TokenBuffer build() {
+		TokenBuffer buffer(program, SourceManager::NO_FILE);
+		for (const auto &[kind, subtype, offset, length] : tokens) {
+			uint64_t value = 0;
+			if (kind == TokenKind::Symbol) {
+				std::string_view name = std::string_view(program).substr(offset, length);
+				value = buffer.getInterner()->intern(name);
+			}
+			buffer.push(kind, subtype, offset, length, value);
+		}
+		return buffer;
+	}
+};
+
 #endif